@@ -13,6 +13,12 @@ static void free_csv_line( char **parsed );
 // static char **split_on_unescaped_newlines(const char *txt);
 static char *fread_csv_line(FILE *fp, int max_line_size, int *done, int *err);
 
+static char *csv_stream_line(csv_stream *stream, size_t *length);
+static enum bool csv_stream_fill(csv_stream *stream);
+static enum bool csv_stream_header(csv_stream *stream);
+static float csv_stream_value(csv_stream *stream, size_t column, const char *field, const char *field_end);
+static const char *csv_stream_field(const char *field, const char *line_end, const char **value_end);
+
 csv *csv_readfile(char *filename) {
     csv *parsed = calloc(1, sizeof(csv));
     FILE *csv_file = NULL;
@@ -87,6 +93,372 @@ char **csv_field(csv *instance, char *field_name) {
     return values;
 }
 
+/* Streaming */
+csv_stream *csv_open(char *filename) {
+    csv_stream *stream = calloc(1, sizeof(csv_stream));
+    check_memory(stream);
+
+    stream->file = fopen(filename, "r");
+    check(stream->file, "Can't open %s", filename);
+
+    stream->capacity = CSV_STREAM_BUFFER;
+    stream->buffer = malloc(stream->capacity);
+    check_memory(stream->buffer);
+
+    check(csv_stream_header(stream), "%s has no header", filename);
+
+    stream->categories = calloc(stream->columns, sizeof(csv_categories));
+    check_memory(stream->categories);
+
+    return stream;
+
+error:
+    csv_close(stream);
+    return NULL;
+}
+
+size_t csv_read_rows(csv_stream *stream, float *values, size_t rows) {
+    size_t row = 0;
+    size_t length = 0;
+    char *line = NULL;
+
+    check_memory(stream);
+    check_memory(values);
+
+    while(row < rows && (line = csv_stream_line(stream, &length))) {
+        const char *line_end = line + length;
+        const char *field = line;
+        float *row_values = values + row * stream->columns;
+
+        // Empty lines are skipped
+        if(length == 0 || (length == 1 && *line == '\r')) {
+            continue;
+        }
+
+        for(size_t column = 0; column < stream->columns; column++) {
+            const char *value_end = NULL;
+            const char *next = csv_stream_field(field, line_end, &value_end);
+
+            row_values[column] = field < line_end
+                               ? csv_stream_value(stream, column, field, value_end)
+                               : 0;
+            field = next;
+        }
+
+        row++;
+    }
+
+    stream->rows += row;
+
+    return row;
+
+error:
+    return 0;
+}
+
+enum bool csv_rewind(csv_stream *stream) {
+    size_t length = 0;
+
+    check_memory(stream);
+    check(fseek(stream->file, 0, SEEK_SET) == 0, "Can't rewind stream");
+
+    stream->start = stream->end = 0;
+    stream->eof = false;
+    stream->rows = 0;
+
+    // Header is read again to get to the first row
+    check(csv_stream_line(stream, &length), "Header is lost on rewind");
+
+    return true;
+
+error:
+    return false;
+}
+
+void csv_close(csv_stream *stream) {
+    if(stream == NULL) {
+        return;
+    }
+
+    if(stream->file) {
+        fclose(stream->file);
+    }
+
+    if(stream->fields) {
+        free_csv_line(stream->fields);
+    }
+
+    for(size_t column = 0; stream->categories && column < stream->columns; column++) {
+        for(size_t index = 0; index < stream->categories[column].count; index++) {
+            free(stream->categories[column].names[index]);
+        }
+        free(stream->categories[column].names);
+    }
+
+    free(stream->categories);
+    free(stream->buffer);
+    free(stream);
+}
+
+static
+enum bool
+csv_stream_header(csv_stream *stream) {
+    size_t length = 0;
+    char *line = csv_stream_line(stream, &length);
+    check(line, "Stream is empty");
+
+    // Line is terminated in place for the old field parser
+    if(length && line[length - 1] == '\r') {
+        length--;
+    }
+    line[length] = '\0';
+
+    stream->fields = parse_csv(line);
+    check_memory(stream->fields);
+
+    while(stream->fields[stream->columns]) {
+        stream->columns++;
+    }
+    check(stream->columns, "Header has no fields");
+
+    return true;
+
+error:
+    return false;
+}
+
+// Line without newline, it's valid until the next call. Buffer keeps one
+// byte after line, so line can be terminated in place
+static
+char *
+csv_stream_line(csv_stream *stream, size_t *length) {
+    while(true) {
+        char *start = stream->buffer + stream->start;
+        char *newline = memchr(start, '\n', stream->end - stream->start);
+
+        if(newline) {
+            *length = newline - start;
+            stream->start += *length + 1;
+
+            return start;
+        }
+
+        if(stream->eof) {
+            if(stream->start == stream->end) {
+                return NULL;
+            }
+
+            *length = stream->end - stream->start;
+            stream->start = stream->end;
+
+            return start;
+        }
+
+        check(csv_stream_fill(stream), "Stream read failed");
+    }
+
+error:
+    return NULL;
+}
+
+// Unparsed tail is moved to the front, buffer is doubled when tail fills it
+static
+enum bool
+csv_stream_fill(csv_stream *stream) {
+    size_t tail = stream->end - stream->start;
+
+    memmove(stream->buffer, stream->buffer + stream->start, tail);
+    stream->start = 0;
+    stream->end = tail;
+
+    if(stream->capacity - stream->end < 2) {
+        char *buffer = realloc(stream->buffer, stream->capacity * 2);
+        check_memory(buffer);
+        stream->buffer = buffer;
+        stream->capacity *= 2;
+    }
+
+    size_t read = fread(stream->buffer + stream->end, 1, stream->capacity - stream->end - 1, stream->file);
+    check(read || feof(stream->file), "Can't read stream");
+
+    stream->end += read;
+    stream->eof = read == 0 || feof(stream->file);
+    // Reserved byte ends the last line of file without newline
+    stream->buffer[stream->end] = '\0';
+
+    return true;
+
+error:
+    return false;
+}
+
+// Returns start of the next field, value end is the end without quote and CR
+static
+const char *
+csv_stream_field(const char *field, const char *line_end, const char **value_end) {
+    const char *cursor = field;
+
+    if(cursor < line_end && *cursor == '\"') {
+        for(cursor++; cursor < line_end; cursor++) {
+            if(*cursor != '\"') {
+                continue;
+            }
+            // Escaped quote
+            if(cursor + 1 < line_end && cursor[1] == '\"') {
+                cursor++;
+                continue;
+            }
+            break;
+        }
+        *value_end = cursor;
+        cursor = memchr(cursor, ',', line_end - cursor);
+    } else {
+        cursor = memchr(cursor, ',', line_end - cursor);
+        *value_end = cursor ? cursor : line_end;
+    }
+
+    while(*value_end > field && ((*value_end)[-1] == '\r' || (*value_end)[-1] == ' ')) {
+        (*value_end)--;
+    }
+
+    return cursor ? cursor + 1 : line_end;
+}
+
+// Number or index of text value in column
+static
+float
+csv_stream_value(csv_stream *stream, size_t column, const char *field, const char *field_end) {
+    const char *number_end = NULL;
+    const char *value = field;
+    size_t length = field_end - field;
+
+    if(*value == '\"') {
+        value++;
+        length = field_end - value;
+    }
+
+    float number = csv_parse_float(value, field_end, &number_end);
+    if(length && number_end == field_end) {
+        return number;
+    }
+
+    csv_categories *categories = &stream->categories[column];
+    for(size_t index = 0; index < categories->count; index++) {
+        if(strncmp(categories->names[index], value, length) == 0 && categories->names[index][length] == '\0') {
+            return index;
+        }
+    }
+
+    char **names = realloc(categories->names, (categories->count + 1) * sizeof(char*));
+    check_memory(names);
+    categories->names = names;
+    categories->names[categories->count] = strndup(value, length);
+    check_memory(categories->names[categories->count]);
+
+    return categories->count++;
+
+error:
+    return 0;
+}
+
+/* Float Parser */
+static const double powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define CSV_IS(character) (cursor < limit && *cursor == (character))
+#define CSV_DIGIT() (cursor < limit && *cursor >= '0' && *cursor <= '9')
+
+// Mantissa below 2^53 scaled by exact power of ten is correctly rounded,
+// other numbers are left to strtod
+float csv_parse_float(const char *text, const char *limit, const char **end) {
+    const char *cursor = text;
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    enum bool negative = false;
+
+    while(CSV_IS(' ') || CSV_IS('\t')) {
+        cursor++;
+    }
+
+    if(CSV_IS('-') || CSV_IS('+')) {
+        negative = *cursor == '-';
+        cursor++;
+    }
+
+    const char *number = cursor;
+
+    for(; CSV_DIGIT(); cursor++, digits++) {
+        mantissa = mantissa * 10 + (*cursor - '0');
+    }
+
+    if(CSV_IS('.')) {
+        cursor++;
+        for(; CSV_DIGIT(); cursor++, digits++) {
+            mantissa = mantissa * 10 + (*cursor - '0');
+            exponent--;
+        }
+    }
+
+    if(digits == 0) {
+        *end = text;
+        return 0;
+    }
+
+    if(CSV_IS('e') || CSV_IS('E')) {
+        const char *exponent_start = cursor++;
+        enum bool exponent_negative = false;
+        int value = 0;
+
+        if(CSV_IS('-') || CSV_IS('+')) {
+            exponent_negative = *cursor == '-';
+            cursor++;
+        }
+
+        if(!CSV_DIGIT()) {
+            cursor = exponent_start;
+        } else {
+            for(; CSV_DIGIT(); cursor++) {
+                value = value < 10000 ? value * 10 + (*cursor - '0') : value;
+            }
+            exponent += exponent_negative ? -value : value;
+        }
+    }
+
+    *end = cursor;
+
+    // Copy of the number is terminated, so strtod doesn't pass the limit
+    if(digits > 19 || mantissa > (1ULL << 53) || exponent < -22 || exponent > 22) {
+        char copy[64];
+        size_t length = cursor - number;
+        char *digits_copy = length < sizeof(copy) ? copy : malloc(length + 1);
+        float value = 0;
+
+        if(digits_copy) {
+            memcpy(digits_copy, number, length);
+            digits_copy[length] = '\0';
+            value = strtod(digits_copy, NULL);
+        }
+        if(digits_copy != copy) {
+            free(digits_copy);
+        }
+
+        return negative ? -value : value;
+    }
+
+    double value = exponent < 0
+                 ? mantissa / powers_of_ten[-exponent]
+                 : mantissa * powers_of_ten[exponent];
+
+    return negative ? -value : value;
+}
+
+#undef CSV_DIGIT
+#undef CSV_IS
+
+
 static void free_csv_line( char **parsed )
 {
     char **ptr;
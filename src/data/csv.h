@@ -4,14 +4,17 @@
 #define CSV_ERR_LONGLINE 0
 #define CSV_ERR_NO_MEMORY 1
 
+// Stream buffer grows when a line doesn't fit
+#define CSV_STREAM_BUFFER (1 << 20)
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define CSV_TYPE "t_CSV"
+#include "../util/macros.h"
 
 typedef struct {
-    char *type;
+    enum type_tag type;
     
     size_t rows;
     size_t columns;
@@ -25,5 +28,41 @@ char **csv_row(csv *instance, size_t row);
 char **csv_column(csv *instance, size_t column);
 char **csv_field(csv *instance, char *field_name);
 
+/* Streaming reader, file is read by big chunks and fields are parsed
+   straight into rows of floats. Text values are numbered by their first
+   appearance in column. Quoted fields can't contain newlines */
+typedef struct {
+    char **     names;
+    size_t      count;
+} csv_categories;
+
+typedef struct {
+    FILE *          file;
+    char *          buffer;
+    size_t          capacity;
+    // Unparsed bytes are buffer[start..end)
+    size_t          start;
+    size_t          end;
+    enum bool       eof;
+
+    size_t          columns;
+    char **         fields;
+    // Rows read since open or rewind
+    size_t          rows;
+
+    csv_categories *categories;
+} csv_stream;
+
+csv_stream *csv_open(char *filename);
+// Fills up to rows x columns values, returns count of rows read, 0 at the end
+size_t csv_read_rows(csv_stream *stream, float *values, size_t rows);
+// Next pass over the same file, categories are kept
+enum bool csv_rewind(csv_stream *stream);
+void csv_close(csv_stream *stream);
+
+// Decimal number without locale, it's read up to limit.
+// End is set after the number
+float csv_parse_float(const char *text, const char *limit, const char **end);
+
 #endif
 
@@ -0,0 +1,244 @@
+//
+//  loader.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include "loader.h"
+#include "../util/arena.h"
+
+#define LOADER_DEPTH 2
+
+static data_loader *        loader_create(data_batch *batch, size_t depth);
+static void                 loader_delete(data_loader *loader);
+static void                 loader_epoch(data_loader *loader);
+static data_set *           loader_next(data_loader *loader);
+
+static void *               loader_loop(void *argument);
+static void                 loader_release(data_loader *loader);
+
+
+/* Library Structure */
+const struct loader_library Loader = {
+    .create = loader_create,
+    .delete = loader_delete,
+
+    .epoch = loader_epoch,
+    .next = loader_next
+};
+
+
+/* Life Cycle */
+static
+data_loader *
+loader_create(data_batch *batch, size_t depth) {
+    arena_mark heap = Arena.push(NULL);
+    data_loader *loader = NULL;
+
+    check_memory(batch);
+    check_memory(batch->train);
+
+    loader = calloc(1, sizeof(data_loader));
+    check_memory(loader);
+
+    loader->batch = batch;
+    loader->depth = depth ? depth : LOADER_DEPTH;
+    // Nothing to prepare before the first epoch
+    loader->produced = batch->count;
+    loader->consumed = batch->count;
+
+    loader->ring = calloc(loader->depth, sizeof(data_set));
+    loader->sets = calloc(loader->depth, sizeof(data_set*));
+    check_memory(loader->ring);
+    check_memory(loader->sets);
+
+    for(size_t slot = 0; slot < loader->depth; slot++) {
+        data_set *set = &loader->ring[slot];
+
+        *set = *batch->train;
+        set->features.values = Matrix.create(batch->batch_size, batch->train->features.values->columns);
+        set->target.values = Matrix.create(batch->batch_size, batch->train->target.values->columns);
+        set->mapping.address = NULL;
+        set->mapping.size = 0;
+        check_memory(set->features.values);
+        check_memory(set->target.values);
+    }
+
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->ready, NULL);
+    pthread_cond_init(&loader->space, NULL);
+
+    if(pthread_create(&loader->thread, NULL, loader_loop, loader) != 0) {
+        pthread_cond_destroy(&loader->space);
+        pthread_cond_destroy(&loader->ready);
+        pthread_mutex_destroy(&loader->lock);
+        log_error("Loader thread isn't started");
+        goto error;
+    }
+
+    Arena.pop(heap);
+    return loader;
+
+error:
+    loader_release(loader);
+    Arena.pop(heap);
+    return NULL;
+}
+
+static
+void
+loader_delete(data_loader *loader) {
+    check_memory(loader);
+
+    pthread_mutex_lock(&loader->lock);
+    loader->stop = true;
+    pthread_cond_broadcast(&loader->space);
+    pthread_mutex_unlock(&loader->lock);
+
+    pthread_join(loader->thread, NULL);
+
+    pthread_cond_destroy(&loader->space);
+    pthread_cond_destroy(&loader->ready);
+    pthread_mutex_destroy(&loader->lock);
+
+    loader_release(loader);
+
+error:
+    return;
+}
+
+static
+void
+loader_release(data_loader *loader) {
+    if(loader == NULL) {
+        return;
+    }
+
+    for(size_t slot = 0; loader->ring && slot < loader->depth; slot++) {
+        Matrix.delete(loader->ring[slot].features.values);
+        Matrix.delete(loader->ring[slot].target.values);
+    }
+
+    free(loader->ring);
+    free(loader->sets);
+    free(loader);
+}
+
+
+/* Batches */
+static
+void
+loader_epoch(data_loader *loader) {
+    check_memory(loader);
+
+    pthread_mutex_lock(&loader->lock);
+    // Batch in work belongs to the old order
+    while(loader->busy) {
+        pthread_cond_wait(&loader->ready, &loader->lock);
+    }
+
+    // Shuffle is on the calling thread, so order depends only on its seed
+    if(loader->batch->count > 1) {
+        Data.batch.shuffle(loader->batch);
+    }
+
+    loader->head = 0;
+    loader->filled = 0;
+    loader->holding = false;
+    loader->produced = 0;
+    loader->consumed = 0;
+    loader->failed = false;
+    loader->generation++;
+
+    pthread_cond_broadcast(&loader->space);
+    pthread_mutex_unlock(&loader->lock);
+
+error:
+    return;
+}
+
+static
+data_set *
+loader_next(data_loader *loader) {
+    data_set *set = NULL;
+    check_memory(loader);
+
+    pthread_mutex_lock(&loader->lock);
+    if(loader->holding) {
+        loader->head = (loader->head + 1) % loader->depth;
+        loader->filled--;
+        loader->holding = false;
+        pthread_cond_signal(&loader->space);
+    }
+
+    if(loader->consumed < loader->batch->count) {
+        while(loader->filled == 0 && loader->failed == false) {
+            pthread_cond_wait(&loader->ready, &loader->lock);
+        }
+
+        if(loader->failed == false) {
+            set = loader->sets[loader->head];
+            loader->holding = true;
+            loader->consumed++;
+        }
+    }
+    pthread_mutex_unlock(&loader->lock);
+
+    return set;
+
+error:
+    return NULL;
+}
+
+// Unshuffled batches are published as views of train rows, others
+// are gathered into the free set of ring
+static
+void *
+loader_loop(void *argument) {
+    data_loader *loader = argument;
+    data_batch *batch = loader->batch;
+
+    pthread_mutex_lock(&loader->lock);
+    while(true) {
+        while(loader->stop == false
+              && (loader->failed || loader->produced == batch->count || loader->filled == loader->depth)) {
+            pthread_cond_wait(&loader->space, &loader->lock);
+        }
+
+        if(loader->stop) {
+            break;
+        }
+
+        size_t generation = loader->generation;
+        size_t index = loader->produced;
+        size_t slot = (loader->head + loader->filled) % loader->depth;
+        data_set *set = &loader->ring[slot];
+        loader->busy = true;
+        pthread_mutex_unlock(&loader->lock);
+
+        enum bool gathered = true;
+        if(batch->order) {
+            gathered = Data.batch.gather(batch, index, set);
+        } else {
+            set = batch->mini[index];
+        }
+
+        pthread_mutex_lock(&loader->lock);
+        loader->busy = false;
+        if(generation == loader->generation) {
+            if(gathered) {
+                loader->sets[slot] = set;
+                loader->filled++;
+                loader->produced++;
+            } else {
+                loader->failed = true;
+            }
+        }
+        pthread_cond_broadcast(&loader->ready);
+    }
+    pthread_mutex_unlock(&loader->lock);
+
+    return NULL;
+}
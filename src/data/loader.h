@@ -0,0 +1,62 @@
+//
+//  loader.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef loader_h
+#define loader_h
+
+#include <stdio.h>
+#include <pthread.h>
+#include "set.h"
+
+/* Background thread gathers next mini-batches of epoch into a ring
+   of sets, while the caller trains on the current one */
+typedef struct {
+    data_batch *        batch;
+    pthread_t           thread;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      ready;
+    pthread_cond_t      space;
+
+    // Ring of depth sets, filled of them starting from head are ready.
+    // Ready slot points to its set or to view of unshuffled train rows
+    data_set *          ring;
+    data_set **         sets;
+    size_t              depth;
+    size_t              head;
+    size_t              filled;
+    enum bool           holding;
+
+    // Mini-batches of current epoch
+    size_t              produced;
+    size_t              consumed;
+    // Incremented by each epoch, batch of older epoch is dropped
+    size_t              generation;
+    enum bool           busy;
+    enum bool           failed;
+    enum bool           stop;
+} data_loader;
+
+
+/* Library methods */
+struct loader_library {
+    // Depth is count of mini-batches prepared ahead, 0 is default of 2
+    data_loader *        (*create)(data_batch *batch, size_t depth);
+    void                 (*delete)(data_loader *loader);
+
+    // Shuffles train rows on the calling thread and starts preparing
+    // batches of the new epoch, unread batches of the old one are dropped
+    void                 (*epoch)(data_loader *loader);
+    // Waits for the next mini-batch of epoch, it's valid until the next call.
+    // NULL when epoch is over
+    data_set *           (*next)(data_loader *loader);
+};
+
+extern const struct loader_library Loader;
+
+#endif /* loader_h */
@@ -6,23 +6,61 @@
 //  Copyright © 2018 alexander. All rights reserved.
 //
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "set.h"
+#include "../util/file.h"
+
+#define DATA_FILE_ALIGN(offset) (((offset) + DATA_FILE_ALIGNMENT - 1) & ~(uint64_t)(DATA_FILE_ALIGNMENT - 1))
 
 static data_set     data_from_matrix(matrix *features, matrix *target);
 static data_set     data_from_csv(char *filename, char** fields, char **target);
+static char **      data_labels(char **fields, char **list, enum bool in_list);
+static matrix *     data_columns(matrix *data, char **fields, char **labels);
+static matrix *     data_stream_all(csv_stream *stream);
+static size_t       data_stream_next(csv_stream *stream, matrix *rows);
+static enum bool    data_file_write(data_set *data, char *filename);
+static data_set     data_file_map(char *filename);
+static size_t       data_file_labels_size(char **labels, size_t count);
+static enum bool    data_file_write_labels(FILE *file, char **labels, size_t count);
+static char **      data_file_labels(char **fields, size_t count);
+static void         data_file_unmap(data_set *data);
 static void         data_delete(data_set *data);
 static void         data_print(data_set *data);
-static csv *        data_shuffle(csv *data);
+static matrix *     data_shuffle(matrix *data);
 static data_set *   data_part(data_set *set, size_t pool_offset, size_t pool_size);
 static data_set **  data_mini_batch(data_set *set, size_t batch_size);
 static data_batch   data_split(data_set *set, size_t batch_size, size_t train, size_t validation, size_t test);
+static void         data_batch_shuffle(data_batch *batch);
+static data_set *   data_batch_mini(data_batch *batch, size_t index);
+static enum bool    data_batch_gather(data_batch *batch, size_t index, data_set *into);
+static void         data_batch_delete(data_batch *batch);
+static void         data_part_delete(data_set *part);
 static matrix *     data_vector_to_binary_columns(vector *column);
 static vector *     data_binary_to_vector(matrix *binary);
 
 const struct data_library Data = {
     .matrix = data_from_matrix,
     .csv = data_from_csv,
+    .stream = {
+        .open = csv_open,
+        .next = data_stream_next,
+        .rewind = csv_rewind,
+        .close = csv_close
+    },
+    .file = {
+        .write = data_file_write,
+        .map = data_file_map
+    },
     .split = data_split,
+    .batch = {
+        .shuffle = data_batch_shuffle,
+        .mini = data_batch_mini,
+        .gather = data_batch_gather,
+        .delete = data_batch_delete
+    },
     .print = data_print,
     .convert = {
         .vector_to_binary = data_vector_to_binary_columns,
@@ -78,55 +116,28 @@ data_from_matrix(matrix *features, matrix *target) {
     };
 }
 
+// File is streamed into one matrix, features and target are copied from its columns
 static
 data_set
 data_from_csv(char *filename, char** feature_labels, char **target_labels) {
-    csv *data = data_shuffle(csv_readfile(filename));
-
-    char **_fields = malloc((data->columns + 1) * sizeof(char*));
-    char **_target_labels = malloc(data->columns * sizeof(char*));
-    size_t _target_labels_index = 0;
-    for (size_t index = 0; index < data->columns; index++) {
-        _fields[index] = strdup(data->fields[index]);
-    }
-    _fields[data->columns] = NULL;
-    
-    matrix *all_data = Matrix.csv(data, _fields);
-
-    char **_feature_labels = calloc(all_data->columns + 1, sizeof(char*));
+    csv_stream *stream = csv_open(filename);
+    check(stream, "Can't read %s", filename);
 
-    if(feature_labels == NULL) {
-        size_t index = 0;
+    matrix *all_data = data_shuffle(data_stream_all(stream));
+    check(all_data, "Can't parse %s", filename);
 
-        while(_fields[index]) {
-            size_t target_label_index = 0;
-            while(target_labels[target_label_index]) {
-                if(strcmp(_fields[index], target_labels[target_label_index]) != 0) {
-                    _feature_labels[index] = _fields[index];
-                } else {
-                    _target_labels[_target_labels_index] = _fields[index];
-                    _target_labels_index++;
-                }
-                target_label_index++;
-            }
-            
-            index++;
-        }
-        _feature_labels[index] = NULL;
-        _feature_labels = realloc(_feature_labels, ++index * sizeof(char*));
-    } else {
-        size_t index = 0;
-        while(feature_labels[index]) {
-            _feature_labels[index] = strdup(feature_labels[index]);
-        }
+    char **_fields = calloc(stream->columns + 1, sizeof(char*));
+    check_memory(_fields);
+    for (size_t index = 0; index < stream->columns; index++) {
+        _fields[index] = strdup(stream->fields[index]);
     }
+    csv_close(stream);
 
-    _target_labels = realloc(_target_labels, (_target_labels_index + 1) * sizeof(char *));
-    _target_labels[_target_labels_index] = NULL;
+    char **_target_labels = data_labels(_fields, target_labels, true);
+    char **_feature_labels = data_labels(_fields, feature_labels ? feature_labels : target_labels, feature_labels != NULL);
 
-    matrix *features = Matrix.csv(data, _feature_labels);
-    matrix *target = Matrix.csv(data, _target_labels);
-    csv_delete(data);
+    matrix *features = data_columns(all_data, _fields, _feature_labels);
+    matrix *target = data_columns(all_data, _fields, _target_labels);
     
     data_set dataset = {
         .data = {
@@ -144,11 +155,327 @@ data_from_csv(char *filename, char** feature_labels, char **target_labels) {
     };
     
     return dataset;
+
+error:
+    csv_close(stream);
+    return (data_set){ 0 };
+}
+
+// Fields which are in list or which aren't, in order of fields
+static
+char **
+data_labels(char **fields, char **list, enum bool in_list) {
+    size_t count = 0;
+    char **labels = NULL;
+
+    while(fields[count]) {
+        count++;
+    }
+
+    labels = calloc(count + 1, sizeof(char*));
+    check_memory(labels);
+    count = 0;
+
+    for(size_t index = 0; fields[index]; index++) {
+        enum bool found = false;
+
+        for(size_t label = 0; list && list[label]; label++) {
+            if(strcmp(fields[index], list[label]) == 0) {
+                found = true;
+                break;
+            }
+        }
+
+        if(found == in_list) {
+            labels[count++] = fields[index];
+        }
+    }
+
+    return labels;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+data_columns(matrix *data, char **fields, char **labels) {
+    size_t count = 0;
+
+    check_memory(labels);
+    while(labels[count]) {
+        count++;
+    }
+    check(count, "No fields are selected");
+
+    matrix *columns = Matrix.create(data->rows, count);
+    check_memory(columns);
+
+    for(size_t label = 0; label < count; label++) {
+        size_t field = 0;
+        while(fields[field] != labels[label]) {
+            field++;
+        }
+
+        for(size_t row = 0; row < data->rows; row++) {
+            MATRIX(columns, row, label) = MATRIX(data, row, field);
+        }
+    }
+
+    return columns;
+
+error:
+    return NULL;
+}
+
+// Whole rest of stream, matrix capacity is doubled when it's filled
+static
+matrix *
+data_stream_all(csv_stream *stream) {
+    size_t capacity = 1024;
+    size_t rows = 0;
+    size_t read = 0;
+    matrix *data = Matrix.create(capacity, stream->columns);
+    check_memory(data);
+
+    while((read = csv_read_rows(stream, &MATRIX(data, rows, 0), capacity - rows))) {
+        rows += read;
+
+        if(rows == capacity) {
+            capacity *= 2;
+            data = Matrix.reshape(data, capacity, stream->columns);
+            check_memory(data);
+        }
+    }
+    check(rows, "Stream has no rows");
+
+    data->rows = rows;
+    data->vector->size = rows * data->columns;
+
+    return data;
+
+error:
+    if(data) {
+        Matrix.delete(data);
+    }
+    return NULL;
+}
+
+/* Stream */
+static
+size_t
+data_stream_next(csv_stream *stream, matrix *rows) {
+    check_memory(stream);
+    matrix_check_print(rows, "Rows for stream");
+    check(rows->columns == stream->columns, "Matrix has %zd columns, stream %zd", rows->columns, stream->columns);
+
+    return csv_read_rows(stream, rows->vector->values, rows->rows);
+
+error:
+    return 0;
+}
+
+/* Binary File */
+static
+enum bool
+data_file_write(data_set *data, char *filename) {
+    FILE *file = NULL;
+    matrix *features = data->features.values;
+    matrix *target = data->target.values;
+
+    matrix_check_print(features, "Features for %s", filename);
+    matrix_check_print(target, "Target for %s", filename);
+    check(features->rows == target->rows, "Features have %zd rows, target %zd", features->rows, target->rows);
+
+    data_file_header header = {
+        .magic = DATA_FILE_MAGIC,
+        .version = DATA_FILE_VERSION,
+        .labels_size = data_file_labels_size(data->features.labels, features->columns)
+                     + data_file_labels_size(data->target.labels, target->columns),
+
+        .rows = features->rows,
+        .features = features->columns,
+        .targets = target->columns,
+
+        .mean = data->normalization.mean,
+        .std = data->normalization.std
+    };
+
+    header.features_offset = DATA_FILE_ALIGN(sizeof(data_file_header) + header.labels_size);
+    header.target_offset = DATA_FILE_ALIGN(header.features_offset + features->vector->size * sizeof(float));
+
+    file = fopen(filename, "wb");
+    check(file, "Can't open %s for writing", filename);
+
+    check(fwrite(&header, sizeof(data_file_header), 1, file) == 1, "Header of %s isn't written", filename);
+    check(data_file_write_labels(file, data->features.labels, features->columns)
+          && data_file_write_labels(file, data->target.labels, target->columns),
+          "Labels of %s aren't written", filename);
+
+    // Gaps before blocks are left as holes of file
+    check(fseek(file, header.features_offset, SEEK_SET) == 0
+          && fwrite(features->vector->values, sizeof(float), features->vector->size, file) == features->vector->size,
+          "Features of %s aren't written", filename);
+    check(fseek(file, header.target_offset, SEEK_SET) == 0
+          && fwrite(target->vector->values, sizeof(float), target->vector->size, file) == target->vector->size,
+          "Target of %s isn't written", filename);
+
+    check(fclose(file) == 0, "Can't close %s", filename);
+
+    return true;
+
+error:
+    if(file) {
+        fclose(file);
+    }
+    return false;
+}
+
+// Pages are private, so training can't change the file
+static
+data_set
+data_file_map(char *filename) {
+    data_set data = { 0 };
+    arena_mark heap = Arena.push(NULL);
+    struct stat status;
+    int file = open(filename, O_RDONLY);
+    check(file >= 0, "Can't open %s", filename);
+
+    check(fstat(file, &status) == 0, "Can't stat %s", filename);
+    check((size_t)status.st_size >= sizeof(data_file_header), "%s is too small for data set", filename);
+
+    void *address = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    check(address != MAP_FAILED, "Can't map %s", filename);
+    close(file);
+    file = -1;
+
+    data.mapping.address = address;
+    data.mapping.size = status.st_size;
+
+    data_file_header *header = address;
+
+    check(memcmp(header->magic, DATA_FILE_MAGIC, sizeof(header->magic)) == 0, "%s isn't data set file", filename);
+    check(header->version == DATA_FILE_VERSION, "%s has version %u, expected %u", filename, header->version, DATA_FILE_VERSION);
+    check(header->rows && header->features && header->targets, "%s has empty data set", filename);
+    // Features end before target offset, target ends in file
+    check(header->features_offset % DATA_FILE_ALIGNMENT == 0 && header->target_offset % DATA_FILE_ALIGNMENT == 0
+          && sizeof(data_file_header) + header->labels_size <= header->features_offset
+          && header->target_offset <= data.mapping.size
+          && mapped_block_fits(header->features_offset, header->rows, header->features, header->target_offset)
+          && mapped_block_fits(header->target_offset, header->rows, header->targets, data.mapping.size),
+          "%s is broken or truncated", filename);
+
+    // Labels are kept in mapped pages, only lists of them are allocated
+    char *label = (char *)(header + 1);
+    char *labels_end = label + header->labels_size;
+    size_t fields_count = header->features + header->targets;
+    // Last label is terminated in the block, so strnlen stops inside it
+    check(header->labels_size && labels_end[-1] == '\0', "Labels of %s are broken", filename);
+
+    data.data.fields = calloc(fields_count + 1, sizeof(char*));
+    check_memory(data.data.fields);
+
+    for(size_t index = 0; index < fields_count; index++) {
+        check(label < labels_end, "Labels of %s are broken", filename);
+        data.data.fields[index] = label;
+        label += strnlen(label, labels_end - label) + 1;
+    }
+    check(label == labels_end, "%s has more labels than %zd fields", filename, fields_count);
+
+    data.features.labels = data_file_labels(data.data.fields, header->features);
+    data.target.labels = data_file_labels(data.data.fields + header->features, header->targets);
+    check_memory(data.features.labels);
+    check_memory(data.target.labels);
+
+    data.features.values = Matrix.view((float *)((char *)address + header->features_offset), header->rows, header->features);
+    data.target.values = Matrix.view((float *)((char *)address + header->target_offset), header->rows, header->targets);
+    check_memory(data.features.values);
+    check_memory(data.target.values);
+
+    data.normalization.mean = header->mean;
+    data.normalization.std = header->std;
+
+    Arena.pop(heap);
+
+    return data;
+
+error:
+    if(file >= 0) {
+        close(file);
+    }
+    data_file_unmap(&data);
+    Arena.pop(heap);
+    return (data_set){ 0 };
+}
+
+static
+size_t
+data_file_labels_size(char **labels, size_t count) {
+    size_t size = 0;
+
+    for(size_t index = 0; index < count; index++) {
+        size += (labels && labels[index] ? strlen(labels[index]) : 0) + 1;
+    }
+
+    return size;
+}
+
+// Missing label is written as empty string, so count of labels is kept
+static
+enum bool
+data_file_write_labels(FILE *file, char **labels, size_t count) {
+    for(size_t index = 0; index < count; index++) {
+        char *label = labels && labels[index] ? labels[index] : "";
+
+        if(fwrite(label, 1, strlen(label) + 1, file) != strlen(label) + 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static
+char **
+data_file_labels(char **fields, size_t count) {
+    char **labels = calloc(count + 1, sizeof(char*));
+
+    if(labels) {
+        memcpy(labels, fields, count * sizeof(char*));
+    }
+
+    return labels;
+}
+
+static
+void
+data_file_unmap(data_set *data) {
+    free(data->data.fields);
+    free(data->features.labels);
+    free(data->target.labels);
+
+    if(data->features.values) {
+        Matrix.delete(data->features.values);
+    }
+    if(data->target.values) {
+        Matrix.delete(data->target.values);
+    }
+
+    if(data->mapping.address) {
+        munmap(data->mapping.address, data->mapping.size);
+    }
+
+    *data = (data_set){ 0 };
 }
 
 static
 void
 data_delete(data_set *data) {
+    if(data->mapping.address) {
+        data_file_unmap(data);
+        return;
+    }
+
     for(size_t index = 0; index < data->data.values->columns; index++) {
         free(data->data.fields[index++]);
     }
@@ -171,28 +498,19 @@ data_part(data_set *set, size_t pool_offset, size_t pool_size) {
         return NULL;
     }
     
-    data_set *pool = malloc(sizeof(data_set));
-    size_t number_of_features = set->features.values->columns;
-    size_t number_of_targets = set->target.values->columns;
-    size_t number_of_fields = number_of_features + number_of_targets;
-    
-    matrix *pool_data = Matrix.create(pool_size, number_of_fields);
-    free(pool_data->vector->values);
-    pool_data->vector->values = &set->data.values->vector->values[pool_offset * set->data.values->columns];
+    // Part views rows of set, mapping stays owned by set
+    data_set *pool = calloc(1, sizeof(data_set));
     
-    matrix *pool_features = Matrix.create(pool_size, number_of_features);
-    free(pool_features->vector->values);
-    pool_features->vector->values = &set->features.values->vector->values[pool_offset * set->features.values->columns];
+    matrix *pool_features = Matrix.view(&MATRIX(set->features.values, pool_offset, 0), pool_size, set->features.values->columns);
     pool->features.labels = set->features.labels;
     pool->features.values = pool_features;
     
-    matrix *pool_target = Matrix.create(pool_size, number_of_targets);
-    free(pool_target->vector->values);
-    pool_target->vector->values = &set->target.values->vector->values[pool_offset * set->target.values->columns];
+    matrix *pool_target = Matrix.view(&MATRIX(set->target.values, pool_offset, 0), pool_size, set->target.values->columns);
     pool->target.labels = set->target.labels;
     pool->target.values = pool_target;
     
     pool->data = set->data;
+    pool->normalization = set->normalization;
     
     return pool;
 }
@@ -259,7 +577,7 @@ data_mini_batch(data_set *set, size_t batch_size) {
 static
 data_batch
 data_split(data_set *set, size_t batch_size, size_t train, size_t validation, size_t test) {
-    size_t set_size = set->data.values->rows;
+    size_t set_size = set->features.values->rows;
     
     size_t train_size = set_size * train / 100;
     size_t validation_size = set_size * validation / 100;
@@ -275,6 +593,7 @@ data_split(data_set *set, size_t batch_size, size_t train, size_t validation, si
     return (data_batch) {
         .size = set_size,
         .count = number_of_batches,
+        .batch_size = batch_size ? batch_size : train_size,
         .train = train_set,
         .mini = data_mini_batch(train_set, batch_size),
         .validation = data_part(set, train_size, validation_size),
@@ -282,13 +601,152 @@ data_split(data_set *set, size_t batch_size, size_t train, size_t validation, si
     };
 }
 
+/* Batches */
+// Fisher-Yates over row indices, rows stay where they are. Order starts
+// from identity, so it depends only on random seed
+static
+void
+data_batch_shuffle(data_batch *batch) {
+    check_memory(batch->train);
+    size_t rows = batch->train->features.values->rows;
+
+    if(batch->order == NULL) {
+        batch->order = malloc(rows * sizeof(size_t));
+        check_memory(batch->order);
+    }
+
+    for(size_t row = 0; row < rows; row++) {
+        batch->order[row] = row;
+    }
+
+    for(size_t row = rows - 1; row > 0; row--) {
+        size_t swap = (size_t)random_range(0, row + 1);
+        if(swap > row) {
+            swap = row;
+        }
+
+        size_t index = batch->order[row];
+        batch->order[row] = batch->order[swap];
+        batch->order[swap] = index;
+    }
+
+error:
+    return;
+}
+
+// Rows of shuffled mini-batch are copied into one reused buffer,
+// so it's valid until the next call
+static
+data_set *
+data_batch_mini(data_batch *batch, size_t index) {
+    check(index < batch->count, "Mini-batch %zd of %zd", index, batch->count);
+
+    if(batch->order == NULL) {
+        return batch->mini[index];
+    }
+
+    data_set *train = batch->train;
+    matrix *features = train->features.values;
+    matrix *target = train->target.values;
+
+    if(batch->gathered == NULL) {
+        arena_mark heap = Arena.push(NULL);
+        batch->gathered = calloc(1, sizeof(data_set));
+        batch->gathered->data = train->data;
+        batch->gathered->features.labels = train->features.labels;
+        batch->gathered->features.values = Matrix.create(batch->batch_size, features->columns);
+        batch->gathered->target.labels = train->target.labels;
+        batch->gathered->target.values = Matrix.create(batch->batch_size, target->columns);
+        batch->gathered->normalization = train->normalization;
+        Arena.pop(heap);
+    }
+
+    check(data_batch_gather(batch, index, batch->gathered), "Mini-batch %zd isn't gathered", index);
+
+    return batch->gathered;
+
+error:
+    return NULL;
+}
+
 static
-csv *
-data_shuffle(csv *data) {
+enum bool
+data_batch_gather(data_batch *batch, size_t index, data_set *into) {
+    matrix *features = batch->train->features.values;
+    matrix *target = batch->train->target.values;
+    matrix *into_features = into->features.values;
+    matrix *into_target = into->target.values;
+
+    check(index < batch->count, "Mini-batch %zd of %zd", index, batch->count);
+    matrix_check(into_features);
+    matrix_check(into_target);
+    check(into_features->rows == batch->batch_size && into_features->columns == features->columns
+          && into_target->columns == target->columns, "Set %zdx%zd can't hold mini-batch of %zdx%zd",
+          into_features->rows, into_features->columns, batch->batch_size, features->columns);
+
+    for(size_t row = 0; row < batch->batch_size; row++) {
+        size_t offset = index * batch->batch_size + row;
+        size_t source = batch->order ? batch->order[offset] : offset;
+
+        memcpy(&MATRIX(into_features, row, 0), &MATRIX(features, source, 0), features->columns * sizeof(float));
+        memcpy(&MATRIX(into_target, row, 0), &MATRIX(target, source, 0), target->columns * sizeof(float));
+    }
+
+    return true;
+
+error:
+    return false;
+}
+
+static
+void
+data_batch_delete(data_batch *batch) {
+    for(size_t index = 0; batch->mini && index < batch->count; index++) {
+        if(batch->mini[index] != batch->train) {
+            data_part_delete(batch->mini[index]);
+        }
+    }
+    free(batch->mini);
+
+    data_part_delete(batch->train);
+    data_part_delete(batch->validation);
+    data_part_delete(batch->test);
+
+    if(batch->gathered) {
+        Matrix.delete(batch->gathered->features.values);
+        Matrix.delete(batch->gathered->target.values);
+        free(batch->gathered);
+    }
+    free(batch->order);
+
+    *batch = (data_batch){ 0 };
+}
+
+// Part owns only its views, labels and data belong to set
+static
+void
+data_part_delete(data_set *part) {
+    if(part == NULL) {
+        return;
+    }
+
+    Matrix.delete(part->features.values);
+    Matrix.delete(part->target.values);
+    free(part);
+}
+
+static
+matrix *
+data_shuffle(matrix *data) {
+    check_memory(data);
+
     // Shuffle
     size_t set_size = data->rows;
     for(size_t index = 0; index < set_size; index++) {
         size_t shuffled = (size_t)random_range(0, set_size);
+        if(shuffled >= set_size) {
+            shuffled = set_size - 1;
+        }
         
         if(shuffled == index) {
             if(index == set_size - 1) {
@@ -300,12 +758,17 @@ data_shuffle(csv *data) {
             }
         }
         
-        char **shuffled_row = data->values[index];
-        data->values[index] = data->values[shuffled];
-        data->values[shuffled] = shuffled_row;
+        for(size_t column = 0; column < data->columns; column++) {
+            float value = MATRIX(data, index, column);
+            MATRIX(data, index, column) = MATRIX(data, shuffled, column);
+            MATRIX(data, shuffled, column) = value;
+        }
     }
     
     return data;
+
+error:
+    return NULL;
 }
 
 static
@@ -10,8 +10,33 @@
 #define set_h
 
 #include <stdio.h>
+#include <stdint.h>
 #include "../math/probability.h"
 
+/* Binary data set file: header, NULL separated labels of features and
+   target, then float32 row-major features and target blocks. Blocks start
+   at page boundary, so mapped file is used by matrices without copying */
+#define DATA_FILE_MAGIC     "NAIVEDS"
+#define DATA_FILE_VERSION   1
+#define DATA_FILE_ALIGNMENT 4096
+
+typedef struct {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    labels_size;
+
+    uint64_t    rows;
+    uint64_t    features;
+    uint64_t    targets;
+
+    // Offsets from file start
+    uint64_t    features_offset;
+    uint64_t    target_offset;
+
+    float       mean;
+    float       std;
+} data_file_header;
+
 typedef struct {    
     struct {
         matrix *    values;
@@ -32,22 +57,61 @@ typedef struct {
         float      mean;
         float      std;
     } normalization;
+
+    // Mapped file which values are viewing, NULL when they are on heap
+    struct {
+        void *     address;
+        size_t     size;
+    } mapping;
     
 } data_set;
 
 typedef struct {
     size_t   size;
     size_t   count;
+    size_t   batch_size;
     data_set *train;
+    // Views of consecutive train rows
     data_set **mini;
     data_set *validation;
     data_set *test;
+
+    // Order of train rows after shuffle, NULL while rows are in place.
+    // Mini-batch of shuffled order is gathered into own buffers
+    size_t   *order;
+    data_set *gathered;
 } data_batch;
 
 struct data_library {
     data_set      (*matrix)(matrix *features, matrix *target);
     data_set      (*csv)(char *filename, char** fields, char **target);
+    
+    // Files bigger than memory are read by chunks of rows
+    struct {
+        csv_stream * (*open)(char *filename);
+        // Fills rows of matrix, returns count of rows read, 0 at the end
+        size_t       (*next)(csv_stream *stream, matrix *rows);
+        enum bool    (*rewind)(csv_stream *stream);
+        void         (*close)(csv_stream *stream);
+    } stream;
+    
+    struct {
+        enum bool (*write)(data_set *data, char *filename);
+        // Features and target are views of mapped file, all data is NULL
+        data_set  (*map)(char *filename);
+    } file;
+
     data_batch    (*split)(data_set *set, size_t batch_size, size_t train, size_t validation, size_t test);
+    
+    struct {
+        // Train rows get new random order, data isn't moved
+        void        (*shuffle)(data_batch *batch);
+        data_set *  (*mini)(data_batch *batch, size_t index);
+        // Copies rows of mini-batch in current order into batch sized set
+        enum bool   (*gather)(data_batch *batch, size_t index, data_set *into);
+        // Parts of split, the set itself is left
+        void        (*delete)(data_batch *batch);
+    } batch;
     void          (*delete)(data_set *data);
     void          (*print)(data_set *data);
     struct {
@@ -0,0 +1,602 @@
+//
+//  gemm.c
+//  math
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+//  Goto / BLIS scheme: B is packed by KC x NC blocks (L3), A by MC x KC
+//  blocks (L2), micro kernel keeps MR x NR tile of C in registers
+//  while streaming packed panels from L1.
+//
+
+#include <pthread.h>
+#include "gemm.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GEMM_X86 1
+#endif
+
+typedef void (*gemm_kernel)(size_t depth, const float *a, const float *b,
+                            float alpha, float beta, float *C, size_t c_row_stride);
+typedef void (*gemv_kernel)(size_t rows, size_t columns, float alpha, const float *A, size_t a_row_stride,
+                            const float *x, float beta, float *y);
+typedef void (*gemm_s8_kernel)(size_t rows, size_t columns, size_t depth, const int8_t *A, size_t a_row_stride,
+                               const uint8_t *B, size_t b_row_stride, int32_t *C, size_t c_row_stride);
+
+static void         gemm_kernel_scalar(size_t depth, const float *a, const float *b,
+                                       float alpha, float beta, float *C, size_t c_row_stride);
+#ifdef GEMM_X86
+static void         gemm_kernel_avx2(size_t depth, const float *a, const float *b,
+                                     float alpha, float beta, float *C, size_t c_row_stride);
+#endif
+static gemm_kernel  gemm_kernel_select(void);
+static gemm_s8_kernel gemm_s8_kernel_select(void);
+static void         gemm_kernel_init(void);
+
+static void         gemv_kernel_scalar(size_t rows, size_t columns, float alpha, const float *A, size_t a_row_stride,
+                                       const float *x, float beta, float *y);
+#ifdef GEMM_X86
+static void         gemv_kernel_avx2(size_t rows, size_t columns, float alpha, const float *A, size_t a_row_stride,
+                                     const float *x, float beta, float *y);
+#endif
+
+static void         gemm_s8_kernel_scalar(size_t rows, size_t columns, size_t depth, const int8_t *A, size_t a_row_stride,
+                                          const uint8_t *B, size_t b_row_stride, int32_t *C, size_t c_row_stride);
+
+static void         pack_a(size_t rows, size_t depth, const float *A, size_t row_stride, size_t column_stride, float *packed);
+static void         pack_b(size_t depth, size_t columns, const float *B, size_t row_stride, size_t column_stride, float *packed);
+static void         scale_c(size_t rows, size_t columns, float beta, float *C, size_t c_row_stride);
+static void         gemm_unpacked(size_t rows, size_t columns, size_t depth, float alpha,
+                                  const float *A, size_t a_row_stride, size_t a_column_stride,
+                                  const float *B, size_t b_row_stride, size_t b_column_stride,
+                                  float beta, float *C, size_t c_row_stride);
+
+
+static gemm_kernel  kernel = NULL;
+static gemv_kernel  vector_kernel = NULL;
+static gemm_s8_kernel integer_kernel = NULL;
+static const char  *kernel_name = "scalar";
+static const char  *integer_kernel_name = "scalar";
+// Threads which fire at once see the whole choice of kernels
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+// Each thread packs into own buffers, allocated once
+static _Thread_local float *packed_a = NULL;
+static _Thread_local float *packed_b = NULL;
+
+
+/* Product */
+void
+gemm(size_t rows, size_t columns, size_t depth,
+     float alpha,
+     const float *A, size_t a_row_stride, size_t a_column_stride,
+     const float *B, size_t b_row_stride, size_t b_column_stride,
+     float beta,
+     float *C, size_t c_row_stride) {
+    if(rows == 0 || columns == 0) {
+        return;
+    }
+
+    if(depth == 0 || alpha == 0) {
+        scale_c(rows, columns, beta, C, c_row_stride);
+        return;
+    }
+
+    pthread_once(&kernel_once, gemm_kernel_init);
+
+    if(packed_a == NULL) {
+        packed_a = aligned_alloc(64, GEMM_MC * GEMM_KC * sizeof(float));
+        packed_b = aligned_alloc(64, GEMM_KC * GEMM_NC * sizeof(float));
+        if(packed_a == NULL || packed_b == NULL) {
+            free(packed_a);
+            free(packed_b);
+            packed_a = packed_b = NULL;
+            // Slow but still right, the next call tries to allocate again
+            gemm_unpacked(rows, columns, depth, alpha, A, a_row_stride, a_column_stride,
+                          B, b_row_stride, b_column_stride, beta, C, c_row_stride);
+            return;
+        }
+    }
+
+    float tile[GEMM_MR * GEMM_NR];
+
+    for(size_t jc = 0; jc < columns; jc += GEMM_NC) {
+        size_t nc = columns - jc < GEMM_NC ? columns - jc : GEMM_NC;
+
+        for(size_t pc = 0; pc < depth; pc += GEMM_KC) {
+            size_t kc = depth - pc < GEMM_KC ? depth - pc : GEMM_KC;
+            // Later depth blocks accumulate into C
+            float block_beta = pc == 0 ? beta : 1;
+
+            pack_b(kc, nc, B + pc * b_row_stride + jc * b_column_stride, b_row_stride, b_column_stride, packed_b);
+
+            for(size_t ic = 0; ic < rows; ic += GEMM_MC) {
+                size_t mc = rows - ic < GEMM_MC ? rows - ic : GEMM_MC;
+
+                pack_a(mc, kc, A + ic * a_row_stride + pc * a_column_stride, a_row_stride, a_column_stride, packed_a);
+
+                for(size_t jr = 0; jr < nc; jr += GEMM_NR) {
+                    size_t nr = nc - jr < GEMM_NR ? nc - jr : GEMM_NR;
+                    const float *b = packed_b + jr * kc;
+
+                    for(size_t ir = 0; ir < mc; ir += GEMM_MR) {
+                        size_t mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+                        const float *a = packed_a + ir * kc;
+                        float *c = C + (ic + ir) * c_row_stride + jc + jr;
+
+                        if(mr == GEMM_MR && nr == GEMM_NR) {
+                            kernel(kc, a, b, alpha, block_beta, c, c_row_stride);
+                            continue;
+                        }
+
+                        // Edge of C, full tile goes to stack and only its part is stored
+                        kernel(kc, a, b, alpha, 0, tile, GEMM_NR);
+                        for(size_t i = 0; i < mr; i++) {
+                            for(size_t j = 0; j < nr; j++) {
+                                c[i * c_row_stride + j] = block_beta == 0
+                                    ? tile[i * GEMM_NR + j]
+                                    : tile[i * GEMM_NR + j] + block_beta * c[i * c_row_stride + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+gemv(size_t rows, size_t columns,
+     float alpha,
+     const float *A, size_t a_row_stride,
+     const float *x,
+     float beta,
+     float *y) {
+    if(rows == 0) {
+        return;
+    }
+
+    if(columns == 0 || alpha == 0) {
+        scale_c(rows, 1, beta, y, 1);
+        return;
+    }
+
+    pthread_once(&kernel_once, gemm_kernel_init);
+
+    vector_kernel(rows, columns, alpha, A, a_row_stride, x, beta, y);
+}
+
+void
+gemm_s8(size_t rows, size_t columns, size_t depth,
+        const int8_t *A, size_t a_row_stride,
+        const uint8_t *B, size_t b_row_stride,
+        int32_t *C, size_t c_row_stride) {
+    if(rows == 0 || columns == 0) {
+        return;
+    }
+
+    pthread_once(&kernel_once, gemm_kernel_init);
+
+    integer_kernel(rows, columns, depth, A, a_row_stride, B, b_row_stride, C, c_row_stride);
+}
+
+void
+gemm_release(void) {
+    free(packed_a);
+    free(packed_b);
+    packed_a = packed_b = NULL;
+}
+
+const char *
+gemm_kernel_name(void) {
+    pthread_once(&kernel_once, gemm_kernel_init);
+
+    return kernel_name;
+}
+
+const char *
+gemm_s8_kernel_name(void) {
+    pthread_once(&kernel_once, gemm_kernel_init);
+
+    return integer_kernel_name;
+}
+
+static
+void
+scale_c(size_t rows, size_t columns, float beta, float *C, size_t c_row_stride) {
+    for(size_t row = 0; row < rows; row++) {
+        float *c = C + row * c_row_stride;
+
+        for(size_t column = 0; column < columns; column++) {
+            c[column] = beta == 0 ? 0 : beta * c[column];
+        }
+    }
+}
+
+// Product by strides without packing buffers
+static
+void
+gemm_unpacked(size_t rows, size_t columns, size_t depth, float alpha,
+              const float *A, size_t a_row_stride, size_t a_column_stride,
+              const float *B, size_t b_row_stride, size_t b_column_stride,
+              float beta, float *C, size_t c_row_stride) {
+    for(size_t row = 0; row < rows; row++) {
+        float *c = C + row * c_row_stride;
+
+        for(size_t column = 0; column < columns; column++) {
+            float sum = 0;
+
+            for(size_t p = 0; p < depth; p++) {
+                sum += A[row * a_row_stride + p * a_column_stride] * B[p * b_row_stride + column * b_column_stride];
+            }
+            c[column] = beta == 0 ? alpha * sum : alpha * sum + beta * c[column];
+        }
+    }
+}
+
+
+/* Packing */
+// Panels of MR rows, each stored column by column, rows out of A are zero
+static
+void
+pack_a(size_t rows, size_t depth, const float *A, size_t row_stride, size_t column_stride, float *packed) {
+    for(size_t panel = 0; panel < rows; panel += GEMM_MR) {
+        size_t mr = rows - panel < GEMM_MR ? rows - panel : GEMM_MR;
+        const float *a = A + panel * row_stride;
+
+        for(size_t p = 0; p < depth; p++) {
+            size_t i = 0;
+
+            for(; i < mr; i++) {
+                *packed++ = a[i * row_stride + p * column_stride];
+            }
+            for(; i < GEMM_MR; i++) {
+                *packed++ = 0;
+            }
+        }
+    }
+}
+
+// Panels of NR columns, each stored row by row, columns out of B are zero
+static
+void
+pack_b(size_t depth, size_t columns, const float *B, size_t row_stride, size_t column_stride, float *packed) {
+    for(size_t panel = 0; panel < columns; panel += GEMM_NR) {
+        size_t nr = columns - panel < GEMM_NR ? columns - panel : GEMM_NR;
+        const float *b = B + panel * column_stride;
+
+        for(size_t p = 0; p < depth; p++) {
+            const float *b_row = b + p * row_stride;
+            size_t j = 0;
+
+            if(column_stride == 1) {
+                memcpy(packed, b_row, nr * sizeof(float));
+                j = nr;
+            } else {
+                for(; j < nr; j++) {
+                    packed[j] = b_row[j * column_stride];
+                }
+            }
+            for(; j < GEMM_NR; j++) {
+                packed[j] = 0;
+            }
+
+            packed += GEMM_NR;
+        }
+    }
+}
+
+
+/* Micro kernels */
+static
+void
+gemm_kernel_scalar(size_t depth, const float *a, const float *b,
+                   float alpha, float beta, float *C, size_t c_row_stride) {
+    float accumulator[GEMM_MR][GEMM_NR] = {{0}};
+
+    for(size_t p = 0; p < depth; p++) {
+        for(size_t i = 0; i < GEMM_MR; i++) {
+            float a_value = a[p * GEMM_MR + i];
+
+            for(size_t j = 0; j < GEMM_NR; j++) {
+                accumulator[i][j] += a_value * b[p * GEMM_NR + j];
+            }
+        }
+    }
+
+    for(size_t i = 0; i < GEMM_MR; i++) {
+        float *c = C + i * c_row_stride;
+
+        for(size_t j = 0; j < GEMM_NR; j++) {
+            c[j] = beta == 0
+                ? alpha * accumulator[i][j]
+                : alpha * accumulator[i][j] + beta * c[j];
+        }
+    }
+}
+
+static
+void
+gemm_s8_kernel_scalar(size_t rows, size_t columns, size_t depth, const int8_t *A, size_t a_row_stride,
+                      const uint8_t *B, size_t b_row_stride, int32_t *C, size_t c_row_stride) {
+    for(size_t row = 0; row < rows; row++) {
+        const int8_t *a = A + row * a_row_stride;
+
+        for(size_t column = 0; column < columns; column++) {
+            const uint8_t *b = B + column * b_row_stride;
+            int32_t dot = 0;
+
+            for(size_t p = 0; p < depth; p++) {
+                dot += (int32_t)a[p] * b[p];
+            }
+
+            C[row * c_row_stride + column] = dot;
+        }
+    }
+}
+
+static
+void
+gemv_kernel_scalar(size_t rows, size_t columns, float alpha, const float *A, size_t a_row_stride,
+                   const float *x, float beta, float *y) {
+    for(size_t row = 0; row < rows; row++) {
+        const float *a = A + row * a_row_stride;
+        float dot = 0;
+
+        for(size_t p = 0; p < columns; p++) {
+            dot += a[p] * x[p];
+        }
+
+        y[row] = beta == 0 ? alpha * dot : alpha * dot + beta * y[row];
+    }
+}
+
+#ifdef GEMM_X86
+__attribute__((target("avx2,fma")))
+static inline
+float
+gemv_horizontal_avx2(__m256 sum) {
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x55));
+
+    return _mm_cvtss_f32(half);
+}
+
+// GEMV_ROWS rows share each load of x, so x is read once per block of rows
+__attribute__((target("avx2,fma")))
+static
+void
+gemv_kernel_avx2(size_t rows, size_t columns, float alpha, const float *A, size_t a_row_stride,
+                 const float *x, float beta, float *y) {
+    size_t row = 0;
+
+    for(; row + GEMV_ROWS <= rows; row += GEMV_ROWS) {
+        const float *a0 = A + row * a_row_stride;
+        const float *a1 = a0 + a_row_stride;
+        const float *a2 = a1 + a_row_stride;
+        const float *a3 = a2 + a_row_stride;
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+        size_t p = 0;
+
+        for(; p + 8 <= columns; p += 8) {
+            __m256 x_value = _mm256_loadu_ps(x + p);
+
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + p), x_value, s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + p), x_value, s1);
+            s2 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + p), x_value, s2);
+            s3 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + p), x_value, s3);
+        }
+
+        float dots[GEMV_ROWS] = {
+            gemv_horizontal_avx2(s0), gemv_horizontal_avx2(s1),
+            gemv_horizontal_avx2(s2), gemv_horizontal_avx2(s3)
+        };
+
+        for(; p < columns; p++) {
+            dots[0] += a0[p] * x[p];
+            dots[1] += a1[p] * x[p];
+            dots[2] += a2[p] * x[p];
+            dots[3] += a3[p] * x[p];
+        }
+
+        for(size_t i = 0; i < GEMV_ROWS; i++) {
+            y[row + i] = beta == 0 ? alpha * dots[i] : alpha * dots[i] + beta * y[row + i];
+        }
+    }
+
+    for(; row < rows; row++) {
+        const float *a = A + row * a_row_stride;
+        __m256 sum = _mm256_setzero_ps();
+        size_t p = 0;
+
+        for(; p + 8 <= columns; p += 8) {
+            sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + p), _mm256_loadu_ps(x + p), sum);
+        }
+
+        float dot = gemv_horizontal_avx2(sum);
+        for(; p < columns; p++) {
+            dot += a[p] * x[p];
+        }
+
+        y[row] = beta == 0 ? alpha * dot : alpha * dot + beta * y[row];
+    }
+}
+
+__attribute__((target("avx2")))
+static inline
+int32_t
+gemm_s8_horizontal_avx2(__m256i sum) {
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+
+    return _mm_cvtsi128_si32(half);
+}
+
+// 32 pairs of B and A are accumulated into int32 lanes by one step. Block
+// of GEMV_ROWS rows of A stays in L1 while every row of B passes it
+#define GEMM_S8_KERNEL(name, attribute, accumulate)                                             \
+    attribute                                                                                    \
+    static void name(size_t rows, size_t columns, size_t depth, const int8_t *A, size_t a_row_stride, \
+                     const uint8_t *B, size_t b_row_stride, int32_t *C, size_t c_row_stride) {  \
+        size_t row = 0;                                                                          \
+        for(; row < rows; row += GEMV_ROWS) {                                                    \
+            size_t block = rows - row < GEMV_ROWS ? rows - row : GEMV_ROWS;                      \
+            const int8_t *a[GEMV_ROWS];                                                          \
+            for(size_t i = 0; i < GEMV_ROWS; i++) {                                              \
+                /* Short block repeats its last row, only its own rows are stored */             \
+                a[i] = A + (row + (i < block ? i : block - 1)) * a_row_stride;                  \
+            }                                                                                    \
+                                                                                                 \
+            for(size_t column = 0; column < columns; column++) {                                 \
+                const uint8_t *b = B + column * b_row_stride;                                    \
+                __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();                \
+                __m256i s2 = _mm256_setzero_si256(), s3 = _mm256_setzero_si256();                \
+                size_t p = 0;                                                                    \
+                                                                                                 \
+                for(; p + 32 <= depth; p += 32) {                                                \
+                    __m256i b_value = _mm256_loadu_si256((const __m256i *)(b + p));              \
+                                                                                                 \
+                    s0 = accumulate(s0, b_value, _mm256_loadu_si256((const __m256i *)(a[0] + p))); \
+                    s1 = accumulate(s1, b_value, _mm256_loadu_si256((const __m256i *)(a[1] + p))); \
+                    s2 = accumulate(s2, b_value, _mm256_loadu_si256((const __m256i *)(a[2] + p))); \
+                    s3 = accumulate(s3, b_value, _mm256_loadu_si256((const __m256i *)(a[3] + p))); \
+                }                                                                                \
+                                                                                                 \
+                int32_t dots[GEMV_ROWS] = {                                                      \
+                    gemm_s8_horizontal_avx2(s0), gemm_s8_horizontal_avx2(s1),                    \
+                    gemm_s8_horizontal_avx2(s2), gemm_s8_horizontal_avx2(s3)                     \
+                };                                                                               \
+                for(; p < depth; p++) {                                                          \
+                    for(size_t i = 0; i < GEMV_ROWS; i++) {                                      \
+                        dots[i] += (int32_t)a[i][p] * b[p];                                      \
+                    }                                                                            \
+                }                                                                                \
+                                                                                                 \
+                for(size_t i = 0; i < block; i++) {                                              \
+                    C[(row + i) * c_row_stride + column] = dots[i];                              \
+                }                                                                                \
+            }                                                                                    \
+        }                                                                                        \
+    }
+
+// u8 x s8 pairs are summed to int16, then pairs of them to int32
+__attribute__((target("avx2")))
+static inline
+__m256i
+gemm_s8_accumulate_avx2(__m256i sum, __m256i b, __m256i a) {
+    return _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(b, a), _mm256_set1_epi16(1)));
+}
+
+GEMM_S8_KERNEL(gemm_s8_kernel_avx2, __attribute__((target("avx2"))), gemm_s8_accumulate_avx2)
+GEMM_S8_KERNEL(gemm_s8_kernel_vnni, __attribute__((target("avx2,avx512vnni,avx512vl"))), _mm256_dpbusd_epi32)
+
+// 6 x 16 tile is 12 ymm accumulators, two for B row and one for A broadcast
+__attribute__((target("avx2,fma")))
+static
+void
+gemm_kernel_avx2(size_t depth, const float *a, const float *b,
+                 float alpha, float beta, float *C, size_t c_row_stride) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for(size_t p = 0; p < depth; p++) {
+        __m256 b0 = _mm256_load_ps(b);
+        __m256 b1 = _mm256_load_ps(b + 8);
+        __m256 a_value;
+
+        a_value = _mm256_broadcast_ss(a + 0);
+        c00 = _mm256_fmadd_ps(a_value, b0, c00);
+        c01 = _mm256_fmadd_ps(a_value, b1, c01);
+        a_value = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(a_value, b0, c10);
+        c11 = _mm256_fmadd_ps(a_value, b1, c11);
+        a_value = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(a_value, b0, c20);
+        c21 = _mm256_fmadd_ps(a_value, b1, c21);
+        a_value = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(a_value, b0, c30);
+        c31 = _mm256_fmadd_ps(a_value, b1, c31);
+        a_value = _mm256_broadcast_ss(a + 4);
+        c40 = _mm256_fmadd_ps(a_value, b0, c40);
+        c41 = _mm256_fmadd_ps(a_value, b1, c41);
+        a_value = _mm256_broadcast_ss(a + 5);
+        c50 = _mm256_fmadd_ps(a_value, b0, c50);
+        c51 = _mm256_fmadd_ps(a_value, b1, c51);
+
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+
+    __m256 alpha_vector = _mm256_set1_ps(alpha);
+    __m256 beta_vector = _mm256_set1_ps(beta);
+    __m256 rows[GEMM_MR][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 },
+        { c30, c31 }, { c40, c41 }, { c50, c51 }
+    };
+
+    for(size_t i = 0; i < GEMM_MR; i++) {
+        float *c = C + i * c_row_stride;
+        __m256 low = _mm256_mul_ps(alpha_vector, rows[i][0]);
+        __m256 high = _mm256_mul_ps(alpha_vector, rows[i][1]);
+
+        if(beta != 0) {
+            low = _mm256_fmadd_ps(beta_vector, _mm256_loadu_ps(c), low);
+            high = _mm256_fmadd_ps(beta_vector, _mm256_loadu_ps(c + 8), high);
+        }
+
+        _mm256_storeu_ps(c, low);
+        _mm256_storeu_ps(c + 8, high);
+    }
+}
+#endif
+
+static
+gemm_kernel
+gemm_kernel_select(void) {
+#ifdef GEMM_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        kernel_name = "avx2";
+        vector_kernel = gemv_kernel_avx2;
+        return gemm_kernel_avx2;
+    }
+#endif
+    kernel_name = "scalar";
+    vector_kernel = gemv_kernel_scalar;
+    return gemm_kernel_scalar;
+}
+
+// VNNI sums quads of u8 x s8 into int32 by one instruction
+static
+gemm_s8_kernel
+gemm_s8_kernel_select(void) {
+#ifdef GEMM_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl")) {
+        integer_kernel_name = "vnni";
+        return gemm_s8_kernel_vnni;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        integer_kernel_name = "avx2";
+        return gemm_s8_kernel_avx2;
+    }
+#endif
+    integer_kernel_name = "scalar";
+    return gemm_s8_kernel_scalar;
+}
+
+static
+void
+gemm_kernel_init(void) {
+    kernel = gemm_kernel_select();
+    integer_kernel = gemm_s8_kernel_select();
+}
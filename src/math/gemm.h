@@ -0,0 +1,71 @@
+//
+//  gemm.h
+//  math
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef gemm_h
+#define gemm_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Blocking of packed panels, MR x NR is the register tile of micro kernel */
+#define GEMM_MR 6
+#define GEMM_NR 16
+#define GEMM_MC 120
+#define GEMM_KC 256
+#define GEMM_NC 2048
+
+/*
+ * C = alpha * A * B + beta * C for row-major C (rows x columns),
+ * A (rows x depth) and B (depth x columns) are read by row and column
+ * strides, so transposed operand is the same matrix with swapped strides.
+ * When beta is zero C is only written.
+ */
+void gemm(size_t rows, size_t columns, size_t depth,
+          float alpha,
+          const float *A, size_t a_row_stride, size_t a_column_stride,
+          const float *B, size_t b_row_stride, size_t b_column_stride,
+          float beta,
+          float *C, size_t c_row_stride);
+
+/*
+ * y = alpha * A * x + beta * y for row-major A (rows x columns) with row
+ * stride, x has columns values and y has rows. Nothing is packed, rows
+ * of A are streamed once by blocks of GEMV_ROWS sharing loads of x.
+ * When beta is zero y is only written.
+ */
+#define GEMV_ROWS 4
+
+void gemv(size_t rows, size_t columns,
+          float alpha,
+          const float *A, size_t a_row_stride,
+          const float *x,
+          float beta,
+          float *y);
+
+/*
+ * C = A * B^T for int8 A (rows x depth) and uint8 B (columns x depth),
+ * both are read along depth by rows, C is int32 rows x columns. Values
+ * of B are at most GEMM_S8_MAX, so pair sums of AVX2 kernel (vpmaddubsw)
+ * can't saturate int16 and every kernel gives the same exact result.
+ */
+#define GEMM_S8_MAX 127
+
+void gemm_s8(size_t rows, size_t columns, size_t depth,
+             const int8_t *A, size_t a_row_stride,
+             const uint8_t *B, size_t b_row_stride,
+             int32_t *C, size_t c_row_stride);
+
+// Packing buffers of calling thread, worker threads give them back before exit
+void gemm_release(void);
+
+const char *gemm_kernel_name(void);
+const char *gemm_s8_kernel_name(void);
+
+#endif /* gemm_h */
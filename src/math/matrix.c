@@ -9,10 +9,12 @@
 #include "matrix.h"
 
 // Life Cycle
+static matrix *matrix_allocate(size_t rows, size_t columns);
 static matrix *matrix_create(size_t rows, size_t columns);
 static matrix *matrix_create_from_list(size_t rows, size_t columns, float *values);
 static matrix *matrix_copy(matrix *original);
 static matrix *matrix_reshape(matrix *instance, size_t rows, size_t columns);
+static matrix *matrix_view(float *values, size_t rows, size_t columns);
 static void   matrix_delete(matrix *instance);
 
 // Data
@@ -24,20 +26,32 @@ static matrix *matrix_from_cast(void *data, size_t rows, size_t columns);
 static matrix *matrix_from_csv(csv *file, char **fields);
 static matrix *matrix_from_vector(vector *v, size_t columns);
 static matrix *matrix_from_vectors(vector **vectors, size_t rows, size_t columns);
+static matrix *matrix_from_columns(vector **columns, size_t count);
 
 static vector *matrix_column_vector(matrix *A, size_t column);
 
+static vector *matrix_slice_row(matrix *A, size_t row);
+static vector *matrix_slice_column(matrix *A, size_t column);
+static vector *matrix_slice_diagonal(matrix *A);
+static matrix *matrix_slice_block(matrix *A, size_t row, size_t column, size_t rows, size_t columns);
+
 // Transformation
 static matrix *matrix_transpose(matrix *instance);
-vector *vector_transformation_by_matrix(matrix *A, vector *x);
+static matrix *matrix_transposed(matrix *A, matrix *into);
 
 // Operations
 static matrix *matrix_map(matrix *A, float operation(float));
 
 static matrix *matrix_multiplication_cast(matrix *A, void *some_b);
 static matrix *matrix_multiplication(matrix *A, matrix *B);
+static matrix *matrix_vector_multiplication(matrix *A, vector *x);
+static vector *matrix_gemv(float alpha, matrix *A, vector *x, float beta, vector *y);
 static matrix *matrix_scalar_multiplication(matrix *A, float scalar);
 
+static matrix *matrix_gemm(float alpha, matrix *A, matrix *B, float beta, matrix *C);
+static matrix *matrix_gemm_transposed_b(float alpha, matrix *A, matrix *B, float beta, matrix *C);
+static matrix *matrix_gemm_transposed_a(float alpha, matrix *A, matrix *B, float beta, matrix *C);
+
 static matrix *matrix_division_cast(matrix *A, void *some_b);
 static matrix *matrix_division(matrix *A, matrix *B);
 static matrix *matrix_scalar_division(matrix *A, float scalar);
@@ -69,18 +83,27 @@ const struct matrix_library Matrix = {
     .create = matrix_create,
     .copy = matrix_copy,
     .reshape = matrix_reshape,
+    .view = matrix_view,
     .delete = matrix_delete,
     
     .print = matrix_print,
     
     .from = matrix_from_cast,
     .csv = matrix_from_csv,
+    .columns = matrix_from_columns,
     
     .identity = matrix_identity,
     .diagonal = matrix_diagonal_from_vector,
     
     .seed = matrix_seed,
     .column = matrix_column_vector,
+
+    .slice = {
+        .row = matrix_slice_row,
+        .column = matrix_slice_column,
+        .diagonal = matrix_slice_diagonal,
+        .block = matrix_slice_block
+    },
     
     .prop = {
         .sum = matrix_sum,
@@ -97,30 +120,92 @@ const struct matrix_library Matrix = {
     .mul = matrix_multiplication_cast,
     .div = matrix_division_cast,
     
+    .mm = {
+        .add = matrix_addition,
+        .sub = matrix_substraction,
+        .mul = matrix_multiplication,
+        .div = matrix_division
+    },
+    
+    .mv = {
+        .mul = matrix_vector_multiplication,
+        .gemv = matrix_gemv
+    },
+    
+    .ms = {
+        .add = matrix_scalar_addition,
+        .sub = matrix_scalar_substraction,
+        .mul = matrix_scalar_multiplication,
+        .div = matrix_scalar_division
+    },
+    
+    .gemm = {
+        .ab = matrix_gemm,
+        .abt = matrix_gemm_transposed_b,
+        .atb = matrix_gemm_transposed_a
+    },
+    
     .transpose = matrix_transpose,
+    .transposed = matrix_transposed,
     .map = matrix_map
 };
 
 
 /* Marcos */
-#define MATRIX_OPERATION(A, B, expression)                                                             \
-    matrix_foreach(A)                                                                                  \
-    {                                                                                                  \
-        MATRIX(A, row, column) = MATRIX(A, row, column) expression MATRIX(B, row, column);             \
-        check(MATRIX(A, row, column) == MATRIX(A, row, column),                                        \
-              "Operation x " #expression " %f is %f", MATRIX(B, row, column), MATRIX(A, row, column)); \
-    }
+// Blocks are taken by rows, packed matrices as one vector
+#define MATRIX_OPERATION(A, B, operation)                                                   \
+    check((A)->rows == (B)->rows && (A)->columns == (B)->columns,                           \
+          "Matrix sizes doesn't match %zdx%zd " #operation " %zdx%zd",                      \
+          (A)->rows, (A)->columns, (B)->rows, (B)->columns);                                \
+    if(MATRIX_PACKED(A) && MATRIX_PACKED(B)) {                                              \
+        check(Vector.vv.operation((A)->vector, (B)->vector), "Matrix " #operation " failed"); \
+    } else {                                                                                \
+        for(size_t row = 0; row < (A)->rows; row++) {                                       \
+            simd_##operation(&MATRIX(A, row, 0), &MATRIX(A, row, 0), &MATRIX(B, row, 0), (A)->columns); \
+        }                                                                                   \
+    }                                                                                       \
+    vector_values_check((A)->vector);
+
+#define MATRIX_SCALAR_OPERATION(A, scalar, operation)                                       \
+    if(MATRIX_PACKED(A)) {                                                                  \
+        Vector.vs.operation((A)->vector, scalar);                                           \
+    } else {                                                                                \
+        for(size_t row = 0; row < (A)->rows; row++) {                                       \
+            simd_scalar_##operation(&MATRIX(A, row, 0), &MATRIX(A, row, 0), scalar, (A)->columns); \
+        }                                                                                   \
+    }                                                                                       \
+    vector_values_check((A)->vector);
 
 /* Life Cycle */
+// Header is taken from active arena like its vector
 static
 matrix *
-matrix_create(size_t rows, size_t columns) {
-    check(rows > 0 && columns > 0, "Wrong matrix size");
-    matrix *instance = malloc(sizeof(matrix));
+matrix_allocate(size_t rows, size_t columns) {
+    memory_arena *arena = Arena.current();
+    matrix *instance = arena
+                     ? Arena.alloc(arena, sizeof(matrix))
+                     : malloc(sizeof(matrix));
     check_memory(instance);
+
     instance->type = MATRIX_TYPE;
     instance->rows = rows;
     instance->columns = columns;
+    instance->stride = columns;
+    instance->vector = NULL;
+    instance->arena = arena;
+
+    return instance;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+matrix_create(size_t rows, size_t columns) {
+    check(rows > 0 && columns > 0, "Wrong matrix size");
+    matrix *instance = matrix_allocate(rows, columns);
+    check_memory(instance);
     instance->vector = Vector.create(rows * columns);
     
     return instance;
@@ -133,10 +218,21 @@ static
 matrix *
 matrix_copy(matrix *original) {
     matrix_check(original);
-    matrix *instance = malloc(sizeof(matrix));
-    instance->type = MATRIX_TYPE;
-    instance->rows = original->rows;
-    instance->columns = original->columns;
+
+    if(MATRIX_PACKED(original) == false) {
+        // Copy of block is packed
+        matrix *instance = matrix_create(original->rows, original->columns);
+        check_memory(instance);
+
+        for(size_t row = 0; row < original->rows; row++) {
+            memcpy(&MATRIX(instance, row, 0), &MATRIX(original, row, 0), original->columns * sizeof(float));
+        }
+
+        return instance;
+    }
+
+    matrix *instance = matrix_allocate(original->rows, original->columns);
+    check_memory(instance);
     instance->vector = Vector.copy(original->vector);
     
     return instance;
@@ -150,8 +246,10 @@ matrix *
 matrix_reshape(matrix *instance, size_t rows, size_t columns) {
     matrix_check(instance);
     check(rows > 0 && columns > 0, "Invalid matrix shape");
+    check(MATRIX_PACKED(instance), "Matrix block can't be reshaped");
     instance->rows = rows;
     instance->columns = columns;
+    instance->stride = columns;
     Vector.reshape(instance->vector, rows * columns);
     
     return instance;
@@ -160,12 +258,29 @@ error:
     return NULL;
 }
 
+static
+matrix *
+matrix_view(float *values, size_t rows, size_t columns) {
+    check(rows > 0 && columns > 0, "Invalid matrix shape");
+    matrix *instance = matrix_allocate(rows, columns);
+    check_memory(instance);
+    instance->vector = Vector.view(values, rows * columns);
+    
+    return instance;
+
+error:
+    return NULL;
+}
+
 static
 void
 matrix_delete(matrix *instance) {
     matrix_check(instance);
     Vector.delete(instance->vector);
-    free(instance);
+
+    if(instance->arena == NULL) {
+        free(instance);
+    }
 
 error:
     return;
@@ -177,7 +292,14 @@ static
 matrix *
 matrix_seed(matrix *instance, float default_value) {
     matrix_check(instance);
-    Vector.seed(instance->vector, default_value);
+
+    if(MATRIX_PACKED(instance)) {
+        Vector.seed(instance->vector, default_value);
+    } else {
+        matrix_foreach(instance) {
+            MATRIX(instance, row, column) = default_value ? default_value : random_range(-1, 1);
+        }
+    }
     
     return instance;
 error:
@@ -217,11 +339,8 @@ matrix_create_from_list(size_t rows, size_t columns, float *values) {
     check(rows > 0 && columns > 0, "Invalid matrix shape");
     check_memory(values);
     
-    matrix *instance = malloc(sizeof(matrix));
-    instance->type = MATRIX_TYPE;
-    
-    instance->rows = rows;
-    instance->columns = columns;
+    matrix *instance = matrix_allocate(rows, columns);
+    check_memory(instance);
     instance->vector = Vector.from.floats(rows * columns, values);
     
     return instance;
@@ -281,6 +400,45 @@ error:
     return NULL;
 }
 
+// Vectors are columns, so gathering goes by tiles of rows and columns
+static
+matrix *
+matrix_from_columns(vector **columns, size_t count) {
+    check_memory(columns);
+    check(count > 0, "Invalid matrix shape");
+    vector_check(columns[0]);
+
+    size_t rows = columns[0]->size;
+    for(size_t column = 0; column < count; column++) {
+        vector_check(columns[column]);
+        check(columns[column]->size == rows, "Column %zd has %zd values instead of %zd", column, columns[column]->size, rows);
+    }
+
+    matrix *joined = matrix_create(rows, count);
+    check_memory(joined);
+
+    for(size_t row_tile = 0; row_tile < rows; row_tile += SIMD_TILE) {
+        size_t row_end = row_tile + SIMD_TILE < rows ? row_tile + SIMD_TILE : rows;
+
+        for(size_t column_tile = 0; column_tile < count; column_tile += SIMD_TILE) {
+            size_t column_end = column_tile + SIMD_TILE < count ? column_tile + SIMD_TILE : count;
+
+            for(size_t column = column_tile; column < column_end; column++) {
+                const float *values = columns[column]->values;
+
+                for(size_t row = row_tile; row < row_end; row++) {
+                    MATRIX(joined, row, column) = values[row];
+                }
+            }
+        }
+    }
+
+    return joined;
+
+error:
+    return NULL;
+}
+
 static
 matrix *
 matrix_from_csv(csv *file, char *fields[]) {
@@ -299,7 +457,7 @@ matrix_from_csv(csv *file, char *fields[]) {
         index++;
     }
     
-    matrix *data = matrix_transpose(matrix_from_vectors(values, index, file->rows));
+    matrix *data = matrix_from_columns(values, index);
     
     // Garbage Control
     index = 0;
@@ -334,76 +492,129 @@ error:
     return NULL;
 }
 
+/* Slices */
+static
+vector *
+matrix_slice_row(matrix *A, size_t row) {
+    matrix_check(A);
+    check(row < A->rows, "Row %zd is out of %zdx%zd matrix", row, A->rows, A->columns);
+
+    return Vector.view(&MATRIX(A, row, 0), A->columns);
+
+error:
+    return NULL;
+}
+
+static
+vector *
+matrix_slice_column(matrix *A, size_t column) {
+    matrix_check(A);
+    check(column < A->columns, "Column %zd is out of %zdx%zd matrix", column, A->rows, A->columns);
+
+    return Vector.strided(&MATRIX(A, 0, column), A->rows, A->stride);
+
+error:
+    return NULL;
+}
+
+static
+vector *
+matrix_slice_diagonal(matrix *A) {
+    matrix_check(A);
+
+    return Vector.strided(A->vector->values, A->rows < A->columns ? A->rows : A->columns, A->stride + 1);
+
+error:
+    return NULL;
+}
+
+// Block keeps stride of A, its vector spans from the first value to the last one
+static
+matrix *
+matrix_slice_block(matrix *A, size_t row, size_t column, size_t rows, size_t columns) {
+    matrix_check(A);
+    check(rows > 0 && columns > 0 && row + rows <= A->rows && column + columns <= A->columns,
+          "Block %zdx%zd at %zdx%zd is out of %zdx%zd matrix", rows, columns, row, column, A->rows, A->columns);
+
+    matrix *block = matrix_allocate(rows, columns);
+    check_memory(block);
+
+    block->stride = A->stride;
+    block->vector = Vector.view(&MATRIX(A, row, column), (rows - 1) * A->stride + columns);
+
+    return block;
+
+error:
+    return NULL;
+}
+
 
 /* Transormation */
+// Square matrix is transposed in place by pairs of tiles across diagonal,
+// other shapes are written into new matrix and instance is deleted
 static
 matrix *
 matrix_transpose(matrix *instance) {
     matrix_check(instance);
-    
-    size_t instance_rows = instance->rows;
-    size_t transposed_rows = instance->columns;
-    
-    matrix *transposed = matrix_create(transposed_rows, instance_rows);
-    
-    size_t rows = transposed_rows;
-    
-    while(rows--) {
-        size_t columns = transposed->columns;
-        while(columns--) {
-            if(instance_rows == transposed_rows) {
-                if(columns > rows) {
-                    MATRIX(instance, rows, columns) += MATRIX(instance, columns, rows);
-                    MATRIX(instance, columns, rows) = MATRIX(instance, rows, columns) - MATRIX(instance, columns, rows);
-                    MATRIX(instance, rows, columns) -= MATRIX(instance, columns, rows);
-                } else {
-                    columns = 0;
-                }
-            } else {
-                MATRIX(transposed, rows, columns) = MATRIX(instance, columns, rows);
+
+    if(instance->rows != instance->columns || MATRIX_PACKED(instance) == false) {
+        matrix *transposed = matrix_create(instance->columns, instance->rows);
+        check_memory(transposed);
+
+        matrix_transposed(instance, transposed);
+        matrix_delete(instance);
+
+        return transposed;
+    }
+
+    float tile[SIMD_TILE * SIMD_TILE];
+    size_t size = instance->rows;
+    float *values = instance->vector->values;
+
+    for(size_t row = 0; row < size; row += SIMD_TILE) {
+        size_t height = row + SIMD_TILE < size ? SIMD_TILE : size - row;
+
+        for(size_t column = row; column < size; column += SIMD_TILE) {
+            size_t width = column + SIMD_TILE < size ? SIMD_TILE : size - column;
+            float *upper = values + row * size + column;
+            float *lower = values + column * size + row;
+
+            // Upper tile is kept transposed, lower one is moved up over it
+            simd_transpose(tile, height, upper, size, height, width);
+            if(column != row) {
+                simd_transpose(upper, size, lower, size, width, height);
+            }
+
+            for(size_t line = 0; line < width; line++) {
+                memcpy(lower + line * size, tile + line * height, height * sizeof(float));
             }
         }
     }
-    
-    if(instance_rows != transposed_rows) {
-        matrix_delete(instance);
-        instance = transposed;
-        
-    } else {
-        matrix_delete(transposed);
-    }
-    
-    matrix_check(instance);
-    
+
     return instance;
 
 error:
     return NULL;
 }
 
-vector *
-vector_transformation_by_matrix(matrix *A, vector *x) {
+// Into is columns x rows of A, nothing is allocated
+static
+matrix *
+matrix_transposed(matrix *A, matrix *into) {
     matrix_check(A);
-    vector_check(x);
-    
-    vector *transormed_vector = Vector.create(A->rows);
-    
-    for(size_t column = 0; column < A->columns; column++) {
-        vector *column_vector = matrix_column_vector(A, column);
-        Vector.add(transormed_vector,
-                   Vector.num.mul(column_vector,
-                                  VECTOR(x, column)));
-        
-        Vector.delete(column_vector);
-    }
-    
-    return transormed_vector;
+    matrix_check(into);
+    check(into->rows == A->columns && into->columns == A->rows,
+          "Matrix %zdx%zd can't hold transposed %zdx%zd", into->rows, into->columns, A->rows, A->columns);
+    check(into->vector->values != A->vector->values, "Matrix can't be transposed into itself");
+
+    simd_transpose(into->vector->values, into->stride, A->vector->values, A->stride, A->rows, A->columns);
+
+    return into;
 
 error:
     return NULL;
 }
 
-
 /* Operations */
 
 // Multiplication
@@ -415,18 +626,57 @@ matrix_multiplication_cast(matrix *A, void *some_b) {
     }
     
     if(IS(some_b, VECTOR_TYPE)) {
-        vector *v_result = vector_transformation_by_matrix(A,
-                                                           (vector*)some_b);
-        matrix *m_result = Matrix.from(v_result, v_result->size, 1);
-        Vector.delete(v_result);
-        Matrix.delete(A);
-        
-        A = m_result;
-        return A;
+        return matrix_vector_multiplication(A, (vector*)some_b);
+    }
+    
+    return matrix_scalar_multiplication(A, SCALAR_CAST(some_b));
+}
+
+// Column of transformed vector, replaces A
+static
+matrix *
+matrix_vector_multiplication(matrix *A, vector *x) {
+    matrix_check(A);
+    matrix *m_result = matrix_create(A->rows, 1);
+    check_memory(m_result);
+
+    if(matrix_gemv(1, A, x, 0, m_result->vector) == NULL) {
+        matrix_delete(m_result);
+        goto error;
     }
+    Matrix.delete(A);
+    
+    return m_result;
     
-    return matrix_scalar_multiplication(A,
-                                        ((number*)some_b)->value);
+error:
+    return NULL;
+}
+
+// Y = alpha * A * x + beta * y, result is written into y
+static
+vector *
+matrix_gemv(float alpha, matrix *A, vector *x, float beta, vector *y) {
+    matrix_check(A);
+    vector_check(x);
+    vector_check(y);
+    check(A->columns == x->size && A->rows == y->size,
+          "Matrix sizes doesn't match %zdx%zd * %zd = %zd", A->rows, A->columns, x->size, y->size);
+    check(VECTOR_PACKED(y), "Result of product can't be strided");
+
+    vector *x_packed = VECTOR_PACKED(x) ? x : Vector.copy(x);
+    check_memory(x_packed);
+
+    gemv(A->rows, A->columns, alpha, A->vector->values, A->stride, x_packed->values, beta, y->values);
+
+    if(x_packed != x) {
+        Vector.delete(x_packed);
+    }
+    vector_values_check(y);
+
+    return y;
+
+error:
+    return NULL;
 }
 
 static
@@ -434,18 +684,11 @@ matrix *
 matrix_multiplication(matrix *A, matrix *B) {
     matrix_check(A);
     matrix_check(B);
+    check(A->columns == B->rows, "Matrix sizes doesn't match");
     matrix *multiplicated = matrix_create(A->rows, B->columns);
-    check(A->rows == B->columns, "Matrix sizes doesn't match");
+    check_memory(multiplicated);
 
-    matrix_foreach(multiplicated) {
-        size_t index = A->columns > 1
-        ? B->rows
-        : A->columns;
-        
-        while(index--) {
-            MATRIX(multiplicated, row, column) += MATRIX(A, row, index) * MATRIX(B, index, column);
-        }
-    }
+    matrix_gemm(1, A, B, 0, multiplicated);
     
     Matrix.delete(A);
     A = multiplicated;
@@ -456,11 +699,81 @@ error:
     return NULL;
 }
 
+// In place products
+static
+matrix *
+matrix_gemm(float alpha, matrix *A, matrix *B, float beta, matrix *C) {
+    matrix_check(A);
+    matrix_check(B);
+    matrix_check(C);
+    check(A->columns == B->rows && C->rows == A->rows && C->columns == B->columns,
+          "Matrix sizes doesn't match %zdx%zd * %zdx%zd = %zdx%zd", A->rows, A->columns, B->rows, B->columns, C->rows, C->columns);
+
+    gemm(C->rows, C->columns, A->columns,
+         alpha,
+         A->vector->values, A->stride, 1,
+         B->vector->values, B->stride, 1,
+         beta,
+         C->vector->values, C->stride);
+    vector_values_check(C->vector);
+
+    return C;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+matrix_gemm_transposed_b(float alpha, matrix *A, matrix *B, float beta, matrix *C) {
+    matrix_check(A);
+    matrix_check(B);
+    matrix_check(C);
+    check(A->columns == B->columns && C->rows == A->rows && C->columns == B->rows,
+          "Matrix sizes doesn't match %zdx%zd * (%zdx%zd)T = %zdx%zd", A->rows, A->columns, B->rows, B->columns, C->rows, C->columns);
+
+    gemm(C->rows, C->columns, A->columns,
+         alpha,
+         A->vector->values, A->stride, 1,
+         B->vector->values, 1, B->stride,
+         beta,
+         C->vector->values, C->stride);
+    vector_values_check(C->vector);
+
+    return C;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+matrix_gemm_transposed_a(float alpha, matrix *A, matrix *B, float beta, matrix *C) {
+    matrix_check(A);
+    matrix_check(B);
+    matrix_check(C);
+    check(A->rows == B->rows && C->rows == A->columns && C->columns == B->columns,
+          "Matrix sizes doesn't match (%zdx%zd)T * %zdx%zd = %zdx%zd", A->rows, A->columns, B->rows, B->columns, C->rows, C->columns);
+
+    gemm(C->rows, C->columns, A->rows,
+         alpha,
+         A->vector->values, 1, A->stride,
+         B->vector->values, B->stride, 1,
+         beta,
+         C->vector->values, C->stride);
+    vector_values_check(C->vector);
+
+    return C;
+
+error:
+    return NULL;
+}
+
 static
 matrix *
 matrix_scalar_multiplication(matrix *A, float scalar) {
     matrix_check(A);
-    Vector.mul(A->vector, &scalar);
+    MATRIX_SCALAR_OPERATION(A, scalar, mul);
     
     return A;
     
@@ -480,8 +793,7 @@ matrix_division_cast(matrix *A, void *some_b) {
         return A;
     }
     
-    return matrix_scalar_division(A,
-                                  ((number*)some_b)->value);
+    return matrix_scalar_division(A, SCALAR_CAST(some_b));
 }
 
 static
@@ -489,7 +801,7 @@ matrix *
 matrix_division(matrix *A, matrix *B) {
     matrix_check(A);
     matrix_check(B);
-    MATRIX_OPERATION(A, B, /);
+    MATRIX_OPERATION(A, B, div);
     
     return A;
     
@@ -501,7 +813,7 @@ static
 matrix *
 matrix_scalar_division(matrix *A, float scalar) {
     matrix_check(A);
-    Vector.div(A->vector, &scalar);
+    MATRIX_SCALAR_OPERATION(A, scalar, div);
     
     return A;
     
@@ -521,8 +833,7 @@ matrix_addition_cast(matrix *A, void *some_b) {
         return A;
     }
     
-    return matrix_scalar_addition(A,
-                                  ((number*)some_b)->value);
+    return matrix_scalar_addition(A, SCALAR_CAST(some_b));
 }
 
 static
@@ -530,7 +841,7 @@ matrix *
 matrix_addition(matrix *A, matrix *B) {
     matrix_check(A);
     matrix_check(B);
-    MATRIX_OPERATION(A, B, +);
+    MATRIX_OPERATION(A, B, add);
     
     return A;
     
@@ -542,7 +853,7 @@ static
 matrix *
 matrix_scalar_addition(matrix *A, float scalar) {
     matrix_check(A);
-    Vector.num.add(A->vector, scalar);
+    MATRIX_SCALAR_OPERATION(A, scalar, add);
     
     return A;
     
@@ -562,8 +873,7 @@ matrix_substraction_cast(matrix *A, void *some_b) {
         return A;
     }
     
-    return matrix_scalar_substraction(A,
-                                      ((number*)some_b)->value);
+    return matrix_scalar_substraction(A, SCALAR_CAST(some_b));
 }
 
 static
@@ -571,7 +881,7 @@ matrix *
 matrix_substraction(matrix *A, matrix *B) {
     matrix_check(A);
     matrix_check(B);
-    MATRIX_OPERATION(A, B, -);
+    MATRIX_OPERATION(A, B, sub);
     
     return A;
     
@@ -583,7 +893,7 @@ static
 matrix *
 matrix_scalar_substraction(matrix *A, float scalar) {
     matrix_check(A);
-    Vector.sub(A->vector, &scalar);
+    MATRIX_SCALAR_OPERATION(A, scalar, sub);
     
     return A;
     
@@ -611,6 +921,15 @@ static
 float
 matrix_sum(matrix *A) {
     matrix_check(A);
+
+    if(MATRIX_PACKED(A) == false) {
+        float sum = 0;
+        for(size_t row = 0; row < A->rows; row++) {
+            sum += simd_sum(&MATRIX(A, row, 0), A->columns);
+        }
+
+        return sum;
+    }
     
     return Vector.sum.all(A->vector);
     
@@ -642,7 +961,7 @@ matrix_frobenius_norm(matrix *A) {
     matrix_check(A);
     
     matrix *product = matrix_copy(A);
-    MATRIX_OPERATION(product, product, *);
+    MATRIX_OPERATION(product, product, mul);
     
     float sum = matrix_sum(product);
     
@@ -659,14 +978,12 @@ float
 matrix_frobenius_norm_by_trace(matrix *A) {
     matrix_check(A);
     
-    matrix *AT = matrix_copy(A);
-    matrix_transpose(AT);
-    
-    matrix *A_AT = matrix_multiplication(A, AT);
+    matrix *A_AT = matrix_create(A->rows, A->rows);
+    check_memory(A_AT);
+    matrix_gemm_transposed_b(1, A, A, 0, A_AT);
     
     float frobenius = sqrt(matrix_trace(A_AT));
     
-    matrix_delete(AT);
     matrix_delete(A_AT);
     
     return frobenius;
@@ -681,6 +998,20 @@ enum bool
 matrix_is_equal(matrix *A, matrix *B) {
     matrix_check(A);
     matrix_check(B);
+
+    if(A->rows != B->rows || A->columns != B->columns) {
+        return false;
+    }
+
+    if(MATRIX_PACKED(A) == false || MATRIX_PACKED(B) == false) {
+        for(size_t row = 0; row < A->rows; row++) {
+            if(memcmp(&MATRIX(A, row, 0), &MATRIX(B, row, 0), A->columns * sizeof(float)) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
     
     return Vector.rel.is_equal(A->vector, B->vector);
     
@@ -696,7 +1027,7 @@ matrix_print(matrix *instance) {
     
     size_t previous_row = 0;
     
-    printf("\tMatrix: %dx%d\n\t\t[[\t", (int)((int)instance->vector->size / (int)instance->columns), (int)instance->columns);
+    printf("\tMatrix: %dx%d\n\t\t[[\t", (int)instance->rows, (int)instance->columns);
     
     matrix_foreach(instance) {
         enum bool is_head_or_tail = row < 5 || row > instance->rows - 5;
@@ -11,17 +11,20 @@
 
 #include <stdio.h>
 #include "vector.h"
+#include "gemm.h"
 #include "../data/csv.h"
 
-#define MATRIX(matrix, row, column) *((matrix)->vector->values + row * ((matrix)->columns) + column)
-#define MATRIX_TYPE "t_Mat"
+#define MATRIX(matrix, row, column) *((matrix)->vector->values + (row) * (matrix)->stride + (column))
+// Rows follow each other, so values are one vector
+#define MATRIX_PACKED(matrix) ((matrix)->stride == (matrix)->columns)
 
 //#define MATRIX_IS_MATRIX(matrix) ((matrix)->type == MATRIX_TYPE && (matrix)->columns && (matrix)->rows && (matrix)->vector->size && (matrix)->columns * (matrix)->rows == (matrix)->vector->size)
 
 #define matrix_check_print(matrix, message, ...) { check_memory(matrix); \
-check(strcmp((matrix)->type, MATRIX_TYPE) == 0, "Wrong matrix type. " message, ##__VA_ARGS__); \
-check((matrix)->columns && (matrix)->rows, "Matrix size not set. " message, ##__VA_ARGS__); \
-check((matrix)->vector->size && (matrix)->columns * (matrix)->rows == (matrix)->vector->size, \
+check_valid((matrix)->type == MATRIX_TYPE, "Wrong matrix type. " message, ##__VA_ARGS__); \
+check_valid((matrix)->columns && (matrix)->rows, "Matrix size not set. " message, ##__VA_ARGS__); \
+check_valid((matrix)->vector->size && (matrix)->stride >= (matrix)->columns \
+      && ((matrix)->rows - 1) * (matrix)->stride + (matrix)->columns == (matrix)->vector->size, \
     "Matrix value broken %zdx%zd = %d. " message, (matrix)->rows, (matrix)->columns, ((matrix)->vector && (matrix)->vector->size) || 0, ##__VA_ARGS__); \
 vector_check_print((matrix)->vector, "Matrix values vector broken. " message, ##__VA_ARGS__); \
 }
@@ -34,26 +37,29 @@ vector_check_print((matrix)->vector, "Matrix values vector broken. " message, ##
 
 typedef struct
 {
-    char   *type;
+    enum type_tag type;
     
     size_t rows;
     size_t columns;
+    // Distance between rows, wider than columns for block of other matrix.
+    // Vector spans from the first value to the last one
+    size_t stride;
     vector *vector;
-} matrix;
 
-struct matrix_library_operation {
-    matrix *        (*mat)(matrix *A, matrix *B);
-    matrix *        (*vec)(matrix *A, vector *v);
-    matrix *        (*num)(matrix *A, float scalar);
-};
+    // Owner of header, NULL when it's on heap
+    memory_arena *arena;
+} matrix;
 
 struct matrix_library {
     matrix *        (*create)(size_t rows, size_t columns);
     matrix *        (*from)(void *data, size_t rows, size_t columns);
     matrix *        (*csv)(csv *file, char **fields);
+    // Each vector is a column, all of the same size
+    matrix *        (*columns)(vector **columns, size_t count);
     matrix *        (*copy)(matrix *original);
     matrix *        (*seed)(matrix *A, float default_value);
     matrix *        (*reshape)(matrix *instance, size_t rows, size_t columns);
+    matrix *        (*view)(float *values, size_t rows, size_t columns);
     void            (*delete)(matrix *A);
     
     void            (*print)(matrix *A);
@@ -62,6 +68,14 @@ struct matrix_library {
     matrix *        (*diagonal)(vector *v);
     
     vector *        (*column)(matrix *A, size_t column);
+
+    // Views into A without copying, delete leaves values alone
+    struct {
+        vector *    (*row)(matrix *A, size_t row);
+        vector *    (*column)(matrix *A, size_t column);
+        vector *    (*diagonal)(matrix *A);
+        matrix *    (*block)(matrix *A, size_t row, size_t column, size_t rows, size_t columns);
+    } slice;
     
     struct {
         float       (*sum)(matrix *A);
@@ -73,12 +87,45 @@ struct matrix_library {
         enum bool   (*is_equal)(matrix *A, matrix *B);
     } rel;
     
+    // Operand type is looked up by its tag
     matrix *        (*add)(matrix *A, void *term);
     matrix *        (*sub)(matrix *A, void *subtrahend);
     matrix *        (*mul)(matrix *A, void *factor);
     matrix *        (*div)(matrix *A, void *divider);
     
+    // Typed operations for hot paths, mul is product which replaces A
+    struct {
+        matrix *    (*add)(matrix *A, matrix *B);
+        matrix *    (*sub)(matrix *A, matrix *B);
+        matrix *    (*mul)(matrix *A, matrix *B);
+        matrix *    (*div)(matrix *A, matrix *B);
+    } mm;
+    
+    struct {
+        matrix *    (*mul)(matrix *A, vector *x);
+        // Y = alpha * A * x + beta * y, result is written into y
+        vector *    (*gemv)(float alpha, matrix *A, vector *x, float beta, vector *y);
+    } mv;
+    
+    struct {
+        matrix *    (*add)(matrix *A, float term);
+        matrix *    (*sub)(matrix *A, float subtrahend);
+        matrix *    (*mul)(matrix *A, float factor);
+        matrix *    (*div)(matrix *A, float divider);
+    } ms;
+    
+    // C = alpha * A * B + beta * C, result is written into C
+    struct {
+        matrix *    (*ab)(float alpha, matrix *A, matrix *B, float beta, matrix *C);
+        matrix *    (*abt)(float alpha, matrix *A, matrix *B, float beta, matrix *C);
+        matrix *    (*atb)(float alpha, matrix *A, matrix *B, float beta, matrix *C);
+    } gemm;
+    
+    // Replaces A, square A is transposed in place
     matrix *        (*transpose)(matrix *A);
+    // Writes transposed A into existing matrix, A stays. Products with
+    // transposed operand don't need it, gemm reads them by strides
+    matrix *        (*transposed)(matrix *A, matrix *into);
     matrix *        (*map)(matrix *A, float operation(float));
 };
 
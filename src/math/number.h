@@ -12,8 +12,6 @@
 #include <math.h>
 #include "../util/macros.h"
 
-#define NUMBER_TYPE "t_Num"
-
 #define PI 3.14159265358979323846
 
 struct number_library {
@@ -185,7 +185,7 @@ __probability_space_count_events(P_space *space) {
     matrix *samples = space->samples;
     
     for(size_t index = 0; index < samples->columns; index++) {
-        vector *column_data = Matrix.column(samples, index);
+        vector *column_data = Matrix.slice.column(samples, index);
         space->events[index] = Vector.prop.uniq(column_data);
         space->occurs[index] = Vector.create(space->events[index]->size);
         
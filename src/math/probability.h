@@ -15,12 +15,11 @@
 #include "../util/sort.h"
 #include "../data/csv.h"
 
-#define PROBABILITY_TYPE "t_Prob"
 
 
 typedef struct
 {
-    char *type;
+    enum type_tag type;
     
     char **fields;
     matrix *samples;
@@ -0,0 +1,519 @@
+//
+//  simd.c
+//  math
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+//  Each instruction set has the same table of kernels, table is chosen
+//  once by CPU features. Tails shorter than register are done by scalar
+//  code, so results of element-wise kernels are exactly the same on
+//  every table. Reductions keep four accumulators inside a block and
+//  add blocks pairwise. Exp is a polynomial approximation, tables
+//  may round its last bit differently, but tail of exp is padded to
+//  register, so on one table it depends only on the value.
+//
+
+#include <math.h>
+#include <pthread.h>
+#include "simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+typedef void  (*simd_unary)(float *result, const float *v, size_t size);
+typedef void  (*simd_binary)(float *result, const float *v, const float *w, size_t size);
+typedef void  (*simd_scalar)(float *result, const float *v, float scalar, size_t size);
+typedef float (*simd_reduce)(const float *v, const float *w, size_t size);
+typedef void  (*simd_transposition)(float *result, size_t result_stride, const float *v, size_t v_stride,
+                                    size_t rows, size_t columns);
+
+typedef struct {
+    const char      *name;
+
+    simd_binary     add;
+    simd_binary     sub;
+    simd_binary     mul;
+    simd_binary     div;
+    simd_binary     max;
+    simd_unary      exp;
+
+    simd_scalar     scalar_add;
+    simd_scalar     scalar_sub;
+    simd_scalar     scalar_mul;
+    simd_scalar     scalar_div;
+
+    // W is ignored by sums
+    simd_reduce     sum;
+    simd_reduce     abs_sum;
+    simd_reduce     dot;
+
+    simd_transposition transpose;
+} simd_kernel;
+
+static const simd_kernel *  simd_kernel_select(void);
+static void                 simd_kernel_init(void);
+static float                simd_pairwise(simd_reduce reduce, const float *v, const float *w, size_t size);
+
+static const simd_kernel *kernel = NULL;
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+#define SIMD_KERNEL (pthread_once(&kernel_once, simd_kernel_init), kernel)
+
+
+/* Kernel generators */
+#define SIMD_BINARY(name, attribute, width, load, store, operation, expression)          \
+    attribute                                                                           \
+    static void name(float *result, const float *v, const float *w, size_t size) {      \
+        size_t index = 0;                                                               \
+        for(; index + width <= size; index += width) {                                  \
+            store(result + index, operation(load(v + index), load(w + index)));         \
+        }                                                                               \
+        for(; index < size; index++) {                                                  \
+            result[index] = v[index] expression w[index];                               \
+        }                                                                               \
+    }
+
+// Tail of function kernels is done by scalar function of the same math
+#define SIMD_FUNCTION(name, attribute, width, load, store, operation, function)          \
+    attribute                                                                           \
+    static void name(float *result, const float *v, const float *w, size_t size) {      \
+        size_t index = 0;                                                               \
+        for(; index + width <= size; index += width) {                                  \
+            store(result + index, operation(load(v + index), load(w + index)));         \
+        }                                                                               \
+        for(; index < size; index++) {                                                  \
+            result[index] = function(v[index], w[index]);                               \
+        }                                                                               \
+    }
+
+// Tail is padded to register, so value doesn't depend on its position
+#define SIMD_UNARY(name, attribute, width, load, store, operation)                       \
+    attribute                                                                           \
+    static void name(float *result, const float *v, size_t size) {                      \
+        size_t index = 0;                                                               \
+        for(; index + width <= size; index += width) {                                  \
+            store(result + index, operation(load(v + index)));                          \
+        }                                                                               \
+        if(index < size) {                                                              \
+            float tail[width];                                                          \
+            memset(tail, 0, sizeof(tail));                                              \
+            memcpy(tail, v + index, (size - index) * sizeof(float));                    \
+            store(tail, operation(load(tail)));                                         \
+            memcpy(result + index, tail, (size - index) * sizeof(float));               \
+        }                                                                               \
+    }
+
+#define SIMD_SCALAR(name, attribute, width, type, load, store, broadcast, operation, expression) \
+    attribute                                                                           \
+    static void name(float *result, const float *v, float scalar, size_t size) {        \
+        type scalar_vector = broadcast(scalar);                                         \
+        size_t index = 0;                                                               \
+        for(; index + width <= size; index += width) {                                  \
+            store(result + index, operation(load(v + index), scalar_vector));           \
+        }                                                                               \
+        for(; index < size; index++) {                                                  \
+            result[index] = v[index] expression scalar;                                 \
+        }                                                                               \
+    }
+
+// Accumulate(accumulator, index) adds width values starting from index
+#define SIMD_REDUCE(name, attribute, width, type, zero, add, horizontal, accumulate, element) \
+    attribute                                                                           \
+    static float name(const float *v, const float *w, size_t size) {                    \
+        type a0 = zero(), a1 = zero(), a2 = zero(), a3 = zero();                        \
+        size_t index = 0;                                                               \
+        (void)w;                                                                        \
+        for(; index + 4 * width <= size; index += 4 * width) {                          \
+            accumulate(a0, index);                                                      \
+            accumulate(a1, index + width);                                              \
+            accumulate(a2, index + 2 * width);                                          \
+            accumulate(a3, index + 3 * width);                                          \
+        }                                                                               \
+        for(; index + width <= size; index += width) {                                  \
+            accumulate(a0, index);                                                      \
+        }                                                                               \
+        float result = horizontal(add(add(a0, a1), add(a2, a3)));                       \
+        for(; index < size; index++) {                                                  \
+            result += element(index);                                                   \
+        }                                                                               \
+        return result;                                                                  \
+    }
+
+// Tiles are cut into width x width blocks, remainder of tile is copied by elements
+#define SIMD_TRANSPOSE(name, attribute, width, block)                                   \
+attribute static void                                                                   \
+name(float *result, size_t result_stride, const float *v, size_t v_stride,             \
+     size_t rows, size_t columns) {                                                     \
+    for(size_t row_tile = 0; row_tile < rows; row_tile += SIMD_TILE) {                 \
+        size_t row_end = row_tile + SIMD_TILE < rows ? row_tile + SIMD_TILE : rows;    \
+        for(size_t column_tile = 0; column_tile < columns; column_tile += SIMD_TILE) { \
+            size_t column_end = column_tile + SIMD_TILE < columns ? column_tile + SIMD_TILE : columns; \
+            size_t row = row_tile;                                                      \
+            for(; row + width <= row_end; row += width) {                               \
+                size_t column = column_tile;                                            \
+                for(; column + width <= column_end; column += width) {                  \
+                    block(result + column * result_stride + row, result_stride,         \
+                          v + row * v_stride + column, v_stride);                       \
+                }                                                                       \
+                for(size_t line = row; line < row + width; line++) {                    \
+                    for(size_t index = column; index < column_end; index++) {           \
+                        result[index * result_stride + line] = v[line * v_stride + index]; \
+                    }                                                                   \
+                }                                                                       \
+            }                                                                           \
+            for(; row < row_end; row++) {                                               \
+                for(size_t index = column_tile; index < column_end; index++) {          \
+                    result[index * result_stride + row] = v[row * v_stride + index];    \
+                }                                                                       \
+            }                                                                           \
+        }                                                                               \
+    }                                                                                   \
+}
+
+#define SIMD_OPERATIONS(isa, attribute, width, type, load, store, broadcast, add, sub, mul, div) \
+    SIMD_BINARY(add_##isa, attribute, width, load, store, add, +)                      \
+    SIMD_BINARY(sub_##isa, attribute, width, load, store, sub, -)                      \
+    SIMD_BINARY(mul_##isa, attribute, width, load, store, mul, *)                      \
+    SIMD_BINARY(div_##isa, attribute, width, load, store, div, /)                      \
+    SIMD_FUNCTION(max_##isa, attribute, width, load, store, isa##_max, fmaxf)            \
+    SIMD_UNARY(exp_##isa, attribute, width, load, store, isa##_exp)                      \
+    SIMD_SCALAR(scalar_add_##isa, attribute, width, type, load, store, broadcast, add, +) \
+    SIMD_SCALAR(scalar_sub_##isa, attribute, width, type, load, store, broadcast, sub, -) \
+    SIMD_SCALAR(scalar_mul_##isa, attribute, width, type, load, store, broadcast, mul, *) \
+    SIMD_SCALAR(scalar_div_##isa, attribute, width, type, load, store, broadcast, div, /)
+
+#define SIMD_TABLE(isa) {                                                               \
+    .name = #isa,                                                                       \
+    .add = add_##isa, .sub = sub_##isa, .mul = mul_##isa, .div = div_##isa,             \
+    .max = max_##isa, .exp = exp_##isa,                                                 \
+    .scalar_add = scalar_add_##isa, .scalar_sub = scalar_sub_##isa,                     \
+    .scalar_mul = scalar_mul_##isa, .scalar_div = scalar_div_##isa,                     \
+    .sum = sum_##isa, .abs_sum = abs_sum_##isa, .dot = dot_##isa,                       \
+    .transpose = transpose_##isa                                                        \
+}
+
+#define SUM_ELEMENT(index)      v[index]
+#define ABS_SUM_ELEMENT(index)  fabsf(v[index])
+#define DOT_ELEMENT(index)      v[index] * w[index]
+
+
+/* Exp */
+// Cephes expf: x = n ln2 + r, |r| <= ln2 / 2, exp(r) by polynomial and
+// 2^n by exponent bits. Relative error is about 2e-7 on the clamped range
+#define EXP_HIGH        88.3762626647949f
+#define EXP_LOW         -87.3365447504019f
+#define EXP_LOG2E       1.44269504088896341f
+#define EXP_LN2_HIGH    0.693359375f
+#define EXP_LN2_LOW     -2.12194440e-4f
+#define EXP_P0          1.9875691500E-4f
+#define EXP_P1          1.3981999507E-3f
+#define EXP_P2          8.3334519073E-3f
+#define EXP_P3          4.1665795894E-2f
+#define EXP_P4          1.6666665459E-1f
+#define EXP_P5          5.0000001201E-1f
+
+static inline float
+simd_exp_scalar(float x) {
+    x = fminf(fmaxf(x, EXP_LOW), EXP_HIGH);
+
+    float n = floorf(x * EXP_LOG2E + 0.5f);
+    x = x - n * EXP_LN2_HIGH - n * EXP_LN2_LOW;
+
+    float y = EXP_P0;
+    y = y * x + EXP_P1;
+    y = y * x + EXP_P2;
+    y = y * x + EXP_P3;
+    y = y * x + EXP_P4;
+    y = y * x + EXP_P5;
+    y = y * x * x + x + 1.f;
+
+    union { unsigned int bits; float value; } power = { .bits = (unsigned int)((int)n + 127) << 23 };
+
+    return y * power.value;
+}
+
+// Vector exp of one instruction set, operations are macros of the set
+#define SIMD_EXP_BODY(x, type, set1, add, sub, mul, min, max, floor, power)                \
+    x = min(max(x, set1(EXP_LOW)), set1(EXP_HIGH));                                       \
+    type n = floor(add(mul(x, set1(EXP_LOG2E)), set1(0.5f)));                             \
+    x = sub(sub(x, mul(n, set1(EXP_LN2_HIGH))), mul(n, set1(EXP_LN2_LOW)));               \
+    type y = set1(EXP_P0);                                                                \
+    y = add(mul(y, x), set1(EXP_P1));                                                     \
+    y = add(mul(y, x), set1(EXP_P2));                                                     \
+    y = add(mul(y, x), set1(EXP_P3));                                                     \
+    y = add(mul(y, x), set1(EXP_P4));                                                     \
+    y = add(mul(y, x), set1(EXP_P5));                                                     \
+    y = add(add(mul(mul(y, x), x), x), set1(1.f));                                        \
+    return mul(y, power(n));
+
+
+/* Scalar */
+#define SCALAR_IDENTITY(value)          (value)
+#define SCALAR_LOAD(pointer)            (*(pointer))
+#define SCALAR_STORE(pointer, value)    (*(pointer) = (value))
+#define SCALAR_ADD(a, b)                ((a) + (b))
+#define SCALAR_SUB(a, b)                ((a) - (b))
+#define SCALAR_MUL(a, b)                ((a) * (b))
+#define SCALAR_DIV(a, b)                ((a) / (b))
+#define SCALAR_ZERO()                   0.f
+#define SCALAR_SUM(accumulator, index)     accumulator += v[index]
+#define SCALAR_ABS_SUM(accumulator, index) accumulator += fabsf(v[index])
+#define SCALAR_DOT(accumulator, index)     accumulator += v[index] * w[index]
+
+#define scalar_max fmaxf
+#define scalar_transpose_block(result, result_stride, v, v_stride) (*(result) = *(v))
+#define scalar_exp simd_exp_scalar
+
+SIMD_OPERATIONS(scalar, , 1, float, SCALAR_LOAD, SCALAR_STORE, SCALAR_IDENTITY,
+                SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, SCALAR_DIV)
+SIMD_REDUCE(sum_scalar, , 1, float, SCALAR_ZERO, SCALAR_ADD, SCALAR_IDENTITY, SCALAR_SUM, SUM_ELEMENT)
+SIMD_REDUCE(abs_sum_scalar, , 1, float, SCALAR_ZERO, SCALAR_ADD, SCALAR_IDENTITY, SCALAR_ABS_SUM, ABS_SUM_ELEMENT)
+SIMD_REDUCE(dot_scalar, , 1, float, SCALAR_ZERO, SCALAR_ADD, SCALAR_IDENTITY, SCALAR_DOT, DOT_ELEMENT)
+SIMD_TRANSPOSE(transpose_scalar, , 1, scalar_transpose_block)
+
+static const simd_kernel simd_scalar_kernel = SIMD_TABLE(scalar);
+
+
+#ifdef SIMD_X86
+/* SSE */
+#define SSE __attribute__((target("sse2")))
+
+SSE static inline float
+sse_horizontal(__m128 x) {
+    __m128 high = _mm_movehl_ps(x, x);
+    x = _mm_add_ps(x, high);
+    x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 0x55));
+
+    return _mm_cvtss_f32(x);
+}
+
+// SSE2 has no floor, truncation is moved down for negative values
+SSE static inline __m128
+sse_floor(__m128 x) {
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.f)));
+}
+
+SSE static inline __m128
+sse_power(__m128 n) {
+    __m128i bits = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23);
+
+    return _mm_castsi128_ps(bits);
+}
+
+SSE static inline __m128
+sse_exp(__m128 x) {
+    SIMD_EXP_BODY(x, __m128, _mm_set1_ps, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_min_ps, _mm_max_ps, sse_floor, sse_power)
+}
+
+#define sse_max _mm_max_ps
+
+SSE static inline void
+sse_transpose_block(float *result, size_t result_stride, const float *v, size_t v_stride) {
+    __m128 row0 = _mm_loadu_ps(v);
+    __m128 row1 = _mm_loadu_ps(v + v_stride);
+    __m128 row2 = _mm_loadu_ps(v + 2 * v_stride);
+    __m128 row3 = _mm_loadu_ps(v + 3 * v_stride);
+
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+    _mm_storeu_ps(result, row0);
+    _mm_storeu_ps(result + result_stride, row1);
+    _mm_storeu_ps(result + 2 * result_stride, row2);
+    _mm_storeu_ps(result + 3 * result_stride, row3);
+}
+
+#define SSE_SUM(accumulator, index)     accumulator = _mm_add_ps(accumulator, _mm_loadu_ps(v + (index)))
+#define SSE_ABS_SUM(accumulator, index) accumulator = _mm_add_ps(accumulator, _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_loadu_ps(v + (index))))
+#define SSE_DOT(accumulator, index)     accumulator = _mm_add_ps(accumulator, _mm_mul_ps(_mm_loadu_ps(v + (index)), _mm_loadu_ps(w + (index))))
+
+SIMD_OPERATIONS(sse, SSE, 4, __m128, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps,
+                _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_div_ps)
+SIMD_REDUCE(sum_sse, SSE, 4, __m128, _mm_setzero_ps, _mm_add_ps, sse_horizontal, SSE_SUM, SUM_ELEMENT)
+SIMD_REDUCE(abs_sum_sse, SSE, 4, __m128, _mm_setzero_ps, _mm_add_ps, sse_horizontal, SSE_ABS_SUM, ABS_SUM_ELEMENT)
+SIMD_REDUCE(dot_sse, SSE, 4, __m128, _mm_setzero_ps, _mm_add_ps, sse_horizontal, SSE_DOT, DOT_ELEMENT)
+SIMD_TRANSPOSE(transpose_sse, SSE, 4, sse_transpose_block)
+
+static const simd_kernel simd_sse_kernel = SIMD_TABLE(sse);
+
+
+/* AVX2 */
+#define AVX2 __attribute__((target("avx2,fma")))
+
+AVX2 static inline float
+avx2_horizontal(__m256 x) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    __m128 high = _mm_movehl_ps(sum, sum);
+    sum = _mm_add_ps(sum, high);
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+
+    return _mm_cvtss_f32(sum);
+}
+
+AVX2 static inline __m256
+avx2_floor(__m256 x) {
+    return _mm256_floor_ps(x);
+}
+
+AVX2 static inline __m256
+avx2_power(__m256 n) {
+    __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127)), 23);
+
+    return _mm256_castsi256_ps(bits);
+}
+
+AVX2 static inline __m256
+avx2_exp(__m256 x) {
+    SIMD_EXP_BODY(x, __m256, _mm256_set1_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_min_ps, _mm256_max_ps, avx2_floor, avx2_power)
+}
+
+#define avx2_max _mm256_max_ps
+
+// Pairs of rows are interleaved, then quads, then halves of registers are swapped
+AVX2 static inline void
+avx2_transpose_block(float *result, size_t result_stride, const float *v, size_t v_stride) {
+    __m256 row[8], pair[8], quad[8];
+
+    for(size_t index = 0; index < 8; index++) {
+        row[index] = _mm256_loadu_ps(v + index * v_stride);
+    }
+
+    for(size_t index = 0; index < 8; index += 2) {
+        pair[index] = _mm256_unpacklo_ps(row[index], row[index + 1]);
+        pair[index + 1] = _mm256_unpackhi_ps(row[index], row[index + 1]);
+    }
+
+    for(size_t index = 0; index < 8; index += 4) {
+        quad[index] = _mm256_shuffle_ps(pair[index], pair[index + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        quad[index + 1] = _mm256_shuffle_ps(pair[index], pair[index + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        quad[index + 2] = _mm256_shuffle_ps(pair[index + 1], pair[index + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        quad[index + 3] = _mm256_shuffle_ps(pair[index + 1], pair[index + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    for(size_t index = 0; index < 4; index++) {
+        _mm256_storeu_ps(result + index * result_stride, _mm256_permute2f128_ps(quad[index], quad[index + 4], 0x20));
+        _mm256_storeu_ps(result + (index + 4) * result_stride, _mm256_permute2f128_ps(quad[index], quad[index + 4], 0x31));
+    }
+}
+
+#define AVX2_SUM(accumulator, index)     accumulator = _mm256_add_ps(accumulator, _mm256_loadu_ps(v + (index)))
+#define AVX2_ABS_SUM(accumulator, index) accumulator = _mm256_add_ps(accumulator, _mm256_andnot_ps(_mm256_set1_ps(-0.f), _mm256_loadu_ps(v + (index))))
+#define AVX2_DOT(accumulator, index)     accumulator = _mm256_fmadd_ps(_mm256_loadu_ps(v + (index)), _mm256_loadu_ps(w + (index)), accumulator)
+
+SIMD_OPERATIONS(avx2, AVX2, 8, __m256, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps,
+                _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_div_ps)
+SIMD_REDUCE(sum_avx2, AVX2, 8, __m256, _mm256_setzero_ps, _mm256_add_ps, avx2_horizontal, AVX2_SUM, SUM_ELEMENT)
+SIMD_REDUCE(abs_sum_avx2, AVX2, 8, __m256, _mm256_setzero_ps, _mm256_add_ps, avx2_horizontal, AVX2_ABS_SUM, ABS_SUM_ELEMENT)
+SIMD_REDUCE(dot_avx2, AVX2, 8, __m256, _mm256_setzero_ps, _mm256_add_ps, avx2_horizontal, AVX2_DOT, DOT_ELEMENT)
+SIMD_TRANSPOSE(transpose_avx2, AVX2, 8, avx2_transpose_block)
+
+static const simd_kernel simd_avx2_kernel = SIMD_TABLE(avx2);
+
+
+/* AVX-512 */
+#define AVX512 __attribute__((target("avx512f")))
+
+AVX512 static inline __m512
+avx512_floor(__m512 x) {
+    return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+AVX512 static inline __m512
+avx512_power(__m512 n) {
+    __m512i bits = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvttps_epi32(n), _mm512_set1_epi32(127)), 23);
+
+    return _mm512_castsi512_ps(bits);
+}
+
+AVX512 static inline __m512
+avx512_exp(__m512 x) {
+    SIMD_EXP_BODY(x, __m512, _mm512_set1_ps, _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_min_ps, _mm512_max_ps, avx512_floor, avx512_power)
+}
+
+#define avx512_max _mm512_max_ps
+// AVX-512 implies AVX2, its 8 x 8 blocks are reused
+#define transpose_avx512 transpose_avx2
+
+#define AVX512_SUM(accumulator, index)     accumulator = _mm512_add_ps(accumulator, _mm512_loadu_ps(v + (index)))
+#define AVX512_ABS_SUM(accumulator, index) accumulator = _mm512_add_ps(accumulator, _mm512_abs_ps(_mm512_loadu_ps(v + (index))))
+#define AVX512_DOT(accumulator, index)     accumulator = _mm512_fmadd_ps(_mm512_loadu_ps(v + (index)), _mm512_loadu_ps(w + (index)), accumulator)
+
+SIMD_OPERATIONS(avx512, AVX512, 16, __m512, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps,
+                _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_div_ps)
+SIMD_REDUCE(sum_avx512, AVX512, 16, __m512, _mm512_setzero_ps, _mm512_add_ps, _mm512_reduce_add_ps, AVX512_SUM, SUM_ELEMENT)
+SIMD_REDUCE(abs_sum_avx512, AVX512, 16, __m512, _mm512_setzero_ps, _mm512_add_ps, _mm512_reduce_add_ps, AVX512_ABS_SUM, ABS_SUM_ELEMENT)
+SIMD_REDUCE(dot_avx512, AVX512, 16, __m512, _mm512_setzero_ps, _mm512_add_ps, _mm512_reduce_add_ps, AVX512_DOT, DOT_ELEMENT)
+
+static const simd_kernel simd_avx512_kernel = SIMD_TABLE(avx512);
+#endif
+
+
+/* Dispatch */
+static
+const simd_kernel *
+simd_kernel_select(void) {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) {
+        return &simd_avx512_kernel;
+    }
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return &simd_avx2_kernel;
+    }
+    if(__builtin_cpu_supports("sse2")) {
+        return &simd_sse_kernel;
+    }
+#endif
+    return &simd_scalar_kernel;
+}
+
+static
+void
+simd_kernel_init(void) {
+    kernel = simd_kernel_select();
+}
+
+const char *
+simd_kernel_name(void) {
+    return SIMD_KERNEL->name;
+}
+
+void simd_add(float *result, const float *v, const float *w, size_t size) { SIMD_KERNEL->add(result, v, w, size); }
+void simd_sub(float *result, const float *v, const float *w, size_t size) { SIMD_KERNEL->sub(result, v, w, size); }
+void simd_mul(float *result, const float *v, const float *w, size_t size) { SIMD_KERNEL->mul(result, v, w, size); }
+void simd_div(float *result, const float *v, const float *w, size_t size) { SIMD_KERNEL->div(result, v, w, size); }
+void simd_max(float *result, const float *v, const float *w, size_t size) { SIMD_KERNEL->max(result, v, w, size); }
+void simd_exp(float *result, const float *v, size_t size) { SIMD_KERNEL->exp(result, v, size); }
+
+void simd_scalar_add(float *result, const float *v, float scalar, size_t size) { SIMD_KERNEL->scalar_add(result, v, scalar, size); }
+void simd_scalar_sub(float *result, const float *v, float scalar, size_t size) { SIMD_KERNEL->scalar_sub(result, v, scalar, size); }
+void simd_scalar_mul(float *result, const float *v, float scalar, size_t size) { SIMD_KERNEL->scalar_mul(result, v, scalar, size); }
+void simd_scalar_div(float *result, const float *v, float scalar, size_t size) { SIMD_KERNEL->scalar_div(result, v, scalar, size); }
+
+float simd_sum(const float *v, size_t size) { return simd_pairwise(SIMD_KERNEL->sum, v, NULL, size); }
+float simd_abs_sum(const float *v, size_t size) { return simd_pairwise(SIMD_KERNEL->abs_sum, v, NULL, size); }
+float simd_dot(const float *v, const float *w, size_t size) { return simd_pairwise(SIMD_KERNEL->dot, v, w, size); }
+
+void simd_transpose(float *result, size_t result_stride, const float *v, size_t v_stride, size_t rows, size_t columns) {
+    SIMD_KERNEL->transpose(result, result_stride, v, v_stride, rows, columns);
+}
+
+
+/* Pairwise reduction */
+// Halves are cut on 16 values, so every block starts on the same lane
+static
+float
+simd_pairwise(simd_reduce reduce, const float *v, const float *w, size_t size) {
+    if(size <= SIMD_BLOCK) {
+        return reduce(v, w, size);
+    }
+
+    size_t half = (size / 2 + 15) & ~(size_t)15;
+
+    return simd_pairwise(reduce, v, w, half)
+         + simd_pairwise(reduce, v + half, w ? w + half : NULL, size - half);
+}
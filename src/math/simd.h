@@ -0,0 +1,51 @@
+//
+//  simd.h
+//  math
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef simd_h
+#define simd_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Reductions sum blocks of this size in registers, blocks are added pairwise */
+#define SIMD_BLOCK 256
+/* Transpose walks tiles of this size, tile of source and result stay in L1 */
+#define SIMD_TILE 32
+
+/*
+ * Element-wise kernels, result may be the same memory as v.
+ * Best of AVX-512, AVX2 and SSE is picked by CPU at the first call.
+ */
+void  simd_add(float *result, const float *v, const float *w, size_t size);
+void  simd_sub(float *result, const float *v, const float *w, size_t size);
+void  simd_mul(float *result, const float *v, const float *w, size_t size);
+void  simd_div(float *result, const float *v, const float *w, size_t size);
+void  simd_max(float *result, const float *v, const float *w, size_t size);
+// Approximation with relative error about 2e-7, input is clamped to
+// [-87.3, 88.3], so it never overflows to infinity
+void  simd_exp(float *result, const float *v, size_t size);
+
+void  simd_scalar_add(float *result, const float *v, float scalar, size_t size);
+void  simd_scalar_sub(float *result, const float *v, float scalar, size_t size);
+void  simd_scalar_mul(float *result, const float *v, float scalar, size_t size);
+void  simd_scalar_div(float *result, const float *v, float scalar, size_t size);
+
+/* Result (columns x rows) = transposed v (rows x columns), both row-major
+   with own row strides, result can't overlap v */
+void  simd_transpose(float *result, size_t result_stride, const float *v, size_t v_stride,
+                     size_t rows, size_t columns);
+
+/* Reductions, error grows with log of size instead of size */
+float simd_sum(const float *v, size_t size);
+float simd_abs_sum(const float *v, size_t size);
+float simd_dot(const float *v, const float *w, size_t size);
+
+const char *simd_kernel_name(void);
+
+#endif /* simd_h */
@@ -20,11 +20,10 @@
 
 
 #define TENSOR_INDEX_N(tensor, rank, N, ...)
-#define TENSOR_TYPE "t_Ten"
 
 typedef struct
 {
-    char   *type;
+    enum type_tag type;
     
     vector *rank;
     vector *data;
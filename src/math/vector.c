@@ -10,12 +10,15 @@
 #include "vector.h"
 
 // Life Cycle
+static vector *      vector_allocate(size_t size, enum bool with_values);
 static number *      number_create(float value);
 static vector *      vector_create(size_t size);
 static vector *      vector_create_from_list(size_t size, float *values);
 static vector *      vector_create_from_list_char(size_t size, char **values);
 static vector *      vector_copy(vector *original);
 static vector *      vector_reshape(vector *instance, size_t size);
+static vector *      vector_view(float *values, size_t size);
+static vector *      vector_strided(float *values, size_t size, size_t stride);
 static void          vector_delete(void *instance);
 
 // Data
@@ -73,6 +76,8 @@ const struct vector_library Vector = {
     .copy = vector_copy,
     .reshape = vector_reshape,
     .seed = vector_seed,
+    .view = vector_view,
+    .strided = vector_strided,
     .delete = vector_delete,
     
     .print = vector_print,
@@ -114,6 +119,20 @@ const struct vector_library Vector = {
     .mul = vector_multiplication_cast,
     .div = vector_division_cast,
     
+    .vv = {
+        .add = vector_addition,
+        .sub = vector_substraction,
+        .mul = vector_vector_multiplication,
+        .div = vector_vector_division
+    },
+    
+    .vs = {
+        .add = vector_scalar_addition,
+        .sub = vector_scalar_substraction,
+        .mul = vector_scalar_multiplication,
+        .div = vector_scalar_division
+    },
+    
     .num = {
         .add = vector_scalar_addition,
         .sub = vector_scalar_substraction,
@@ -129,20 +148,60 @@ const struct vector_library Vector = {
 
 
 /* Macros */
-#define VECTOR_OPERATION(result, v, w, expression)                                    \
-    vector_foreach(result)                                                            \
-    {                                                                                 \
-        VECTOR(result, index) = VECTOR(v, index) expression VECTOR(w, index);         \
+// Operation is one of add, sub, mul, div kernels, strided views are
+// walked by elements
+#define VECTOR_OPERATION(result, v, w, operation, expression)                         \
+    if(VECTOR_PACKED(result) && VECTOR_PACKED(v) && VECTOR_PACKED(w)) {               \
+        simd_##operation((result)->values, (v)->values, (w)->values, (result)->size); \
+    } else {                                                                          \
+        vector_foreach(result) {                                                      \
+            VECTOR(result, index) = VECTOR(v, index) expression VECTOR(w, index);     \
+        }                                                                             \
     }
 
-// PRAGMA(omp parallel for) 
-#define VECTOR_SCALAR_OPERATION(result, v, scalar, expression)                                           \
-    vector_foreach(result)                                                                               \
-    {                                                                                                    \
-        VECTOR(result, index) = VECTOR(v, index) expression scalar;                                      \
+#define VECTOR_SCALAR_OPERATION(result, v, scalar, operation, expression)             \
+    if(VECTOR_PACKED(result) && VECTOR_PACKED(v)) {                                   \
+        simd_scalar_##operation((result)->values, (v)->values, scalar, (result)->size); \
+    } else {                                                                          \
+        vector_foreach(result) {                                                      \
+            VECTOR(result, index) = VECTOR(v, index) expression (scalar);             \
+        }                                                                             \
     }
 
 /* Life Cycle */
+// Header and values are taken from active arena, or from heap without it
+static
+vector *
+vector_allocate(size_t size, enum bool with_values) {
+    memory_arena *arena = Arena.current();
+    vector *instance = arena
+                     ? Arena.alloc(arena, sizeof(vector))
+                     : malloc(sizeof(vector));
+    check_memory(instance);
+
+    instance->type = VECTOR_TYPE;
+    instance->size = size;
+    instance->values = NULL;
+    instance->stride = 1;
+    instance->view = with_values == false;
+    instance->arena = arena;
+
+    if(with_values) {
+        instance->values = arena
+                         ? Arena.alloc(arena, size * sizeof(float))
+                         : malloc(size * sizeof(float));
+        check_memory_print(instance->values, "Size: %lu", size);
+    }
+
+    return instance;
+
+error:
+    if(instance && arena == NULL) {
+        free(instance);
+    }
+    return NULL;
+}
+
 static
 number *
 number_create(float value) {
@@ -155,14 +214,10 @@ number_create(float value) {
 static
 vector *
 vector_create(size_t size) {
-    vector *instance = malloc(sizeof(vector));
-    float *values = calloc(size, sizeof(float));
+    vector *instance = vector_allocate(size, true);
     check_memory(instance);
-    check_memory_print(values, "Size: %lu", size);
 
-    instance->type = VECTOR_TYPE;
-    instance->size = size;
-    instance->values = values;
+    memset(instance->values, 0, size * sizeof(float));
     
     return instance;
 error:
@@ -174,17 +229,10 @@ vector *
 vector_create_from_list(size_t size, float values[]) {
     check(size, "Vector size should be greater than zero.");
     
-    vector *instance = malloc(sizeof(vector));
+    vector *instance = vector_allocate(size, true);
     check_memory(instance);
     
-    size_t vector_size = size * sizeof(float);
-    float *vector_values = malloc(vector_size);
-    memcpy(vector_values, values, vector_size);
-    check_memory(vector_values);
-    
-    instance->type = VECTOR_TYPE;
-    instance->size = size;
-    instance->values = vector_values;
+    memcpy(instance->values, values, size * sizeof(float));
 
     return instance;
 
@@ -197,16 +245,10 @@ vector *
 vector_create_from_list_char(size_t size, char **values) {
     check(size, "Vector size should be greater than zero.");
     
-    vector *instance = calloc(1, sizeof(vector));
+    vector *instance = vector_allocate(size, true);
     enum bool is_hash = false;
     check_memory(instance);
     
-    size_t vector_size = size * sizeof(float);
-    instance->type = VECTOR_TYPE;
-    instance->size = size;
-    instance->values = malloc(vector_size);
-    check_memory(instance->values);
-    
     vector_foreach(instance) {
         if(atof(values[index]) == false) {
             is_hash = true;
@@ -233,7 +275,13 @@ vector *
 vector_uniq(vector *instance) {
     check_memory(instance);
     size_t size = 0;
-    float *uniq = uniq_floats(instance->values, instance->size, &size);
+    vector *packed = VECTOR_PACKED(instance) ? instance : vector_copy(instance);
+    check_memory(packed);
+
+    float *uniq = uniq_floats(packed->values, packed->size, &size);
+    if(packed != instance) {
+        vector_delete(packed);
+    }
     check_memory(uniq);
 
     return vector_create_from_list(size, uniq);
@@ -245,8 +293,53 @@ static
 vector *
 vector_copy(vector *original) {
     vector_check(original);
+
+    if(VECTOR_PACKED(original)) {
+        return vector_create_from_list(original->size, original->values);
+    }
+
+    // Copy of strided view is packed
+    vector *instance = vector_allocate(original->size, true);
+    check_memory(instance);
+
+    vector_foreach(instance) {
+        VECTOR(instance, index) = VECTOR(original, index);
+    }
+
+    return instance;
+
+error:
+    return NULL;
+}
+
+static
+vector *
+vector_view(float *values, size_t size) {
+    check_memory(values);
+    check(size, "Vector size should be greater than zero.");
+    
+    vector *instance = vector_allocate(size, false);
+    check_memory(instance);
     
-    return vector_create_from_list(original->size, original->values);
+    instance->values = values;
+    
+    return instance;
+
+error:
+    return NULL;
+}
+
+static
+vector *
+vector_strided(float *values, size_t size, size_t stride) {
+    check(stride, "Vector stride should be greater than zero.");
+
+    vector *instance = vector_view(values, size);
+    check_memory(instance);
+
+    instance->stride = stride;
+
+    return instance;
 
 error:
     return NULL;
@@ -257,8 +350,19 @@ vector *
 vector_reshape(vector *instance, size_t size) {
     vector_check(instance);
     check(size, "Vector size should be greater than zero.");
+    check(instance->view == false, "Vector view can't be reshaped.");
     
-    instance->values = realloc(instance->values, size * sizeof(float));
+    if(instance->arena) {
+        // Old values stay in arena until it's rewound
+        float *values = Arena.alloc(instance->arena, size * sizeof(float));
+        check_memory(values);
+
+        memcpy(values, instance->values, (size < instance->size ? size : instance->size) * sizeof(float));
+        instance->values = values;
+    } else {
+        instance->values = realloc(instance->values, size * sizeof(float));
+        check_memory(instance->values);
+    }
     
     if(size > instance->size) {
         memset(instance->values + instance->size, 0, (size - instance->size) * sizeof(float));
@@ -280,7 +384,14 @@ vector_delete(void *instance) {
     if (IS(instance, VECTOR_TYPE))
     {
         vector *vec = (vector*)instance;
-        free(vec->values);
+        // Arena gives memory back by itself
+        if(vec->arena) {
+            return;
+        }
+
+        if(vec->view == false) {
+            free(vec->values);
+        }
         free(vec);
 
         return;
@@ -355,8 +466,7 @@ vector_addition_cast(vector *v, void *term) {
         return vector_addition(v, (vector *)term);
     }
     
-    return vector_scalar_addition(v,
-                                  ((number*)term)->value);
+    return vector_scalar_addition(v, SCALAR_CAST(term));
 
 error:
     return NULL;
@@ -369,7 +479,7 @@ vector_addition(vector *v, vector *w) {
     vector_check(w);
     check(v->size == w->size, "Vector size doesn't match");
 
-    VECTOR_OPERATION(v, v, w, +);
+    VECTOR_OPERATION(v, v, w, add, +);
 
     return v;
 
@@ -381,7 +491,7 @@ static
 vector *
 vector_scalar_addition(vector *v, float scalar) {
     vector_check(v);
-    VECTOR_SCALAR_OPERATION(v, v, scalar, +);
+    VECTOR_SCALAR_OPERATION(v, v, scalar, add, +);
     
     return v;
 
@@ -400,8 +510,7 @@ vector_substraction_cast(vector *v, void *subtrahend) {
         return vector_substraction(v, (vector *)subtrahend);
     }
     
-    return vector_scalar_substraction(v,
-                                      ((number*)subtrahend)->value);
+    return vector_scalar_substraction(v, SCALAR_CAST(subtrahend));
 
 error:
     return NULL;
@@ -412,8 +521,9 @@ vector *
 vector_substraction(vector *v, vector *w) {
     vector_check(v);
     vector_check(w);
+    check(v->size == w->size, "Vector size doesn't match");
     
-    VECTOR_OPERATION(v, v, w, -);
+    VECTOR_OPERATION(v, v, w, sub, -);
     
     return v;
 
@@ -425,7 +535,7 @@ static
 vector *
 vector_scalar_substraction(vector *v, float scalar) {
     vector_check(v);
-    VECTOR_SCALAR_OPERATION(v, v, scalar, -);
+    VECTOR_SCALAR_OPERATION(v, v, scalar, sub, -);
     
     return v;
 
@@ -438,7 +548,12 @@ static
 vector *
 vector_multiplication_cast(vector *v, void *factor) {
     vector_check(v);
-    return vector_vector_multiplication(v, (vector *)factor);
+    
+    if(IS(factor, VECTOR_TYPE)) {
+        return vector_vector_multiplication(v, (vector *)factor);
+    }
+    
+    return vector_scalar_multiplication(v, SCALAR_CAST(factor));
     
 error:
     return NULL;
@@ -450,7 +565,7 @@ vector_vector_multiplication(vector *v, vector *w) {
     vector_check(v);
     vector_check(w);
     check(v->size == w->size, "Vectors size doesn't match");
-    VECTOR_OPERATION(v, v, w, *);
+    VECTOR_OPERATION(v, v, w, mul, *);
 
     return v;
 
@@ -462,7 +577,7 @@ static
 vector *
 vector_scalar_multiplication(vector *v, float scalar) {
     vector_check(v);
-    VECTOR_SCALAR_OPERATION(v, v, scalar, *);
+    VECTOR_SCALAR_OPERATION(v, v, scalar, mul, *);
     
     return v;
 
@@ -481,8 +596,7 @@ vector_division_cast(vector *v, void *divider) {
         return vector_vector_division(v, (vector *)divider);
     }
     
-    return vector_scalar_division(v,
-                                  ((number*)divider)->value);
+    return vector_scalar_division(v, SCALAR_CAST(divider));
     
 error:
     return NULL;
@@ -492,7 +606,9 @@ static
 vector *
 vector_vector_division(vector *v, vector *w) {
     vector_check(v);
-    VECTOR_OPERATION(v, v, w, /);
+    vector_check(w);
+    check(v->size == w->size, "Vectors size doesn't match");
+    VECTOR_OPERATION(v, v, w, div, /);
     
     return v;
     
@@ -504,7 +620,7 @@ static
 vector *
 vector_scalar_division(vector *v, float scalar) {
     vector_check(v);
-    VECTOR_SCALAR_OPERATION(v, v, scalar, /);
+    VECTOR_SCALAR_OPERATION(v, v, scalar, div, /);
     
     return v;
     
@@ -519,14 +635,18 @@ vector_dot_product(vector *v, vector *w) {
     vector_check(v);
     vector_check(w);
     
-    float product = 0.0f;
-    
-    //#pragma omp parallel for simd reduction (+:product)
-    vector_foreach(v) {
-        product += VECTOR(v, index) * VECTOR(w, index);
+    check(v->size == w->size, "Vector size doesn't match");
+
+    if(VECTOR_PACKED(v) == false || VECTOR_PACKED(w) == false) {
+        float dot = 0;
+        vector_foreach(v) {
+            dot += VECTOR(v, index) * VECTOR(w, index);
+        }
+
+        return dot;
     }
     
-    return product;
+    return simd_dot(v->values, w->values, v->size);
     
 error:
     return 0;
@@ -602,14 +722,7 @@ float
 vector_sum(vector *v) {
     vector_check(v);
     
-    float sum = 0;
-    
-    //#pragma omp parallel for simd reduction (+:sum)
-    vector_foreach(v) {
-        sum += VECTOR(v, index);
-    }
-    
-    return sum;
+    return vector_sum_between(v, 0, v->size);
     
 error:
     return 0;
@@ -620,16 +733,10 @@ float
 vector_sum_to(vector *v, size_t to_index) {
     vector_check(v);
     
-    float sum = 0;
+    // Value at to index is included
+    size_t size = to_index < v->size ? to_index + 1 : v->size;
     
-    vector_foreach(v) {
-        sum += VECTOR(v, index);
-        if(index == to_index) {
-            return sum;
-        }
-    }
-    
-    return sum;
+    return vector_sum_between(v, 0, size);
 
 error:
     return 0;
@@ -640,13 +747,18 @@ float
 vector_sum_between(vector *v, size_t from_index, size_t to_index) {
     vector_check(v);
 
-    float sum = 0;
-    
-    for(size_t index = from_index; index < to_index; index++) {
-        sum += VECTOR(v, index);
+    check(from_index <= to_index && to_index <= v->size, "Range %zd..%zd is out of vector", from_index, to_index);
+
+    if(VECTOR_PACKED(v) == false) {
+        float sum = 0;
+        for(size_t index = from_index; index < to_index; index++) {
+            sum += VECTOR(v, index);
+        }
+
+        return sum;
     }
     
-    return sum;
+    return simd_sum(v->values + from_index, to_index - from_index);
     
 error:
     return 0;
@@ -673,6 +785,14 @@ vector_l_norm(vector *v, int p) {
     vector_check(v);
     check(p, "P = 0 for L_norm");
     
+    if(p == 1 && VECTOR_PACKED(v)) {
+        return simd_abs_sum(v->values, v->size);
+    }
+    
+    if(p == 2) {
+        return sqrt(vector_dot_product(v, v));
+    }
+    
     float l_norm = 0;
     
     size_t index = v->size;
@@ -772,10 +892,21 @@ vector_is_equal(vector *v, vector *w) {
     vector_check(v);
     vector_check(w);
     
-    enum bool is_equal = v->size == w->size
-    && memcmp(v->values, w->values, v->size) == 0;
-    
-    return is_equal;
+    if(v->size != w->size) {
+        return false;
+    }
+
+    if(VECTOR_PACKED(v) && VECTOR_PACKED(w)) {
+        return memcmp(v->values, w->values, v->size * sizeof(float)) == 0;
+    }
+
+    vector_foreach(v) {
+        if(VECTOR(v, index) != VECTOR(w, index)) {
+            return false;
+        }
+    }
+
+    return true;
 
 error:
     return false;
@@ -18,15 +18,22 @@
 //#include "omp.h"
 
 #include "number.h"
+#include "simd.h"
 #include "../util/sort.h"
+#include "../util/arena.h"
 
-#define VECTOR_TYPE "t_Vec"
-#define VECTOR_HASH_TYPE "t_VectorHash"
-
-#define vector_check_print(vector, message, ...) { check_memory_print(vector, message, ##__VA_ARGS__); check((vector)->size, "Vector size doesn't set. " message, ##__VA_ARGS__); }
+#define vector_check_print(vector, message, ...) { check_memory_print(vector, message, ##__VA_ARGS__); check_valid((vector)->size, "Vector size doesn't set. " message, ##__VA_ARGS__); }
 #define vector_check(vector) vector_check_print(vector, "")
-#define vector_values_check(vector) vector_foreach(vector) check(isnan(VECTOR(vector, index)) == false && isinf(VECTOR(vector, index)) == false, "v[%zd] = %f", index, VECTOR(vector, index))
-#define VECTOR(vector, index) *((vector)->values + index)
+
+// Scalar operand of cast operations is number instance or plain float
+#define SCALAR_CAST(operand) (IS(operand, NUMBER_TYPE) ? ((number*)(operand))->value : *(float*)(operand))
+// Scan of values is done only by paranoid build
+#define vector_values_check(vector) \
+    for(size_t index = 0; PARANOID_CHECKS && index < (vector)->size; index++) \
+        check(isnan(VECTOR(vector, index)) == false && isinf(VECTOR(vector, index)) == false, "v[%zd] = %f", index, VECTOR(vector, index))
+#define VECTOR(vector, index) *((vector)->values + (index) * (vector)->stride)
+// Values follow each other, so SIMD kernels can take them
+#define VECTOR_PACKED(vector) ((vector)->stride == 1)
 
 #define PRAGMA(x) _Pragma(#x)
 
@@ -38,38 +45,43 @@
 
 typedef struct
 {
-    char   *type;
+    enum type_tag type;
     float value;
 } number;
 
 typedef struct
 {
-    char   *type;
+    enum type_tag type;
     
     size_t size;
     float *values;
+    // Distance between values, 1 unless it's a strided view
+    size_t stride;
+    
+    enum bool view;
+    // Owner of header and values, NULL when they are on heap
+    memory_arena *arena;
 } vector;
 
 typedef struct
 {
-    char *type;
+    enum type_tag type;
     
     char **keys;
     size_t size;
     vector *index;
 } vector_hash;
 
-struct vector_library_operation {
-    vector *    (*vec)(vector *v, vector *w);
-    vector *    (*num)(vector *v, float scalar);
-};
-
 struct vector_library {
     vector *  (*create)(size_t size);
     // Make new instance of vector in memory
     vector *  (*copy)(vector *original);
     vector *  (*reshape)(vector *v, size_t size);
     vector *  (*seed)(vector *instance, float default_value);
+    // Header over values owned by someone else, delete leaves values alone
+    vector *  (*view)(float *values, size_t size);
+    // View of every stride value, like column or diagonal of matrix
+    vector *  (*strided)(float *values, size_t size, size_t stride);
     void      (*delete)(void *v);
     
     void      (*print)(vector *v);
@@ -106,12 +118,28 @@ struct vector_library {
         enum bool (*is_perpendicular)(vector *v, vector *w);
     } rel;
     
-    // Operations
+    // Operations, operand type is looked up by its tag
     vector *      (*add)(vector *v, void *term);
     vector *      (*sub)(vector *v, void *subtrahend);
     vector *      (*mul)(vector *v, void *factor);
     vector *      (*div)(vector *v, void *divider);
     
+    // Typed operations for hot paths, no tag lookup
+    struct {
+        vector *      (*add)(vector *v, vector *w);
+        vector *      (*sub)(vector *v, vector *w);
+        vector *      (*mul)(vector *v, vector *w);
+        vector *      (*div)(vector *v, vector *w);
+    } vv;
+    
+    struct {
+        vector *      (*add)(vector *v, float term);
+        vector *      (*sub)(vector *v, float subtrahend);
+        vector *      (*mul)(vector *v, float factor);
+        vector *      (*div)(vector *v, float divider);
+    } vs;
+    
+    // Same as vs
     struct {
         vector *      (*add)(vector *v, float term);
         vector *      (*sub)(vector *v, float subtrahend);
@@ -11,21 +11,42 @@
 static double  sigmoid(double value);
 static vector *sigmoid_context(neuron_context *context);
 static vector *sigmoid_derivative(neuron_context *context);
+static matrix *sigmoid_layer(matrix *transfer, matrix *activation);
+static matrix *sigmoid_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix *sigmoid_fused(matrix *transfer, matrix *activation, matrix *derivative);
 static vector *tanh_context(neuron_context *context);
 static vector *tanh_derivative(neuron_context *context);
+static matrix *tanh_layer(matrix *transfer, matrix *activation);
+static matrix *tanh_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix *tanh_fused(matrix *transfer, matrix *activation, matrix *derivative);
 // static float   soft_sign(neuron_context *context);
 // static float   soft_sign_derivative(neuron_context *context);
 static double   heaviside_step(double value);
 static vector  *heaviside_step_context(neuron_context *context);
 static vector  *heaviside_step_derivative(neuron_context *context);
+static matrix  *heaviside_step_layer(matrix *transfer, matrix *activation);
+static matrix  *heaviside_step_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix  *heaviside_step_fused(matrix *transfer, matrix *activation, matrix *derivative);
 // static float   soft_plus(neuron_context *context);
 // static float   soft_plus_derivative(neuron_context *context);
 static vector *soft_max(neuron_context *context);
 static vector *soft_max_derivative(neuron_context *context);
+static matrix *soft_max_layer(matrix *transfer, matrix *activation);
+static matrix *soft_max_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix *soft_max_fused(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix *soft_max_columns(matrix *transfer, matrix *activation, matrix *derivative, enum bool logarithm);
+static vector *log_soft_max(neuron_context *context);
+static vector *log_soft_max_derivative(neuron_context *context);
+static matrix *log_soft_max_layer(matrix *transfer, matrix *activation);
+static matrix *log_soft_max_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix *log_soft_max_fused(matrix *transfer, matrix *activation, matrix *derivative);
 static double relu(double value);
 static double relu_derivative(double value);
 static vector *relu_context(neuron_context *context);
 static vector *relu_derivative_context(neuron_context *context);
+static matrix *relu_layer(matrix *transfer, matrix *activation);
+static matrix *relu_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative);
+static matrix *relu_fused(matrix *transfer, matrix *activation, matrix *derivative);
 // static float   leaky_relu(neuron_context *context);
 // static float   leaky_relu_derivative(neuron_context *context);
 // static float   elu(neuron_context *context);
@@ -38,10 +59,16 @@ const struct activation_library Activation = {
     .sigmoid = {
         .of = sigmoid_context,
         .derivative = sigmoid_derivative,
+        .layer = sigmoid_layer,
+        .layer_derivative = sigmoid_layer_derivative,
+        .fused = sigmoid_fused
     },
     .tanh = {
         .of = tanh_context,
-        .derivative = tanh_derivative
+        .derivative = tanh_derivative,
+        .layer = tanh_layer,
+        .layer_derivative = tanh_layer_derivative,
+        .fused = tanh_fused
     },
 //    .soft_sign = {
 //        .of = soft_sign,
@@ -49,7 +76,10 @@ const struct activation_library Activation = {
 //    },
     .heaviside_step = {
         .of = heaviside_step_context,
-        .derivative = heaviside_step_derivative
+        .derivative = heaviside_step_derivative,
+        .layer = heaviside_step_layer,
+        .layer_derivative = heaviside_step_layer_derivative,
+        .fused = heaviside_step_fused
     },
 //    .soft_plus = {
 //        .of = soft_plus,
@@ -57,11 +87,24 @@ const struct activation_library Activation = {
 //    },
     .soft_max = {
         .of = soft_max,
-        .derivative = soft_max_derivative
+        .derivative = soft_max_derivative,
+        .layer = soft_max_layer,
+        .layer_derivative = soft_max_layer_derivative,
+        .fused = soft_max_fused
+    },
+    .log_soft_max = {
+        .of = log_soft_max,
+        .derivative = log_soft_max_derivative,
+        .layer = log_soft_max_layer,
+        .layer_derivative = log_soft_max_layer_derivative,
+        .fused = log_soft_max_fused
     },
     .relu = {
         .of = relu_context,
-        .derivative = relu_derivative_context
+        .derivative = relu_derivative_context,
+        .layer = relu_layer,
+        .layer_derivative = relu_layer_derivative,
+        .fused = relu_fused
     },
 //    .leaky_relu = {
 //        .of = leaky_relu,
@@ -78,6 +121,32 @@ const struct activation_library Activation = {
 };
 
 
+/* Macros */
+#define ACTIVATION_FITS(transfer, activation, name)                                        \
+    matrix_check(transfer);                                                                \
+    matrix_check(activation);                                                              \
+    check((transfer)->vector->size == (activation)->vector->size,                          \
+          name " %zdx%zd doesn't fit transfer %zdx%zd",                                    \
+          (activation)->rows, (activation)->columns, (transfer)->rows, (transfer)->columns);
+
+#define ACTIVATION_LAYER(transfer, activation, operation)                                  \
+    ACTIVATION_FITS(transfer, activation, "Activation");                                   \
+    vector_foreach((transfer)->vector) {                                                   \
+        VECTOR((activation)->vector, index) = operation(VECTOR((transfer)->vector, index)); \
+    }
+
+// Prime is an expression of value of transfer and its activation
+#define ACTIVATION_FUSED(transfer, activation, derivative, operation, prime)               \
+    ACTIVATION_FITS(transfer, activation, "Activation");                                   \
+    ACTIVATION_FITS(transfer, derivative, "Derivative");                                   \
+    vector_foreach((transfer)->vector) {                                                   \
+        float value = VECTOR((transfer)->vector, index);                                   \
+        float active = (float)operation(value);                                            \
+        VECTOR((activation)->vector, index) = active;                                      \
+        VECTOR((derivative)->vector, index) = (prime);                                     \
+    }
+
+
 /* Sigmoid */
 static
 double
@@ -93,18 +162,61 @@ sigmoid_context(neuron_context *context) {
 }
 
 
+// Derivative of transfer value, so cell derivative is one pass over copy
+static
+double
+sigmoid_derivative_of(double value) {
+    double sigmoid_value = sigmoid(value);
+
+    return sigmoid_value * (1 - sigmoid_value);
+}
+
 static
 vector *
 sigmoid_derivative(neuron_context *context) {
-    vector *sigmoid_value = sigmoid_context(context);
-    vector *one_minus_sigmoid = Vector.num.add(
-                                               Vector.num.mul(Vector.copy(sigmoid_value),
-                                                              -1),
-                                               1);
-    sigmoid_value = Vector.mul(sigmoid_value, one_minus_sigmoid);
-    Vector.delete(one_minus_sigmoid);
-    
-    return sigmoid_value;
+    return Vector.map(Vector.copy(context->body.transfer),
+                      sigmoid_derivative_of);
+}
+
+static
+matrix *
+sigmoid_layer(matrix *transfer, matrix *activation) {
+    ACTIVATION_LAYER(transfer, activation, sigmoid);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
+// Layer derivatives are taken from activation or transfer, both already computed by fire
+static
+double
+sigmoid_prime(double activation) {
+    return activation * (1 - activation);
+}
+
+static
+matrix *
+sigmoid_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative) {
+    (void)transfer;
+    ACTIVATION_LAYER(activation, derivative, sigmoid_prime);
+
+    return derivative;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+sigmoid_fused(matrix *transfer, matrix *activation, matrix *derivative) {
+    ACTIVATION_FUSED(transfer, activation, derivative, sigmoid, active * (1 - active));
+
+    return activation;
+
+error:
+    return NULL;
 }
 
 
@@ -139,6 +251,40 @@ relu_derivative_context(neuron_context *context) {
                       relu_derivative);
 }
 
+static
+matrix *
+relu_layer(matrix *transfer, matrix *activation) {
+    ACTIVATION_LAYER(transfer, activation, relu);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+relu_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative) {
+    (void)activation;
+    ACTIVATION_LAYER(transfer, derivative, relu_derivative);
+
+    return derivative;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+relu_fused(matrix *transfer, matrix *activation, matrix *derivative) {
+    ACTIVATION_FUSED(transfer, activation, derivative, relu, value > 0 ? 1 : 0);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
 
 /* Tanh */
 static
@@ -153,17 +299,20 @@ error:
     return NULL;
 }
 
+static
+double
+tanh_derivative_of(double value) {
+    double tanh_value = tanh(value);
+
+    return 1 - tanh_value * tanh_value;
+}
+
 static
 vector *
 tanh_derivative(neuron_context *context) {
     vector_check(context->body.transfer);
     vector *prime = Vector.map(Vector.copy(context->body.transfer),
-                               tanh);
-    prime = Vector.mul(prime, prime);
-    
-    prime = Vector.num.add(
-                          Vector.num.mul(prime, -1),
-                          1);
+                               tanh_derivative_of);
     vector_check(prime);
 
     return prime;
@@ -172,27 +321,71 @@ error:
     return NULL;
 }
 
+static
+matrix *
+tanh_layer(matrix *transfer, matrix *activation) {
+    ACTIVATION_LAYER(transfer, activation, tanh);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
+static
+double
+tanh_prime(double activation) {
+    return 1 - activation * activation;
+}
+
+static
+matrix *
+tanh_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative) {
+    (void)transfer;
+    ACTIVATION_LAYER(activation, derivative, tanh_prime);
+
+    return derivative;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+tanh_fused(matrix *transfer, matrix *activation, matrix *derivative) {
+    ACTIVATION_FUSED(transfer, activation, derivative, tanh, 1 - active * active);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
 /* Softmax */
+// Exponents are shifted by maximum of layer, so big transfer doesn't overflow
 static
 vector *
 soft_max(neuron_context *context) {
     size_t number_of_samples = context->body.signal->rows;
     size_t layer_dimension = context->layer.dimension;
     check(number_of_samples && layer_dimension, "Soft max wrong context: n = %zd, l = %zd", number_of_samples, layer_dimension);
+    vector_check_print(context->body.transfer, "Activation of context is broken");
 
     vector *activation = Vector.create(number_of_samples);
     
     for(size_t sample = 0; sample < number_of_samples; sample++) {
-        float layer_exp_sum = 0;
-        //#pragma omp parallel for reduction (+:layer_exp_sum)
+        float layer_max = -INFINITY;
         for (vector ***axon = context->layer.transfer; *axon; axon++ ){
             vector_check_print(**axon, "Axon vector in layer is broken");
-            float layer_axon_value_of_sample = VECTOR(**axon, sample);
-            layer_exp_sum += exp(layer_axon_value_of_sample);
+            layer_max = fmaxf(layer_max, VECTOR(**axon, sample));
+        }
+
+        float layer_exp_sum = 0;
+        for (vector ***axon = context->layer.transfer; *axon; axon++ ){
+            layer_exp_sum += expf(VECTOR(**axon, sample) - layer_max);
         }
-        vector_check_print(context->body.transfer, "Activation of context is broken");
         float axon_value_of_sample = VECTOR(context->body.transfer, sample);
-        VECTOR(activation, sample) = exp(axon_value_of_sample) / layer_exp_sum;
+        VECTOR(activation, sample) = expf(axon_value_of_sample - layer_max) / layer_exp_sum;
     }
     
     return activation;
@@ -204,42 +397,169 @@ static
 vector *
 soft_max_derivative(neuron_context *context) {
     vector *smax = soft_max(context);
-    vector *oneMinusSmax = Vector.num.add(
-                                          Vector.num.mul(Vector.copy(smax), -1.),
-                                          1);
-    vector *prime = Vector.mul(smax, oneMinusSmax);
+    vector_check(smax);
 
-    Vector.delete(oneMinusSmax);
+    return Vector.map(smax, sigmoid_prime);
 
-    return prime;
+error:
+    return NULL;
+}
 
-    // size_t number_of_samples = context->body.activation->size;
-    // // size_t layer_dimension = context->layer.dimension;
-    // 
-    // vector *prime = Vector.create(number_of_samples);
-    // 
-    // for(size_t sample = 0; sample < number_of_samples; sample++) {
-    //     float layer_exp_sum = 0;
-    //     for (vector ***axon = context->layer.transfer; *axon; axon++ ){
-    //         vector_check_print(**axon, "Axon vector in layer is broken");
-    //         float layer_axon_value_of_sample = VECTOR(**axon, sample);
-    //         layer_exp_sum += exp(layer_axon_value_of_sample);
-    //     }
-    //     vector_check_print(context->body.transfer, "Transfer of context is broken");
-
-    //     float axon_value_of_sample = VECTOR(context->body.transfer, sample);
-    //     float exp_axon_value = exp(axon_value_of_sample);
-    //     VECTOR(prime, sample) = (exp_axon_value * (layer_exp_sum - exp_axon_value))
-    //                             / pow(layer_exp_sum, 2);
-    //     
-    //     if(isnan(VECTOR(prime, sample)) != false || isinf(VECTOR(prime, sample)) != false) {
-    //             printf("bad");
-    //     }
-    //     
-    // }
+// Each sample is a column and row of neuron is contiguous, so layer is
+// reduced row by row with vector kernels: maximum, exponents of shifted
+// transfer and their sum, then normalization. Log keeps z - max - log(sum).
+// Derivative, when it isn't NULL, is diagonal of jacobian written with
+// the last pass
+static
+matrix *
+soft_max_columns(matrix *transfer, matrix *activation, matrix *derivative, enum bool logarithm) {
+    arena_mark scratch = Arena.push(Arena.scratch());
+    ACTIVATION_FITS(transfer, activation, "Activation");
+    check(transfer->rows == activation->rows, "Activation %zdx%zd doesn't fit transfer %zdx%zd",
+          activation->rows, activation->columns, transfer->rows, transfer->columns);
+    if(derivative) {
+        ACTIVATION_FITS(transfer, derivative, "Derivative");
+    }
 
+    size_t samples = transfer->columns;
+    vector *maximum = Vector.create(samples);
+    vector *sum = Vector.create(samples);
+    vector_check(maximum);
+    vector_check(sum);
 
-    return prime;
+    memcpy(maximum->values, &MATRIX(transfer, 0, 0), samples * sizeof(float));
+    for(size_t neuron = 1; neuron < transfer->rows; neuron++) {
+        simd_max(maximum->values, maximum->values, &MATRIX(transfer, neuron, 0), samples);
+    }
+
+    memset(sum->values, 0, samples * sizeof(float));
+    for(size_t neuron = 0; neuron < transfer->rows; neuron++) {
+        float *row = &MATRIX(activation, neuron, 0);
+
+        simd_sub(row, &MATRIX(transfer, neuron, 0), maximum->values, samples);
+        simd_exp(row, row, samples);
+        simd_add(sum->values, sum->values, row, samples);
+    }
+
+    if(logarithm) {
+        // Shift of each sample becomes max + log(sum)
+        vector_foreach(sum) {
+            VECTOR(maximum, index) += logf(VECTOR(sum, index));
+        }
+    }
+
+    for(size_t neuron = 0; neuron < transfer->rows; neuron++) {
+        float *row = &MATRIX(activation, neuron, 0);
+
+        if(logarithm) {
+            simd_sub(row, &MATRIX(transfer, neuron, 0), maximum->values, samples);
+        } else {
+            simd_div(row, row, sum->values, samples);
+        }
+
+        if(derivative) {
+            float *prime = &MATRIX(derivative, neuron, 0);
+
+            for(size_t sample = 0; sample < samples; sample++) {
+                float probability = logarithm ? expf(row[sample]) : row[sample];
+                prime[sample] = logarithm ? 1 - probability : probability * (1 - probability);
+            }
+        }
+    }
+
+    Arena.pop(scratch);
+    return activation;
+
+error:
+    Arena.pop(scratch);
+    return NULL;
+}
+
+static
+matrix *
+soft_max_layer(matrix *transfer, matrix *activation) {
+    return soft_max_columns(transfer, activation, NULL, false);
+}
+
+// Diagonal of softmax jacobian, the same as cell derivative uses
+static
+matrix *
+soft_max_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative) {
+    (void)transfer;
+    ACTIVATION_LAYER(activation, derivative, sigmoid_prime);
+
+    return derivative;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+soft_max_fused(matrix *transfer, matrix *activation, matrix *derivative) {
+    return soft_max_columns(transfer, activation, derivative, false);
+}
+
+
+/* Log Softmax */
+static
+double
+one_minus(double value) {
+    return 1 - value;
+}
+
+static
+double
+log_soft_max_prime(double activation) {
+    return 1 - exp(activation);
+}
+
+static
+vector *
+log_soft_max(neuron_context *context) {
+    vector *smax = soft_max(context);
+    vector_check(smax);
+
+    return Vector.map(smax, log);
+
+error:
+    return NULL;
+}
+
+static
+vector *
+log_soft_max_derivative(neuron_context *context) {
+    vector *smax = soft_max(context);
+    vector_check(smax);
+
+    return Vector.map(smax, one_minus);
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+log_soft_max_layer(matrix *transfer, matrix *activation) {
+    return soft_max_columns(transfer, activation, NULL, true);
+}
+
+static
+matrix *
+log_soft_max_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative) {
+    (void)transfer;
+    ACTIVATION_LAYER(activation, derivative, log_soft_max_prime);
+
+    return derivative;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+log_soft_max_fused(matrix *transfer, matrix *activation, matrix *derivative) {
+    return soft_max_columns(transfer, activation, derivative, true);
 }
 
 /* Heaviside Step */
@@ -264,6 +584,44 @@ heaviside_step_derivative(neuron_context *context) {
     return Vector.seed(Vector.create(context->body.transfer->size), 0);
 }
 
+static
+matrix *
+heaviside_step_layer(matrix *transfer, matrix *activation) {
+    ACTIVATION_LAYER(transfer, activation, heaviside_step);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+heaviside_step_layer_derivative(matrix *transfer, matrix *activation, matrix *derivative) {
+    (void)activation;
+    matrix_check(transfer);
+    matrix_check(derivative);
+    check(transfer->vector->size == derivative->vector->size, "Derivative doesn't fit transfer");
+
+    memset(derivative->vector->values, 0, derivative->vector->size * sizeof(float));
+
+    return derivative;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+heaviside_step_fused(matrix *transfer, matrix *activation, matrix *derivative) {
+    ACTIVATION_FUSED(transfer, activation, derivative, heaviside_step, 0);
+
+    return activation;
+
+error:
+    return NULL;
+}
+
 /* SoftSign */
 //static
 //float
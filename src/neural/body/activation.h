@@ -16,6 +16,12 @@
 struct activation_library_function {
     vector *      (*of)(neuron_context *context);
     vector *      (*derivative)(neuron_context *context);
+    // Whole layer at once, transfer and activation are neurons x samples
+    matrix *      (*layer)(matrix *transfer, matrix *activation);
+    // Derivative of whole layer into preallocated matrix of the same shape
+    matrix *      (*layer_derivative)(matrix *transfer, matrix *activation, matrix *derivative);
+    // Activation and its derivative in one pass over transfer, for training
+    matrix *      (*fused)(matrix *transfer, matrix *activation, matrix *derivative);
 };
 
 struct activation_library {
@@ -25,6 +31,8 @@ struct activation_library {
     struct activation_library_function                 heaviside_step;
     struct activation_library_function                 soft_plus;
     struct activation_library_function                 soft_max;
+    // Log of soft max, for log likelihood losses
+    struct activation_library_function                 log_soft_max;
     struct activation_library_function                 relu;
     struct activation_library_function                 leaky_relu;
     struct activation_library_function                 elu;
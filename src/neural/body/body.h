@@ -38,6 +38,8 @@ typedef struct {
     struct layer_state           layer;
 
     float *                      variables;
+    // State of stateful optimizer, kept between steps of the cell
+    float *                      optimizer;
 
     size_t                       layer_index;
     size_t                       position; 
@@ -7,26 +7,43 @@
 //
 
 #include "cost.h"
+#include "activation.h"
 
 static float          mean_squared(neuron_context *context, matrix *target);
 static vector *       mean_squared_derivative(neuron_context *context, matrix *target);
 // static vector *       cost_loss_mean_squared(vector *predicted, vector *target);
 static vector *       cost_loss_mean_squared_derivative(vector *predicted, vector *target);
+static float          mean_squared_layer(matrix *activation, matrix *target, matrix *error);
 
 static float          cross_entropy(neuron_context *context, matrix *target);
 static vector *       cross_entropy_derivative(neuron_context *context, matrix *target);
 static float          cost_loss_cross_entropy_vector(vector *predicted, vector *target);
 static vector *       cost_loss_cross_entropy_vector_derivative(vector *predicted, vector *target);
+static float          cross_entropy_layer(matrix *activation, matrix *target, matrix *error);
+static float          cross_entropy_logits(matrix *transfer, matrix *target, matrix *error);
+
+/* Macros */
+#define cost_layer_check(activation, target, error)                                            \
+    matrix_check(activation);                                                                  \
+    matrix_check(target);                                                                      \
+    matrix_check(error);                                                                       \
+    check((activation)->rows == (target)->columns && (activation)->columns == (target)->rows, \
+          "Target %zdx%zd doesn't fit layer %zdx%zd",                                         \
+          (target)->rows, (target)->columns, (activation)->rows, (activation)->columns);       \
+    check((error)->vector->size == (activation)->vector->size, "Error buffer doesn't fit layer")
 
 /* Library structure */
 const struct cost_library Cost = {
     .mean_squared = {
         .of = mean_squared,
-        .derivative = mean_squared_derivative
+        .derivative = mean_squared_derivative,
+        .layer = mean_squared_layer
     },
     .cross_entropy = {
         .of = cross_entropy,
-        .derivative = cross_entropy_derivative
+        .derivative = cross_entropy_derivative,
+        .layer = cross_entropy_layer,
+        .logits = cross_entropy_logits
     },
 };
 
@@ -36,10 +53,10 @@ static
 float
 mean_squared(neuron_context *context, matrix *target) {
     vector *predicted = Vector.copy(context->body.activation);
-    vector *cell_target = Matrix.column(target, context->position);
+    vector *cell_target = Matrix.slice.column(target, context->position);
 
-    vector *loss = Vector.sub(predicted, cell_target);
-    loss = Vector.mul(loss, loss);
+    vector *loss = Vector.vv.sub(predicted, cell_target);
+    loss = Vector.vv.mul(loss, loss);
  
     float mse = Vector.sum.all(loss) / loss->size;
 
@@ -55,16 +72,39 @@ static
 vector *
 mean_squared_derivative(neuron_context *context, matrix *target) {
     vector *predicted = context->body.activation;
-    vector *cell_target = Matrix.column(target, context->position);
+    vector *cell_target = Matrix.slice.column(target, context->position);
 
     vector *loss = cost_loss_mean_squared_derivative(predicted, cell_target);
 
+    Vector.delete(cell_target);
     Vector.delete(target);
 
     return loss;
 }
 
 
+// Loss of each neuron is averaged over samples, then over neurons
+static
+float
+mean_squared_layer(matrix *activation, matrix *target, matrix *error) {
+    cost_layer_check(activation, target, error);
+
+    float loss = 0;
+
+    matrix_foreach(activation) {
+        float difference = MATRIX(activation, row, column) - MATRIX(target, column, row);
+
+        MATRIX(error, row, column) = difference;
+        loss += difference * difference;
+    }
+
+    return loss / activation->vector->size;
+
+error:
+    return 0;
+}
+
+
 /* Unused 
 static
 vector *
@@ -81,7 +121,7 @@ cost_loss_mean_squared(vector *predicted, vector *target) {
 static
 vector *
 cost_loss_mean_squared_derivative(vector *predicted, vector *target) {
-    vector *loss = Vector.sub(Vector.copy(predicted),
+    vector *loss = Vector.vv.sub(Vector.copy(predicted),
                               target);
     
     return loss;
@@ -144,14 +184,13 @@ cross_entropy(neuron_context *context, matrix *target) {
 
     matrix *predicted_matrix = Matrix.from(predicted, layer_size, samples_count); 
     //matrix *predicted_matrix = Matrix.transpose(Matrix.from(predicted, layer_size, samples_count)); 
-    matrix *target_matrix = Matrix.transpose(Matrix.copy(target));
     
     vector *neurons_loss = Vector.create(samples_count);
 
     //#pragma omp parallel for
     for(size_t index = 0; index < samples_count; index++) {
-        vector *sample_predicted = Matrix.column(predicted_matrix, index);
-        vector *sample_target = Matrix.column(target_matrix, index);
+        vector *sample_predicted = Matrix.slice.column(predicted_matrix, index);
+        vector *sample_target = Matrix.slice.row(target, index);
         
         VECTOR(neurons_loss, index) = cost_loss_cross_entropy_vector(sample_predicted, sample_target);
         
@@ -163,7 +202,6 @@ cross_entropy(neuron_context *context, matrix *target) {
     float loss = Vector.sum.all(neurons_loss) / neurons_loss->size * -1.;
     
     Matrix.delete(predicted_matrix);
-    Matrix.delete(target_matrix);
     free(predicted);
 
     Vector.delete(neurons_loss);
@@ -176,7 +214,7 @@ static
 vector *
 cross_entropy_derivative(neuron_context *context, matrix *target) {
     vector *predicted = context->body.activation;
-    vector *cell_target = Matrix.column(target, context->position);
+    vector *cell_target = Matrix.slice.column(target, context->position);
 
     vector *loss = cost_loss_cross_entropy_vector_derivative(predicted, cell_target);
     
@@ -186,6 +224,61 @@ cross_entropy_derivative(neuron_context *context, matrix *target) {
 
 }
 
+// Loss is summed over neurons and averaged over samples,
+// derivative keeps the shifted prediction of cell derivative
+static
+float
+cross_entropy_layer(matrix *activation, matrix *target, matrix *error) {
+    cost_layer_check(activation, target, error);
+
+    float loss = 0;
+
+    matrix_foreach(activation) {
+        float predicted = MATRIX(activation, row, column);
+        float predicted_safe = predicted - 10e-5;
+        float expected = MATRIX(target, column, row);
+
+        MATRIX(error, row, column) = expected / predicted_safe * -1.
+                                   + (1. - expected) / (1. - predicted_safe);
+        loss += expected * log0(predicted);
+    }
+
+    return loss / activation->columns * -1.;
+
+error:
+    return 0;
+}
+
+// Soft max with cross entropy: loss is -y * log(p) with stable log soft max,
+// gradient of transfer is p - y. Error buffer holds log(p) until it's replaced
+static
+float
+cross_entropy_logits(matrix *transfer, matrix *target, matrix *error) {
+    cost_layer_check(transfer, target, error);
+    check(Activation.log_soft_max.layer(transfer, error), "Log soft max of transfer failed");
+
+    float loss = 0;
+
+    for(size_t neuron = 0; neuron < error->rows; neuron++) {
+        float *row = &MATRIX(error, neuron, 0);
+
+        for(size_t sample = 0; sample < error->columns; sample++) {
+            loss += MATRIX(target, sample, neuron) * row[sample];
+        }
+
+        simd_exp(row, row, error->columns);
+
+        for(size_t sample = 0; sample < error->columns; sample++) {
+            row[sample] -= MATRIX(target, sample, neuron);
+        }
+    }
+
+    return loss / error->columns * -1.;
+
+error:
+    return 0;
+}
+
 static
 float
 cost_loss_cross_entropy_vector(vector *predicted, vector *target) {
@@ -231,21 +324,21 @@ cost_loss_cross_entropy_vector_binary(vector *predicted, vector *target) {
 static
 vector *
 cost_loss_cross_entropy_vector_derivative(vector *predicted, vector *target) {
-    vector *predictedSafe = Vector.num.sub(Vector.copy(predicted), 10e-5);
-    vector *targetOverPredicted = Vector.num.mul(
-                                                Vector.div(Vector.copy(target),
+    vector *predictedSafe = Vector.vs.sub(Vector.copy(predicted), 10e-5);
+    vector *targetOverPredicted = Vector.vs.mul(
+                                                Vector.vv.div(Vector.copy(target),
                                                            predictedSafe),
                                                 -1.);
-    vector *oneMinusTarget = Vector.num.add(
-                                              Vector.num.mul(Vector.copy(target), -1.),
+    vector *oneMinusTarget = Vector.vs.add(
+                                              Vector.vs.mul(Vector.copy(target), -1.),
                                               1.);
-    vector *oneMinusPredicted = Vector.num.add(
-                                              Vector.num.mul(Vector.copy(predictedSafe), -1.),
+    vector *oneMinusPredicted = Vector.vs.add(
+                                              Vector.vs.mul(Vector.copy(predictedSafe), -1.),
                                               1.);
-    vector *oneMinusDivision = Vector.div(Vector.copy(oneMinusTarget), 
+    vector *oneMinusDivision = Vector.vv.div(Vector.copy(oneMinusTarget), 
                                           oneMinusPredicted);
     
-    vector *loss = Vector.add(Vector.copy(targetOverPredicted), 
+    vector *loss = Vector.vv.add(Vector.copy(targetOverPredicted), 
                               oneMinusDivision);
 
     // Garbage Control
@@ -16,6 +16,12 @@
 struct cost_library_function {
     float         (*of)(neuron_context *context, matrix *target);
     vector *      (*derivative)(neuron_context *context, matrix *target);
+    // Whole layer at once, activation and error are neurons x samples,
+    // target is samples x neurons. Error gets derivative, loss is returned
+    float         (*layer)(matrix *activation, matrix *target, matrix *error);
+    // Loss of soft max output taken from its transfer, error gets dE/dZ,
+    // so derivative of activation isn't applied. NULL when cost has none
+    float         (*logits)(matrix *transfer, matrix *target, matrix *error);
 };
 
 
@@ -6,21 +6,89 @@
 //  Copyright © 2018 alexander. All rights reserved.
 //
 
+#include <math.h>
 #include "optimization.h"
 
+/* Update rules, one fused loop over weight for each */
+enum optimization_rule {
+    RULE_SGD,
+    RULE_MOMENTUM,
+    RULE_NESTEROV,
+    RULE_RMS_PROP,
+    RULE_ADAM,
+    RULE_ADAM_W
+};
+
 static float *     optimization_sgd(void *_cell, float learning_rate, float* params);
+static float *     optimization_momentum(void *cell, float learning_rate, float *params);
+static float *     optimization_nesterov(void *cell, float learning_rate, float *params);
+static float *     optimization_rms_prop(void *cell, float learning_rate, float *params);
+static float *     optimization_adam(void *cell, float learning_rate, float *params);
+static float *     optimization_adam_w(void *cell, float learning_rate, float *params);
+static float *     optimization_cell_step(neural_cell *cell, float learning_rate, float *params, enum optimization_rule rule);
+
+static dense_layer * optimization_layer_sgd(dense_layer *layer, float learning_rate);
+static dense_layer * optimization_layer_momentum(dense_layer *layer, float learning_rate);
+static dense_layer * optimization_layer_nesterov(dense_layer *layer, float learning_rate);
+static dense_layer * optimization_layer_rms_prop(dense_layer *layer, float learning_rate);
+static dense_layer * optimization_layer_adam(dense_layer *layer, float learning_rate);
+static dense_layer * optimization_layer_adam_w(dense_layer *layer, float learning_rate);
+static dense_layer * optimization_layer_update(dense_layer *layer, float learning_rate, float weight_decay);
+static dense_layer * optimization_layer_step(dense_layer *layer, float learning_rate, enum optimization_rule rule, float weight_decay);
+
+static layer_optimization_function optimization_of(optimization_function optimization);
+static void        optimization_update(enum optimization_rule rule, float *restrict weight, const float *restrict gradient,
+                                       float *restrict moment, float *restrict velocity,
+                                       size_t size, float learning_rate, size_t step, float weight_decay);
 
 /* Library structure */
 const struct optimization_library Optimization = {
-    .sgd = optimization_sgd
+    .sgd = optimization_sgd,
+    .momentum = optimization_momentum,
+    .nesterov = optimization_nesterov,
+    .rms_prop = optimization_rms_prop,
+    .adam = optimization_adam,
+    .adam_w = optimization_adam_w,
+    .layer = {
+        .sgd = optimization_layer_sgd,
+        .momentum = optimization_layer_momentum,
+        .nesterov = optimization_layer_nesterov,
+        .rms_prop = optimization_layer_rms_prop,
+        .adam = optimization_layer_adam,
+        .adam_w = optimization_layer_adam_w
+    },
+    .update = optimization_layer_update,
+    .of = optimization_of
 };
 
+
+/* Macros */
+#define OPTIMIZATION_RULE(name, rule)                                                      \
+    static float *                                                                         \
+    optimization_##name(void *cell, float learning_rate, float *params) {                  \
+        return optimization_cell_step((neural_cell *)cell, learning_rate, params, rule);   \
+    }                                                                                      \
+                                                                                           \
+    static dense_layer *                                                                   \
+    optimization_layer_##name(dense_layer *layer, float learning_rate) {                   \
+        return optimization_layer_step(layer, learning_rate, rule,                         \
+                                       rule == RULE_ADAM_W ? OPTIMIZATION_WEIGHT_DECAY : 0); \
+    }
+
+OPTIMIZATION_RULE(momentum, RULE_MOMENTUM)
+OPTIMIZATION_RULE(nesterov, RULE_NESTEROV)
+OPTIMIZATION_RULE(rms_prop, RULE_RMS_PROP)
+OPTIMIZATION_RULE(adam, RULE_ADAM)
+OPTIMIZATION_RULE(adam_w, RULE_ADAM_W)
+
 // https://ml-cheatsheet.readthedocs.io/en/latest/backpropagation.html
 static
 void
 optimization_back_propagation(neural_cell *cell) {
     struct neuron_state *body = &cell->context->body;
     struct neuron_state *prime = &cell->context->prime;
+    // Nothing is pushed yet, pop only keeps current allocator
+    arena_mark scratch = { .previous = Arena.current() };
     
     // Let's begin backpropagating the error derivatives.
     // Eo = C'(O-y) * ... if output layer
@@ -29,6 +97,9 @@ optimization_back_propagation(neural_cell *cell) {
                             : Vector.copy(cell->context->prime.error);
     vector_check_print(base_error, "Base error (Eo) vector for back propagate is broken");
 
+    // Copies of front errors are temporaries
+    scratch = Arena.push(Arena.scratch());
+
     // Eo — error from the neurons in front
     size_t axon_dimension = 0;
     for(neural_cell *axon = cell->axon[0]; cell->axon[axon_dimension]; axon = cell->axon[axon_dimension]) {
@@ -42,17 +113,19 @@ optimization_back_propagation(neural_cell *cell) {
                 vector *front_error = Vector.copy(front_prime.error);
                 vector_check_print(front_error, "Error vector of front neuron %zdx%zd", axon->context->layer_index, axon->context->position);
                 // dE/dY = SUM(dX/dY * dE/dX)
-                front_error = Vector.num.mul(front_error, VECTOR(front_prime.transfer, index));
+                front_error = Vector.vs.mul(front_error, VECTOR(front_prime.transfer, index));
                 // Eo += En
-                base_error = Vector.add(base_error, front_error);
+                base_error = Vector.vv.add(base_error, front_error);
                 axon_dimension++;
 
-                free(front_error);
+                Vector.delete(front_error);
                 break;
             }
         }
     }
 
+    Arena.pop(scratch);
+
     // if(*cell->axon) {
     //     // Eo = SUM(En) / Number of cells in axon terminal
     //     check(axon_dimension, "Axon dimension is 0 when pointer to axon exists");
@@ -98,22 +171,24 @@ optimization_back_propagation(neural_cell *cell) {
     vector_check(activation_derivative);
 
     // E = Eo * R'(Z) * ... - current layer error
-    base_error = Vector.mul(base_error, activation_derivative);
+    base_error = Vector.vv.mul(base_error, activation_derivative);
    
     // Cost = Cost(Activation(Transfer(XW))) = C(R(Z(XW)))
     // C'(W) = C'(R) * R'(Z) * Z'(W) = E * Z'(X)
     matrix *cost_weight_prime = Matrix.copy(body->weight);
+    scratch = Arena.push(Arena.scratch());
     //#pragma omp parallel for
     for(size_t row = 0; row < cost_weight_prime->rows; row++) {
-        vector *row_prime = Matrix.column(transfer_derivative_over_signal, row);
-        for (size_t column = 0; column < (cost_weight_prime)->columns ; column++) {
-            vector *cw_prime = Vector.mul(Vector.copy(row_prime), base_error);
+        // Column of signal derivative is read in place
+        vector *row_prime = Matrix.slice.column(transfer_derivative_over_signal, row);
+        float cw_prime = Vector.dot(row_prime, base_error) / base_error->size;
 
-            MATRIX(cost_weight_prime, row, column) = Vector.sum.all(cw_prime) / cw_prime->size;
-            Vector.delete(cw_prime);
+        for (size_t column = 0; column < (cost_weight_prime)->columns ; column++) {
+            MATRIX(cost_weight_prime, row, column) = cw_prime;
         }
         Vector.delete(row_prime);
     }
+    Arena.pop(scratch);
     matrix_check(cost_weight_prime);
 
     // Garbage Control
@@ -136,50 +211,189 @@ optimization_back_propagation(neural_cell *cell) {
 
     return;
 error:
+    Arena.pop(scratch);
     return;
 }
 
+// W = W - learning_rate * dW, B = B - learning_rate * dB in place,
+// sgd keeps no state
 static float *
 optimization_sgd(void *_cell, float learning_rate, float *params)
 {
-    neural_cell *cell = (neural_cell *)_cell;
-    // x - input
-    // Eo - previous error
-    // m - number of examples
-    // W - weight
-    // dW - delta for weight update
-    // B - bias
-
-    // Eo
+    return optimization_cell_step((neural_cell *)_cell, learning_rate, params, RULE_SGD);
+}
+
+// State of cell is the count of steps, then moment and velocity of each
+// weight and of bias after them. dB is Eo averaged over samples
+static
+float *
+optimization_cell_step(neural_cell *cell, float learning_rate, float *params, enum optimization_rule rule) {
     optimization_back_propagation(cell);
     struct neuron_state *body = &cell->context->body;
     struct neuron_state *prime = &cell->context->prime;
 
-    // dW = x * Eo
-    // matrix *delta_weight = Matrix.mul(Matrix.copy(body->weight),
-    //                                   prime->weight);
-    matrix *delta_weight = Matrix.copy(prime->weight);
+    matrix_check(body->weight);
+    matrix_check(prime->weight);
+    vector_check(prime->error);
+    size_t size = body->weight->vector->size;
+    float weight_decay = rule == RULE_ADAM_W ? OPTIMIZATION_WEIGHT_DECAY : 0;
+    float bias_prime = Vector.sum.all(prime->error) / prime->error->size;
+    float *moment = NULL;
+    float *velocity = NULL;
+    size_t step = 0;
 
-    // dW = dW * learnin_rate
-    Vector.num.mul(delta_weight->vector, learning_rate);
-    
-    matrix_check(delta_weight);
+    if(rule != RULE_SGD) {
+        if(params == NULL) {
+            params = calloc(1 + 2 * (size + 1), sizeof(float));
+            check_memory(params);
+        }
 
+        params[0] += 1;
+        step = (size_t)params[0];
+        moment = params + 1;
+        velocity = params + 1 + size + 1;
+    }
 
-    // W = W - dW
-    body->weight = Matrix.sub(body->weight,
-                              delta_weight);
-    matrix_check(body->weight);
+    optimization_update(rule, body->weight->vector->values, prime->weight->vector->values,
+                        moment, velocity, size, learning_rate, step, weight_decay);
+    optimization_update(rule, &body->bias, &bias_prime,
+                        moment ? moment + size : NULL, velocity ? velocity + size : NULL,
+                        1, learning_rate, step, 0);
 
-    // B = B - Eo / m
-    // body->bias -= learning_rate
-    //                  * Vector.sum.all(prime->error) / prime->error->size;
+error:
+    return params;
+}
 
-    // Garbage Conrol
-    Matrix.delete(delta_weight);
+static
+dense_layer *
+optimization_layer_sgd(dense_layer *layer, float learning_rate) {
+    return optimization_layer_step(layer, learning_rate, RULE_SGD, 0);
+}
 
-    return params;
+// Fused SGD step with decay of weight, L2 of bias isn't decayed
+static
+dense_layer *
+optimization_layer_update(dense_layer *layer, float learning_rate, float weight_decay) {
+    return optimization_layer_step(layer, learning_rate, RULE_SGD, weight_decay);
+}
+
+// Weight and bias are one block, weight part is decayed. State lives
+// as long as weight, so it's never taken from arena
+static
+dense_layer *
+optimization_layer_step(dense_layer *layer, float learning_rate, enum optimization_rule rule, float weight_decay) {
+    arena_mark heap = Arena.push(NULL);
+    dense_layer_check(layer, "Optimization");
+    vector_check(layer->parameters);
+    vector_check(layer->gradient);
+
+    size_t size = layer->parameters->size;
+    size_t weights = layer->weight->vector->size;
+
+    if(rule != RULE_SGD && layer->moment == NULL) {
+        layer->moment = Vector.create(size);
+        layer->velocity = Vector.create(size);
+        vector_check(layer->moment);
+        vector_check(layer->velocity);
+
+        memset(layer->moment->values, 0, size * sizeof(float));
+        memset(layer->velocity->values, 0, size * sizeof(float));
+    }
+    Arena.pop(heap);
+
+    float *parameters = layer->parameters->values;
+    float *gradient = layer->gradient->values;
+    float *moment = layer->moment ? layer->moment->values : NULL;
+    float *velocity = layer->velocity ? layer->velocity->values : NULL;
+
+    layer->step++;
+    optimization_update(rule, parameters, gradient, moment, velocity,
+                        weights, learning_rate, layer->step, weight_decay);
+    optimization_update(rule, parameters + weights, gradient + weights,
+                        moment ? moment + weights : NULL, velocity ? velocity + weights : NULL,
+                        size - weights, learning_rate, layer->step, 0);
+
+    return layer;
 
 error:
+    Arena.pop(heap);
     return NULL;
 }
+
+static
+layer_optimization_function
+optimization_of(optimization_function optimization) {
+    if(optimization == optimization_sgd) {
+        return optimization_layer_sgd;
+    } else if(optimization == optimization_momentum) {
+        return optimization_layer_momentum;
+    } else if(optimization == optimization_nesterov) {
+        return optimization_layer_nesterov;
+    } else if(optimization == optimization_rms_prop) {
+        return optimization_layer_rms_prop;
+    } else if(optimization == optimization_adam) {
+        return optimization_layer_adam;
+    } else if(optimization == optimization_adam_w) {
+        return optimization_layer_adam_w;
+    }
+
+    return NULL;
+}
+
+// Moment is the running gradient, velocity the running squared gradient.
+// Adam corrects both for zero start, AdamW also shrinks weight itself
+static
+void
+optimization_update(enum optimization_rule rule, float *restrict weight, const float *restrict gradient,
+                    float *restrict moment, float *restrict velocity,
+                    size_t size, float learning_rate, size_t step, float weight_decay) {
+    // Decoupled decay is folded into the same pass over weight
+    float decay = 1 - learning_rate * weight_decay;
+
+    switch(rule) {
+        case RULE_SGD:
+            for(size_t index = 0; index < size; index++) {
+                weight[index] = weight[index] * decay - learning_rate * gradient[index];
+            }
+            break;
+
+        case RULE_MOMENTUM:
+            for(size_t index = 0; index < size; index++) {
+                moment[index] = OPTIMIZATION_MOMENTUM * moment[index] + gradient[index];
+                weight[index] = weight[index] * decay - learning_rate * moment[index];
+            }
+            break;
+
+        case RULE_NESTEROV:
+            for(size_t index = 0; index < size; index++) {
+                moment[index] = OPTIMIZATION_MOMENTUM * moment[index] + gradient[index];
+                weight[index] = weight[index] * decay
+                              - learning_rate * (gradient[index] + OPTIMIZATION_MOMENTUM * moment[index]);
+            }
+            break;
+
+        case RULE_RMS_PROP:
+            for(size_t index = 0; index < size; index++) {
+                velocity[index] = OPTIMIZATION_RMS_DECAY * velocity[index]
+                                + (1 - OPTIMIZATION_RMS_DECAY) * gradient[index] * gradient[index];
+                weight[index] = weight[index] * decay
+                              - learning_rate * gradient[index] / (sqrtf(velocity[index]) + OPTIMIZATION_EPSILON);
+            }
+            break;
+
+        case RULE_ADAM:
+        case RULE_ADAM_W: {
+            float step_size = learning_rate / (1 - powf(OPTIMIZATION_BETA1, step));
+            float correction = 1 / (1 - powf(OPTIMIZATION_BETA2, step));
+
+            for(size_t index = 0; index < size; index++) {
+                moment[index] = OPTIMIZATION_BETA1 * moment[index] + (1 - OPTIMIZATION_BETA1) * gradient[index];
+                velocity[index] = OPTIMIZATION_BETA2 * velocity[index]
+                                + (1 - OPTIMIZATION_BETA2) * gradient[index] * gradient[index];
+                weight[index] = weight[index] * decay
+                              - step_size * moment[index] / (sqrtf(velocity[index] * correction) + OPTIMIZATION_EPSILON);
+            }
+            break;
+        }
+    }
+}
@@ -11,9 +11,43 @@
 
 #include <stdio.h>
 #include "../cell.h"
+#include "../layer.h"
+
+/* Hyperparameters of stateful optimizers */
+#define OPTIMIZATION_MOMENTUM       0.9f
+#define OPTIMIZATION_RMS_DECAY      0.9f
+#define OPTIMIZATION_BETA1          0.9f
+#define OPTIMIZATION_BETA2          0.999f
+#define OPTIMIZATION_EPSILON        1e-8f
+#define OPTIMIZATION_WEIGHT_DECAY   0.01f
+
+typedef dense_layer * (*layer_optimization_function)(dense_layer *layer, float learning_rate);
 
 struct optimization_library {
     optimization_function  sgd;
+    // Cell keeps state of these in its context
+    optimization_function  momentum;
+    optimization_function  nesterov;
+    optimization_function  rms_prop;
+    optimization_function  adam;
+    // Adam with weight decay decoupled from gradient
+    optimization_function  adam_w;
+
+    // Dense layer counterparts, gradient of layer is already computed
+    struct {
+        layer_optimization_function sgd;
+        layer_optimization_function momentum;
+        layer_optimization_function nesterov;
+        layer_optimization_function rms_prop;
+        layer_optimization_function adam;
+        layer_optimization_function adam_w;
+    } layer;
+
+    // SGD of weight and bias in one pass, weight decays by 1 - learning_rate * weight_decay
+    dense_layer *               (*update)(dense_layer *layer, float learning_rate, float weight_decay);
+
+    // Layer counterpart of cell optimization, NULL when there is none
+    layer_optimization_function (*of)(optimization_function optimization);
 };
 
 extern const struct optimization_library Optimization;
@@ -10,6 +10,7 @@
 
 static vector *     transfer_linear_function(matrix *input, matrix *weight, float bias);
 static matrix *     transfer_linear_derivative(neuron_context *context, enum bool by_weight);
+static matrix *     transfer_linear_layer(matrix *signal, matrix *weight, vector *bias, matrix *transfer);
 
 
 /* Library structure */
@@ -17,6 +18,7 @@ const struct transfer_library Transfer = {
     .linear = {
         .function = transfer_linear_function,
         .derivative = transfer_linear_derivative,
+        .layer = transfer_linear_layer,
         
         .dimension = 1
     }
@@ -26,13 +28,17 @@ const struct transfer_library Transfer = {
 static
 vector *
 transfer_linear_function(matrix *input, matrix *weight, float bias) {
-    matrix *transfer_matrix = Matrix.mul(Matrix.copy(input), weight->vector);
-    Vector.num.add(transfer_matrix->vector, bias);
-    
-    vector *transfer = Vector.copy(transfer_matrix->vector);
-    Matrix.delete(transfer_matrix);
+    // Z = X * W + B, bias is written first and the product is added to it
+    vector *transfer = Vector.vs.add(Vector.create(input->rows), bias);
+    check_memory(transfer);
+
+    check(Matrix.mv.gemv(1, input, weight->vector, 1, transfer), "Transfer product failed");
     
     return transfer;
+
+error:
+    Vector.delete(transfer);
+    return NULL;
 }
 
 static
@@ -45,4 +51,30 @@ transfer_linear_derivative(neuron_context *context, enum bool by_weight) {
     }
 }
 
+// Z = W * X^T + B, one product for all neurons of layer
+static
+matrix *
+transfer_linear_layer(matrix *signal, matrix *weight, vector *bias, matrix *transfer) {
+    matrix_check(signal);
+    matrix_check(weight);
+    vector_check(bias);
+    matrix_check(transfer);
+    check(signal->columns == weight->columns, "Signal has %zd inputs, weight %zd", signal->columns, weight->columns);
+    check(transfer->rows == weight->rows && transfer->columns == signal->rows,
+          "Transfer %zdx%zd doesn't fit layer %zdx%zd", transfer->rows, transfer->columns, weight->rows, signal->rows);
+
+    for(size_t neuron = 0; neuron < transfer->rows; neuron++) {
+        float neuron_bias = VECTOR(bias, neuron);
 
+        for(size_t sample = 0; sample < transfer->columns; sample++) {
+            MATRIX(transfer, neuron, sample) = neuron_bias;
+        }
+    }
+
+    check(Matrix.gemm.abt(1, weight, signal, 1, transfer), "Layer product failed");
+
+    return transfer;
+
+error:
+    return NULL;
+}
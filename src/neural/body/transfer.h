@@ -16,6 +16,9 @@
 struct transfer_library_function{
     vector *          (*function)(matrix *input, matrix *weight, float bias);
     matrix *          (*derivative)(neuron_context *context, enum bool by_weight);
+    // Whole layer at once: transfer (neurons x samples) from signal (samples x inputs)
+    // and weight (neurons x inputs), written into preallocated transfer
+    matrix *          (*layer)(matrix *signal, matrix *weight, vector *bias, matrix *transfer);
     
     size_t            dimension;
 };
@@ -75,6 +75,8 @@ cell_create(neuron_kernel nucleus, size_t layer, size_t position) {
     
     context->layer_index = layer;
     context->position = position;
+    context->variables = NULL;
+    context->optimizer = NULL;
     
     context->prime = (struct neuron_state) {0};
     context->body = (struct neuron_state) {
@@ -107,8 +109,6 @@ cell_delete(neural_cell *cell) {
     free(cell->impulse_ready);
     free(cell->feedback_ready);
     free(cell);
-
-    *cell = (neural_cell){0};
 }
 
 /* Neuron context */
@@ -190,6 +190,7 @@ context_delete(neuron_context *context) {
     free(context->layer.transfer);
     free(context->layer.activation);
     free(context->layer.error);
+    free(context->optimizer);
     free(context);
 }
 
@@ -200,6 +201,9 @@ neural_cell *
 fire(neural_cell *cell, matrix *data) {
     neuron_ccheck(cell, "Argument Cell");
 
+    // State of cells lives between fires, so it's kept out of arena
+    arena_mark heap = Arena.push(NULL);
+
     set_signal(cell, data);
     init_weight(cell);
     
@@ -212,6 +216,8 @@ fire(neural_cell *cell, matrix *data) {
         memset(cell->impulse_ready, 0, cell->context->body.signal->columns * sizeof(enum bool));
     }
 
+    Arena.pop(heap);
+
     return cell;
 
 error:
@@ -303,8 +309,7 @@ collect_synapse_signal(neural_cell *cell) {
         dimension++;
     }
 
-    size_t bunch_size = impulse[0]->size;
-    matrix *signal = Matrix.transpose(Matrix.from(impulse, dimension, bunch_size));
+    matrix *signal = Matrix.columns(impulse, dimension);
     matrix_check_print(signal, "Signal from bunch of vectors");
     
     free(impulse);
@@ -420,10 +425,13 @@ neural_cell *
 activation(neural_cell *cell) {
     struct neuron_state *body = &cell->context->body;
     neuron_kernel *kernel = &cell->nucleus;
+    arena_mark heap = Arena.push(NULL);
  
     vector *activation = kernel->activation.of(cell->context);
     Vector.delete(body->activation);
     body->activation = activation;
+
+    Arena.pop(heap);
     
     cell->activated = true;
     
@@ -26,9 +26,10 @@
         check((cell), "Out of memory. " message, ##__VA_ARGS__);             \
     }
 
+// Walk over cells is validation, release build checks only the array
 #define neurons_check(array, message, ...)        \
     check((array), "Out of memory. " message, ##__VA_ARGS__);                                 \
-    for (size_t index = 0; array[index]; index++) \
+    for (size_t index = 0; VALIDATION && array[index]; index++) \
     neuron_ccheck(array[index], "Neuron %zd is broken. " message, index, ##__VA_ARGS__)
 #define NEURON(n_network, layer, position) **((n_network)->neurons + Network.get.neuron(n_network, layer, position))
 
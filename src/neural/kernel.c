@@ -0,0 +1,143 @@
+//
+//  kernel.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include "kernel.h"
+
+// Order of lists is the numbering, number is position plus one
+#define KERNEL_TRANSFERS        Transfer.linear
+#define KERNEL_SUMMATIONS       Aggregation.sum, Aggregation.average, Aggregation.mean, Aggregation.mediana
+#define KERNEL_ACTIVATIONS      Activation.sigmoid, Activation.tanh, Activation.soft_sign, Activation.heaviside_step, \
+                                Activation.soft_plus, Activation.soft_max, Activation.log_soft_max, Activation.relu,  \
+                                Activation.leaky_relu, Activation.elu, Activation.transparent
+#define KERNEL_COSTS            Cost.mean_squared, Cost.cross_entropy
+#define KERNEL_OPTIMIZATIONS    Optimization.sgd, Optimization.momentum, Optimization.nesterov, \
+                                Optimization.rms_prop, Optimization.adam, Optimization.adam_w
+
+#define KERNEL_COUNT(list) (sizeof(list) / sizeof(list[0]))
+
+// Functions are compared by pointer, activations without
+// implementation share NULL and have no number
+#define KERNEL_FIND(list, key, field)                                    \
+    for(uint32_t index = 0; index < KERNEL_COUNT(list); index++) {       \
+        if(list[index]field && list[index]field == (key)field) {         \
+            return index + 1;                                            \
+        }                                                                \
+    }                                                                    \
+    return 0;
+
+#define KERNEL_TAKE(list, id, slot) {                                    \
+    check((id) <= KERNEL_COUNT(list), "Unknown kernel function %u", (unsigned)(id)); \
+    if(id) {                                                             \
+        slot = list[(id) - 1];                                           \
+    }                                                                    \
+}
+
+static enum bool            kernel_id_of(neuron_kernel *kernel, kernel_id *id);
+static enum bool            kernel_of(kernel_id id, neuron_kernel *kernel);
+
+static uint32_t             transfer_id(struct transfer_library_function transfer);
+static uint32_t             summation_id(float (*summation)(vector *transfer));
+static uint32_t             activation_id(struct activation_library_function activation);
+static uint32_t             cost_id(struct cost_library_function cost);
+static uint32_t             optimization_id(optimization_function optimization);
+
+
+/* Library Structure */
+const struct kernel_library Kernel = {
+    .id = kernel_id_of,
+    .of = kernel_of
+};
+
+
+/* Numbers */
+static
+enum bool
+kernel_id_of(neuron_kernel *kernel, kernel_id *id) {
+    *id = (kernel_id){
+        .transfer = transfer_id(kernel->transfer),
+        .summation = summation_id(kernel->summation),
+        .activation = activation_id(kernel->activation),
+        .error = cost_id(kernel->error),
+        .optimization = optimization_id(kernel->optimization)
+    };
+
+    check(id->transfer || kernel->transfer.function == NULL, "Transfer has no number");
+    check(id->summation || kernel->summation == NULL, "Summation has no number");
+    check(id->activation || kernel->activation.of == NULL, "Activation has no number");
+    check(id->error || kernel->error.of == NULL, "Cost has no number");
+    check(id->optimization || kernel->optimization == NULL, "Optimization has no number");
+
+    return true;
+
+error:
+    return false;
+}
+
+// Missing functions stay NULL
+static
+enum bool
+kernel_of(kernel_id id, neuron_kernel *kernel) {
+    struct transfer_library_function transfers[] = { KERNEL_TRANSFERS };
+    float (*summations[])(vector *) = { KERNEL_SUMMATIONS };
+    struct activation_library_function activations[] = { KERNEL_ACTIVATIONS };
+    struct cost_library_function costs[] = { KERNEL_COSTS };
+    optimization_function optimizations[] = { KERNEL_OPTIMIZATIONS };
+
+    *kernel = (neuron_kernel){ 0 };
+    KERNEL_TAKE(transfers, id.transfer, kernel->transfer);
+    KERNEL_TAKE(summations, id.summation, kernel->summation);
+    KERNEL_TAKE(activations, id.activation, kernel->activation);
+    KERNEL_TAKE(costs, id.error, kernel->error);
+    KERNEL_TAKE(optimizations, id.optimization, kernel->optimization);
+    check(kernel->transfer.function && kernel->activation.of, "Kernel %u/%u can't fire", id.transfer, id.activation);
+
+    return true;
+
+error:
+    return false;
+}
+
+static
+uint32_t
+transfer_id(struct transfer_library_function transfer) {
+    struct transfer_library_function transfers[] = { KERNEL_TRANSFERS };
+
+    KERNEL_FIND(transfers, transfer, .function)
+}
+
+static
+uint32_t
+summation_id(float (*summation)(vector *transfer)) {
+    float (*summations[])(vector *) = { KERNEL_SUMMATIONS };
+
+    KERNEL_FIND(summations, summation, )
+}
+
+static
+uint32_t
+activation_id(struct activation_library_function activation) {
+    struct activation_library_function activations[] = { KERNEL_ACTIVATIONS };
+
+    KERNEL_FIND(activations, activation, .of)
+}
+
+static
+uint32_t
+cost_id(struct cost_library_function cost) {
+    struct cost_library_function costs[] = { KERNEL_COSTS };
+
+    KERNEL_FIND(costs, cost, .of)
+}
+
+static
+uint32_t
+optimization_id(optimization_function optimization) {
+    optimization_function optimizations[] = { KERNEL_OPTIMIZATIONS };
+
+    KERNEL_FIND(optimizations, optimization, )
+}
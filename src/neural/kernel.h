@@ -0,0 +1,38 @@
+//
+//  kernel.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef kernel_h
+#define kernel_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include "cell.h"
+#include "body/optimization.h"
+
+/* Stable number of each library function of neuron kernel, so kernel is
+   kept in files. Zero is missing function, new ones are appended */
+typedef struct {
+    uint32_t    transfer;
+    uint32_t    summation;
+    uint32_t    activation;
+    uint32_t    error;
+    uint32_t    optimization;
+} kernel_id;
+
+
+/* Library methods */
+struct kernel_library {
+    // False when kernel has function without number
+    enum bool           (*id)(neuron_kernel *kernel, kernel_id *id);
+    // False when number has no function or kernel can't fire without it
+    enum bool           (*of)(kernel_id id, neuron_kernel *kernel);
+};
+
+extern const struct kernel_library Kernel;
+
+#endif /* kernel_h */
@@ -0,0 +1,496 @@
+//
+//  layer.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include "layer.h"
+
+static dense_layer *        layer_create(neural_cell **cells, size_t inputs);
+static dense_layer *        layer_replicate(dense_layer *layer);
+static void                 layer_delete(dense_layer *layer);
+
+static dense_layer *        layer_shape(dense_layer *layer, size_t inputs, size_t samples);
+static dense_layer *        layer_assign(dense_layer *layer, float *parameters, enum bool view);
+static matrix *             layer_fire(dense_layer *layer, matrix *signal, enum bool transposed);
+static matrix *             layer_activation(dense_layer *layer);
+static float                layer_loss(dense_layer *layer, matrix *target);
+static dense_layer *        layer_back_propagate(dense_layer *layer, matrix *previous_error);
+static matrix *             layer_activation_derivative(dense_layer *layer);
+
+static matrix *             layer_buffer(matrix *buffer, size_t rows, size_t columns, enum bool grow);
+static vector *             layer_block(size_t dimension, size_t inputs, matrix **weight, vector **bias);
+static void                 layer_bind(dense_layer *layer);
+static void                 bind_vector(vector **slot, float *values, size_t size);
+static void                 bind_matrix(matrix **slot, float *values, size_t rows, size_t columns);
+
+
+/* Library Structure */
+const struct layer_library Layer = {
+    .create = layer_create,
+    .replicate = layer_replicate,
+    .delete = layer_delete,
+
+    .shape = layer_shape,
+    .assign = layer_assign,
+    .fire = layer_fire,
+    .loss = layer_loss,
+    .back_propagate = layer_back_propagate
+};
+
+
+/* Life Cycle */
+static
+dense_layer *
+layer_create(neural_cell **cells, size_t inputs) {
+    dense_layer *layer = calloc(1, sizeof(dense_layer));
+    arena_mark heap = Arena.push(NULL);
+    check_memory(layer);
+    neurons_check(cells, "Cells for dense layer");
+    check(*cells, "Dense layer without cells");
+
+    while(cells[layer->dimension]) {
+        layer->dimension++;
+    }
+
+    layer->cells = cells;
+    layer->kernel = cells[0]->nucleus;
+    layer->bias = Vector.create(layer->dimension);
+
+    // Width of network input is known only when first signal comes
+    if(inputs) {
+        layer_shape(layer, inputs, 1);
+    }
+
+    Arena.pop(heap);
+
+    return layer;
+
+error:
+    Arena.pop(heap);
+    free(layer);
+    return NULL;
+}
+
+// Replica is shaped by its own fire, weight prime is the only buffer
+// known before that
+static
+dense_layer *
+layer_replicate(dense_layer *layer) {
+    dense_layer *replica = NULL;
+    arena_mark heap = Arena.push(NULL);
+    dense_layer_check(layer, "Replicate");
+    check(layer->weight, "Layer without weight can't be replicated");
+
+    replica = calloc(1, sizeof(dense_layer));
+    check_memory(replica);
+
+    replica->kernel = layer->kernel;
+    replica->cells = layer->cells;
+    replica->dimension = layer->dimension;
+    replica->inputs = layer->inputs;
+    replica->weight = layer->weight;
+    replica->bias = layer->bias;
+    replica->origin = layer->origin ? layer->origin : layer;
+
+    replica->gradient = layer_block(layer->dimension, layer->inputs, &replica->weight_prime, &replica->bias_prime);
+    check_memory(replica->gradient);
+
+    Arena.pop(heap);
+
+    return replica;
+
+error:
+    Arena.pop(heap);
+    free(replica);
+    return NULL;
+}
+
+static
+void
+layer_delete(dense_layer *layer) {
+    dense_layer_check(layer, "Delete");
+
+    if(layer->origin) {
+        Matrix.delete(layer->weight_prime);
+        Vector.delete(layer->bias_prime);
+        Vector.delete(layer->gradient);
+        if(layer->samples) {
+            Matrix.delete(layer->signal);
+            Matrix.delete(layer->transfer);
+            Matrix.delete(layer->activation);
+            Matrix.delete(layer->error);
+            Matrix.delete(layer->prime);
+        }
+        free(layer);
+
+        return;
+    }
+
+    if(layer->weight) {
+        Matrix.delete(layer->weight);
+        Vector.delete(layer->parameters);
+        Matrix.delete(layer->signal);
+        Matrix.delete(layer->transfer);
+        Matrix.delete(layer->activation);
+        Matrix.delete(layer->weight_prime);
+        Vector.delete(layer->bias_prime);
+        Vector.delete(layer->gradient);
+        Matrix.delete(layer->error);
+        Matrix.delete(layer->prime);
+        if(layer->moment) {
+            Vector.delete(layer->moment);
+            Vector.delete(layer->velocity);
+        }
+    }
+    // View of parameters or own vector of layer which wasn't shaped
+    Vector.delete(layer->bias);
+
+    free(layer->cells);
+    free(layer);
+
+error:
+    return;
+}
+
+
+/* Buffers */
+// Buffers keep memory of the biggest batch, smaller batches reuse it.
+// They live as long as layer, so they never come from arena
+static
+dense_layer *
+layer_shape(dense_layer *layer, size_t inputs, size_t samples) {
+    arena_mark heap = Arena.push(NULL);
+    dense_layer_check(layer, "Shape");
+    check(inputs && samples, "Layer shape %zdx%zd is empty", inputs, samples);
+    check(layer->inputs == 0 || layer->inputs == inputs,
+          "Layer has %zd inputs, signal has %zd", layer->inputs, inputs);
+
+    if(layer->weight == NULL) {
+        vector *bias = layer->bias;
+
+        layer->inputs = inputs;
+        layer->parameters = layer_block(layer->dimension, inputs, &layer->weight, &layer->bias);
+        layer->gradient = layer_block(layer->dimension, inputs, &layer->weight_prime, &layer->bias_prime);
+        check_memory(layer->parameters);
+        check_memory(layer->gradient);
+
+        Matrix.seed(layer->weight, 0);
+        memcpy(layer->bias->values, bias->values, layer->dimension * sizeof(float));
+        Vector.delete(bias);
+    }
+
+    if(layer->samples != samples) {
+        enum bool grow = samples > layer->capacity;
+
+        layer->signal = layer_buffer(layer->signal, samples, inputs, grow);
+        layer->transfer = layer_buffer(layer->transfer, layer->dimension, samples, grow);
+        layer->activation = layer_buffer(layer->activation, layer->dimension, samples, grow);
+        layer->error = layer_buffer(layer->error, layer->dimension, samples, grow);
+        layer->prime = layer_buffer(layer->prime, layer->dimension, samples, grow);
+        check_memory(layer->signal);
+        check_memory(layer->transfer);
+        check_memory(layer->activation);
+        check_memory(layer->error);
+        check_memory(layer->prime);
+
+        if(grow) {
+            layer->capacity = samples;
+        }
+        layer->samples = samples;
+    }
+
+    if(layer->origin == NULL) {
+        layer_bind(layer);
+    }
+    Arena.pop(heap);
+
+    return layer;
+
+error:
+    Arena.pop(heap);
+    return NULL;
+}
+
+// Weight and bias views are moved to viewed block, cells are bound again
+// to take bias which they keep by value
+static
+dense_layer *
+layer_assign(dense_layer *layer, float *parameters, enum bool view) {
+    dense_layer_check(layer, "Assign");
+    check(layer->weight && layer->origin == NULL, "Only shaped layer takes parameters");
+    check_memory(parameters);
+
+    if(view) {
+        check(layer->moment == NULL, "Optimizer state of layer belongs to its parameters");
+
+        vector *block = Vector.view(parameters, layer->parameters->size);
+        check_memory(block);
+        Vector.delete(layer->parameters);
+        layer->parameters = block;
+
+        layer->weight->vector->values = parameters;
+        layer->bias->values = parameters + layer->dimension * layer->inputs;
+    } else {
+        memcpy(layer->parameters->values, parameters, layer->parameters->size * sizeof(float));
+    }
+
+    layer_bind(layer);
+
+    return layer;
+
+error:
+    return NULL;
+}
+
+// Block of dimension x inputs weight followed by dimension bias
+static
+vector *
+layer_block(size_t dimension, size_t inputs, matrix **weight, vector **bias) {
+    vector *block = Vector.create(dimension * (inputs + 1));
+    check_memory(block);
+    memset(block->values, 0, block->size * sizeof(float));
+
+    *weight = Matrix.view(block->values, dimension, inputs);
+    *bias = Vector.view(block->values + dimension * inputs, dimension);
+    check_memory(*weight);
+    check_memory(*bias);
+
+    return block;
+
+error:
+    Vector.delete(block);
+    return NULL;
+}
+
+static
+matrix *
+layer_buffer(matrix *buffer, size_t rows, size_t columns, enum bool grow) {
+    if(buffer == NULL) {
+        return Matrix.create(rows, columns);
+    }
+
+    if(grow) {
+        return Matrix.reshape(buffer, rows, columns);
+    }
+
+    buffer->rows = rows;
+    buffer->columns = columns;
+    buffer->stride = columns;
+    buffer->vector->size = rows * columns;
+
+    return buffer;
+}
+
+// Cells state points to rows of layer buffers, so cell kernels
+// keep working with the values computed for whole layer
+static
+void
+layer_bind(dense_layer *layer) {
+    for(size_t position = 0; position < layer->dimension; position++) {
+        struct neuron_state *body = &layer->cells[position]->context->body;
+        float *weight = &MATRIX(layer->weight, position, 0);
+
+        // Weight was set to cell directly, move it to the layer with bias.
+        // Otherwise layer trains bias and cell keeps a copy of it
+        if(body->weight->vector->view == false) {
+            size_t rows = body->weight->vector->size < layer->inputs
+                        ? body->weight->vector->size
+                        : layer->inputs;
+
+            memcpy(weight, body->weight->vector->values, rows * sizeof(float));
+            VECTOR(layer->bias, position) = body->bias;
+        } else {
+            body->bias = VECTOR(layer->bias, position);
+        }
+
+        bind_matrix(&body->weight, weight, layer->inputs, 1);
+
+        if(layer->samples) {
+            bind_matrix(&body->signal, layer->signal->vector->values, layer->samples, layer->inputs);
+            bind_vector(&body->transfer, &MATRIX(layer->transfer, position, 0), layer->samples);
+            bind_vector(&body->activation, &MATRIX(layer->activation, position, 0), layer->samples);
+        }
+    }
+}
+
+static
+void
+bind_vector(vector **slot, float *values, size_t size) {
+    if(*slot && (*slot)->view) {
+        (*slot)->values = values;
+        (*slot)->size = size;
+
+        return;
+    }
+
+    Vector.delete(*slot);
+    *slot = Vector.view(values, size);
+}
+
+static
+void
+bind_matrix(matrix **slot, float *values, size_t rows, size_t columns) {
+    if(*slot && (*slot)->vector->view) {
+        (*slot)->rows = rows;
+        (*slot)->columns = columns;
+        (*slot)->stride = columns;
+        bind_vector(&(*slot)->vector, values, rows * columns);
+
+        return;
+    }
+
+    Matrix.delete(*slot);
+    *slot = Matrix.view(values, rows, columns);
+}
+
+
+/* Layer Firing */
+// Signal is samples x inputs, or inputs x samples when transposed
+// (activation of previous layer)
+static
+matrix *
+layer_fire(dense_layer *layer, matrix *signal, enum bool transposed) {
+    dense_layer_check(layer, "Fire");
+    matrix_check_print(signal, "For layer fire");
+
+    size_t samples = transposed ? signal->columns : signal->rows;
+    size_t inputs = transposed ? signal->rows : signal->columns;
+
+    check(layer_shape(layer, inputs, samples), "Layer can't take %zdx%zd signal", samples, inputs);
+
+    if(transposed) {
+        check(Matrix.transposed(signal, layer->signal), "Signal isn't transposed");
+    } else {
+        // Block view of wider matrix is copied by rows of its stride
+        for(size_t row = 0; row < signal->rows; row++) {
+            memcpy(&MATRIX(layer->signal, row, 0), &MATRIX(signal, row, 0), signal->columns * sizeof(float));
+        }
+    }
+
+    check(layer->kernel.transfer.layer(layer->signal, layer->weight, layer->bias, layer->transfer),
+          "Layer transfer failed");
+
+    return layer_activation(layer);
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+layer_activation(dense_layer *layer) {
+    neuron_kernel *kernel = &layer->kernel;
+
+    layer->primed = layer->training && kernel->activation.fused;
+    if(layer->primed) {
+        return kernel->activation.fused(layer->transfer, layer->activation, layer->prime);
+    }
+
+    if(kernel->activation.layer) {
+        return kernel->activation.layer(layer->transfer, layer->activation);
+    }
+
+    // Kernel knows only about single neuron
+    for(size_t position = 0; position < layer->dimension; position++) {
+        vector *activation = kernel->activation.of(layer->cells[position]->context);
+        vector_check_print(activation, "Activation of cell %zd", position);
+
+        memcpy(&MATRIX(layer->activation, position, 0), activation->values, layer->samples * sizeof(float));
+        Vector.delete(activation);
+    }
+
+    return layer->activation;
+
+error:
+    return NULL;
+}
+
+
+// Soft max output with cost of logits skips derivative of activation,
+// error of transfer is computed with loss in one stable pass
+static
+float
+layer_loss(dense_layer *layer, matrix *target) {
+    dense_layer_check(layer, "Loss");
+    struct cost_library_function *cost = &layer->kernel.error;
+
+    layer->delta = cost->logits && layer->kernel.activation.layer == Activation.soft_max.layer;
+    if(layer->delta) {
+        return cost->logits(layer->transfer, target, layer->error);
+    }
+
+    return cost->layer(layer->activation, target, layer->error);
+
+error:
+    return 0;
+}
+
+
+/* Back Propagation */
+// dE/dZ = dE/dA * A'(Z), dE/dW = dE/dZ * X / samples, dE/dX = W^T * dE/dZ,
+// dE/dB is dE/dZ of neuron averaged over samples.
+// Previous error is taken before weight is updated, all buffers are
+// allocated by shape, so the step itself doesn't touch allocator
+static
+dense_layer *
+layer_back_propagate(dense_layer *layer, matrix *previous_error) {
+    dense_layer_check(layer, "Back propagate");
+    check(layer->samples, "Layer wasn't fired before back propagation");
+
+    if(layer->delta == false) {
+        matrix *prime = layer_activation_derivative(layer);
+        check(prime, "Activation derivative of layer failed");
+
+        vector_foreach(layer->error->vector) {
+            VECTOR(layer->error->vector, index) *= VECTOR(prime->vector, index);
+        }
+    }
+    layer->delta = false;
+
+    check(Matrix.gemm.ab(1. / layer->samples, layer->error, layer->signal, 0, layer->weight_prime),
+          "Weight prime of layer failed");
+
+    for(size_t neuron = 0; neuron < layer->dimension; neuron++) {
+        VECTOR(layer->bias_prime, neuron) = simd_sum(&MATRIX(layer->error, neuron, 0), layer->samples) / layer->samples;
+    }
+
+    if(previous_error) {
+        check(Matrix.gemm.atb(1, layer->weight, layer->error, 0, previous_error),
+              "Error of previous layer failed");
+    }
+
+    return layer;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+layer_activation_derivative(dense_layer *layer) {
+    neuron_kernel *kernel = &layer->kernel;
+
+    if(layer->primed) {
+        return layer->prime;
+    }
+
+    if(kernel->activation.layer_derivative) {
+        return kernel->activation.layer_derivative(layer->transfer, layer->activation, layer->prime);
+    }
+
+    for(size_t position = 0; position < layer->dimension; position++) {
+        vector *prime = kernel->activation.derivative(layer->cells[position]->context);
+        vector_check_print(prime, "Activation derivative of cell %zd", position);
+
+        memcpy(&MATRIX(layer->prime, position, 0), prime->values, layer->samples * sizeof(float));
+        Vector.delete(prime);
+    }
+
+    return layer->prime;
+
+error:
+    return NULL;
+}
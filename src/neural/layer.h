@@ -0,0 +1,96 @@
+//
+//  layer.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef layer_h
+#define layer_h
+
+#include <stdio.h>
+#include "cell.h"
+
+/* Macros */
+#define dense_layer_check(layer, message, ...) {                                               \
+    check_memory_print(layer, message, ##__VA_ARGS__);                                           \
+    neurons_check((layer)->cells, "Layer cells are broken. " message, ##__VA_ARGS__);           \
+    check_valid((layer)->dimension, "Layer dimension doesn't set. " message, ##__VA_ARGS__);    \
+}
+
+/* Cells of one layer routed to every cell of previous layer,
+   fired at once with one dense weight matrix for all samples */
+typedef struct dense_layer {
+    neuron_kernel       kernel;
+    neural_cell **      cells;
+
+    size_t              dimension;
+    size_t              inputs;
+    size_t              samples;
+    size_t              capacity;
+
+    // Neurons x inputs, row of each neuron is its weight
+    matrix *            weight;
+    vector *            bias;
+    // Weight and then bias in one block, both are views of it,
+    // so all parameters are updated by one pass
+    vector *            parameters;
+
+    // Samples x inputs, shared by cells as their signal
+    matrix *            signal;
+
+    // Neurons x samples, row of each neuron is its transfer and activation
+    matrix *            transfer;
+    matrix *            activation;
+
+    // Gradient buffers of back propagation, allocated with the buffers above:
+    // error is dE/dA then dE/dZ and prime is A'(Z), both neurons x samples,
+    // weight prime is dE/dW, neurons x inputs, bias prime is dE/dB.
+    // Both are views of gradient, laid out as parameters
+    matrix *            error;
+    matrix *            prime;
+    matrix *            weight_prime;
+    vector *            bias_prime;
+    vector *            gradient;
+
+    // State of stateful optimizer, one value for each parameter. Allocated
+    // by its first step and kept with weight, step counts the updates
+    vector *            moment;
+    vector *            velocity;
+    size_t              step;
+
+    // Fire of training layer writes prime with activation in one pass,
+    // primed while prime belongs to the last fire
+    enum bool           training;
+    enum bool           primed;
+    // Error is already dE/dZ, loss was taken from transfer
+    enum bool           delta;
+
+    // Layer which weight and bias are shared by replica, NULL for layer itself.
+    // Replica has own buffers and doesn't bind cells, so it can be fired
+    // by other thread with part of samples
+    struct dense_layer *origin;
+} dense_layer;
+
+
+/* Layer library methods */
+struct layer_library {
+    dense_layer *        (*create)(neural_cell **cells, size_t inputs);
+    dense_layer *        (*replicate)(dense_layer *layer);
+    void                 (*delete)(dense_layer *layer);
+
+    dense_layer *        (*shape)(dense_layer *layer, size_t inputs, size_t samples);
+    // Shaped layer takes weight and bias from block laid out as parameters.
+    // Viewed block isn't copied and belongs to the caller
+    dense_layer *        (*assign)(dense_layer *layer, float *parameters, enum bool view);
+    matrix *             (*fire)(dense_layer *layer, matrix *signal, enum bool transposed);
+    // Loss of fired output layer, its error gets the derivative of loss
+    float                (*loss)(dense_layer *layer, matrix *target);
+    // Error of layer is set, previous error (inputs x samples) gets W^T * dE/dZ
+    dense_layer *        (*back_propagate)(dense_layer *layer, matrix *previous_error);
+};
+
+extern const struct layer_library Layer;
+
+#endif /* layer_h */
@@ -6,25 +6,78 @@
 //  Copyright © 2018 alexander. All rights reserved.
 //
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "network.h"
+#include "router.h"
+#include "../math/gemm.h"
+#include "../util/file.h"
 #define NETWORK(network, layer, position) (network)->state[(int)Network.neuron(network, layer, position)]
+#define NETWORK_FILE_ALIGN(offset) (((offset) + NETWORK_FILE_ALIGNMENT - 1) & ~(uint64_t)(NETWORK_FILE_ALIGNMENT - 1))
+
+/* Data parallel training, each worker takes its rows of batch
+   through own replicas of layers */
+typedef struct {
+    dense_layer **      layers;
+    // Views of worker rows in batch
+    matrix *            signal;
+    matrix *            target;
+
+    size_t              samples;
+    float               error;
+    size_t              predicted;
+    enum bool           failed;
+} training_worker;
+
+typedef struct {
+    neural_network *    network;
+    thread_pool *       pool;
+    training_worker *   workers;
+
+    matrix *            signal;
+    matrix *            target;
+} data_parallel;
 
 static neural_network       create(neural_layer layers[]);
 static void                 delete(neural_network *network);
 
 static matrix *             fire(neural_network *network, matrix *signal);
 static matrix *             axon(neural_network *network);
+static matrix *             layers_fire(neural_network *network, matrix *signal);
 static size_t               get_neuron_position(neural_network *network, size_t layer, size_t position);
 static neural_cell **       get_layer_cells(neural_network *network, size_t layer);
 static float                compute_error(neural_network *network, matrix *signal, matrix *target);
 static float                accuracy(neural_network *network,matrix *target);
 static void                 cell_back_propagation(neural_cell *cell, float learning_rate);
 static enum bool            neuron_error_impulse(neural_cell *source, neural_cell *destination);
-static void                 train(neural_network *network, data_batch *training_data, float learning_rate, int epoch);
+static void                 train(neural_network *network, data_batch *training_data, float learning_rate, int epoch, size_t threads);
 static float                back_propagation(neural_network *network, matrix *signal, matrix *target, float learning_rate);
+static float                layers_error(neural_network *network, matrix *signal, matrix *target);
+static float                layers_accuracy(neural_network *network, matrix *target);
+static float                layers_back_propagation(neural_network *network, matrix *signal, matrix *target, float learning_rate);
+static layer_optimization_function layer_optimization(dense_layer *layer);
+static enum bool            is_layers_trainable(neural_network *network);
+static size_t               layers_predicted(matrix *activation, matrix *target);
+static void                 reserve_layers(neural_network *network, data_batch *training_data);
+static size_t               biggest_batch(data_batch *training_data);
+static dense_layer **       shape_layers(neural_network *network, dense_layer **layers, size_t inputs, size_t samples);
+static data_parallel *      parallel_create(neural_network *network, data_batch *training_data, size_t threads);
+static void                 parallel_delete(data_parallel *parallel);
+static float                parallel_back_propagation(data_parallel *parallel, matrix *signal, matrix *target, float learning_rate, float *accuracy);
+static void                 parallel_step(void *context, size_t index, size_t workers);
+static void                 parallel_reduce(void *context, size_t index, size_t workers);
+static void                 parallel_release(void *context, size_t index, size_t workers);
+static void                 bind_rows(matrix *view, matrix *source, size_t row, size_t rows);
 static neural_network *     seed_next_layer(neural_network *network, neural_layer *layer);
 static neural_network *     route(neural_network *network, neural_layer layers[]);
 static void                 __build_cell_context(neural_network *network);
+static void                 __build_dense_layers(neural_network *network);
+static enum bool            is_dense_layer(neural_cell **cells, neural_cell **previous_cells);
+static enum bool            save(neural_network *network, char *filename);
+static neural_network       load(char *filename, enum bool mapped);
+static inference_plan *     freeze(neural_network *network, size_t capacity);
 
 /* Library Structure */
 const struct network_library Network = {
@@ -36,7 +89,10 @@ const struct network_library Network = {
         .neuron = get_neuron_position,
         .layer = get_layer_cells
     },
-    .error = compute_error
+    .error = compute_error,
+    .save = save,
+    .load = load,
+    .freeze = freeze
 };
 
 #define NETWORK_LAST_LAYER(network) \
@@ -55,8 +111,10 @@ create(neural_layer layers[]) {
             .size = 0
         },
         .neurons = malloc(sizeof(neural_cell*)),
+        .layers = NULL,
         .history = NULL 
     };
+    arena_mark heap = Arena.push(NULL);
         
     size_t layer_index = 0;
     
@@ -66,6 +124,9 @@ create(neural_layer layers[]) {
         
     route(&network, layers);   
     __build_cell_context(&network);
+    __build_dense_layers(&network);
+
+    Arena.pop(heap);
     
     return network;
 }
@@ -73,11 +134,24 @@ create(neural_layer layers[]) {
 static 
 void
 delete(neural_network *network) {
-    free(network->resolution.dimensions);
     for (size_t index = 0; index < network->resolution.size; index++) {
         Neuron.delete(network->neurons[index]);
     }
     free(network->neurons);
+
+    if(network->layers) {
+        for(size_t layer = 0; layer < network->resolution.layers; layer++) {
+            Layer.delete(network->layers[layer]);
+        }
+        free(network->layers);
+    }
+    free(network->resolution.dimensions);
+    free(network->history);
+
+    if(network->mapping.address) {
+        munmap(network->mapping.address, network->mapping.size);
+        close(network->mapping.file);
+    }
 }
 
 /* Init layer neural cell instances */
@@ -139,6 +213,83 @@ error:
     return;
 }
 
+/* Dense layers */
+static
+void
+__build_dense_layers(neural_network *network) {
+    size_t layers_count = network->resolution.layers;
+    dense_layer **layers = calloc(layers_count, sizeof(dense_layer*));
+    neural_cell ***cells = calloc(layers_count, sizeof(neural_cell**));
+    check_memory(layers);
+    check_memory(cells);
+
+    // Created layer binds its cells to own block, so every layer is
+    // checked before any of them is created
+    for(size_t layer = 0; layer < layers_count; layer++) {
+        cells[layer] = get_layer_cells(network, layer);
+        check_memory(cells[layer]);
+
+        if(is_dense_layer(cells[layer], layer ? cells[layer - 1] : NULL) == false) {
+            goto error;
+        }
+    }
+
+    for(size_t layer = 0; layer < layers_count; layer++) {
+        size_t inputs = layer ? network->resolution.dimensions[layer - 1] : 0;
+        layers[layer] = Layer.create(cells[layer], inputs);
+        // Cells of created layers view their blocks, they are kept alive
+        check_memory(layers[layer]);
+        cells[layer] = NULL;
+    }
+
+    network->layers = layers;
+    free(cells);
+
+    return;
+
+error:
+    // Network stays with firing neuron by neuron
+    for(size_t layer = 0; cells && layer < layers_count; layer++) {
+        free(cells[layer]);
+    }
+    free(cells);
+    free(layers);
+}
+
+// Each cell has synapse with every cell of previous layer in order of positions
+static
+enum bool
+is_dense_layer(neural_cell **cells, neural_cell **previous_cells) {
+    for(size_t position = 0; cells[position]; position++) {
+        neural_cell *cell = cells[position];
+        size_t index = 0;
+
+        if(cell->nucleus.transfer.layer == NULL) {
+            return false;
+        }
+
+        if(previous_cells == NULL) {
+            if(cell->synapse[0]) {
+                return false;
+            }
+            continue;
+        }
+
+        while(cell->synapse[index] && previous_cells[index]) {
+            if(cell->synapse[index] != previous_cells[index]) {
+                return false;
+            }
+            index++;
+        }
+
+        if(cell->synapse[index] || previous_cells[index]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 neural_cell **
 get_layer_cells(neural_network *network, size_t layer) {
@@ -167,6 +318,12 @@ fire(neural_network *network, matrix *signal) {
     
     matrix_check_print(signal, "For network fire");
 
+    if(network->layers) {
+        check(layers_fire(network, signal), "Layers fire failed");
+
+        return axon(network);
+    }
+
     while(network->resolution.size > index && network->neurons[index]->context->layer_index == 0) {
         neural_cell *cell = network->neurons[index];
         
@@ -181,6 +338,23 @@ error:
     return NULL;
 }
 
+// Activation of each layer is neurons x samples, the last one stays in layer
+static
+matrix *
+layers_fire(neural_network *network, matrix *signal) {
+    matrix *layer_signal = signal;
+
+    for(size_t layer = 0; layer < network->resolution.layers; layer++) {
+        layer_signal = Layer.fire(network->layers[layer], layer_signal, layer > 0);
+        check(layer_signal, "Layer %zd fire failed", layer);
+    }
+
+    return layer_signal;
+
+error:
+    return NULL;
+}
+
 /* Error */
 static
 float
@@ -188,9 +362,16 @@ compute_error(neural_network *network, matrix *signal, matrix *target) {
     matrix_check_print(signal, "Broken signal for network error");
     matrix_check_print(target, "Broken target for network error");
 
+    if(is_layers_trainable(network)) {
+        return layers_error(network, signal, target);
+    }
+
     size_t layer_index = network->resolution.layers - 1;
     size_t layer_size = network->resolution.dimensions[layer_index];
     size_t samples_count = 0;
+
+    // Everything but error derivative of cells is thrown away with scratch
+    arena_mark scratch = Arena.push(Arena.scratch());
     
     matrix *predicted = Network.fire(network, signal);
     float *error_body = malloc(layer_size * sizeof(float));
@@ -207,12 +388,14 @@ compute_error(neural_network *network, matrix *signal, matrix *target) {
         // Let's begin backpropagating the error derivatives. 
         // Since we have the predicted output of this particular input example, 
         // we can compute how the error changes with that output.
+        arena_mark heap = Arena.push(NULL);
         error_prime[position] = cell->nucleus.error.derivative(cell->context,
                                                                target);
         if(cell->context->prime.error) {    
             Vector.delete(cell->context->prime.error);
         }
         cell->context->prime.error = error_prime[position];
+        Arena.pop(heap);
  
         error_body[position] = cell->nucleus.error.of(cell->context,
                                                       target);
@@ -231,35 +414,68 @@ compute_error(neural_network *network, matrix *signal, matrix *target) {
     Matrix.delete(predicted);
     free(error_prime);
     free(error_body);
+    Arena.pop(scratch);
     
     return error;
 
 error:
+    Arena.pop(scratch);
     return 0;
 }
 
 /* Train */
 static
 void
-train(neural_network *network, data_batch *training_data, float learning_rate, int epoch) {
+train(neural_network *network, data_batch *training_data, float learning_rate, int epoch, size_t threads) {
+    arena_mark heap = Arena.push(NULL);
+    data_parallel *parallel = NULL;
+    data_loader *loader = NULL;
+    vector *train_error = NULL;
+    vector *train_accuracy = NULL;
+
+    // Parameters of mapped network are viewing read-only pages
+    check(network->mapping.address == NULL, "Network mapped from file is read-only, it can't be trained");
+
     free(network->history);
     network->history = malloc(epoch * sizeof(network_loss));
+    reserve_layers(network, training_data);
+
+    // Sequential when there is only one thread or network can't be replicated
+    parallel = parallel_create(network, training_data, threads);
+    // Every mini-batch of each epoch overwrites its own loss
+    train_error = Vector.create(training_data->count);
+    train_accuracy = Vector.create(training_data->count);
+    check_memory(train_error);
+    check_memory(train_accuracy);
+    // Next mini-batches are gathered while the current one is trained
+    loader = Loader.create(training_data, 0);
+    check(loader, "Loader of training data isn't created");
 
     for (int epoch_index = 0; epoch_index < epoch; epoch_index++)
     {
         printf("Training %ld batches\n", training_data->count); 
-        vector *train_error = Vector.create(training_data->count);
-        vector *train_accuracy = Vector.create(training_data->count);
+
+        // Each epoch goes through mini-batches of new order
+        Loader.epoch(loader);
 
         for(size_t batch = 0; batch < training_data->count; batch++) {
-            matrix *signal = training_data->mini[batch]->features.values;
-            matrix *target = training_data->mini[batch]->target.values;
+            data_set *mini = Loader.next(loader);
+            check(mini, "Mini-batch %zd is broken", batch);
+
+            matrix *signal = mini->features.values;
+            matrix *target = mini->target.values;
 
             matrix_check(signal);
             matrix_check(target);
             
-            float batch_error = back_propagation(network, signal, target, learning_rate);
-            float batch_accuracy = accuracy(network, target);
+            float batch_accuracy = 0;
+            float batch_error = parallel
+                              ? parallel_back_propagation(parallel, signal, target, learning_rate, &batch_accuracy)
+                              : back_propagation(network, signal, target, learning_rate);
+
+            if(parallel == NULL) {
+                batch_accuracy = accuracy(network, target);
+            }
 
             VECTOR(train_error, batch) = batch_error;
             VECTOR(train_accuracy, batch) = batch_accuracy;
@@ -301,18 +517,35 @@ train(neural_network *network, data_batch *training_data, float learning_rate, i
 
         history->validation.error = validation_error;
         history->validation.accuracy = validation_accuracy;
+    }
 
+error:
+    if(train_error) {
         Vector.delete(train_error);
+    }
+    if(train_accuracy) {
         Vector.delete(train_accuracy);
     }
-
-error:
+    if(loader) {
+        Loader.delete(loader);
+    }
+    for(size_t layer = 0; network->layers && layer < network->resolution.layers; layer++) {
+        network->layers[layer]->training = false;
+    }
+    parallel_delete(parallel);
+    Arena.pop(heap);
     return;
 }
 
 static
 float
 accuracy(neural_network *network, matrix *target) {
+    if(is_layers_trainable(network)) {
+        return layers_accuracy(network, target);
+    }
+
+    // Predicted and converted values are dropped in bulk after each batch
+    arena_mark scratch = Arena.push(Arena.scratch());
     matrix *predicted = axon(network); 
     vector *target_vector = Data.convert.binary_to_vector(target);
     vector *predicted_vector = Data.convert.binary_to_vector(predicted);
@@ -328,6 +561,8 @@ accuracy(neural_network *network, matrix *target) {
 
     float accuracy = predicted_count / (target_vector->size * 2. - predicted_count);
 
+    Arena.pop(scratch);
+
     return accuracy;
 }
 
@@ -339,6 +574,10 @@ back_propagation(neural_network *network, matrix *signal, matrix *target, float
     matrix_check_print(signal, "Back propagate broken signal");
     matrix_check_print(target, "Back propagate broken target");
 
+    if(is_layers_trainable(network)) {
+        return layers_back_propagation(network, signal, target, learning_rate);
+    }
+
     // For this, we need to compute how the error changes with respect to each weigh.
     float error = compute_error(network, signal, target);
     
@@ -354,6 +593,401 @@ error:
     return 0;
 }
 
+/* Layers Training */
+// Gradient buffers live in layers, so training step reuses
+// the same memory from batch to batch
+static
+float
+layers_error(neural_network *network, matrix *signal, matrix *target) {
+    dense_layer *output = network->layers[network->resolution.layers - 1];
+
+    check(layers_fire(network, signal), "Layers fire failed");
+
+    return Layer.loss(output, target);
+
+error:
+    return 0;
+}
+
+// Same measure as cell path, predicted class is the index of biggest output
+static
+float
+layers_accuracy(neural_network *network, matrix *target) {
+    matrix *activation = network->layers[network->resolution.layers - 1]->activation;
+
+    check(target->rows == activation->columns, "Target has %zd samples, network fired %zd", target->rows, activation->columns);
+
+    size_t predicted_count = layers_predicted(activation, target);
+
+    return predicted_count / (target->rows * 2. - predicted_count);
+
+error:
+    return 0;
+}
+
+static
+size_t
+layers_predicted(matrix *activation, matrix *target) {
+    size_t predicted_count = 0;
+
+    for(size_t sample = 0; sample < target->rows; sample++) {
+        size_t predicted_index = 0;
+        size_t target_index = 0;
+        float predicted_max = 0;
+        float target_max = 0;
+
+        for(size_t neuron = target->columns; neuron--;) {
+            float predicted_value = fabs(MATRIX(activation, neuron, sample));
+            float target_value = fabs(MATRIX(target, sample, neuron));
+
+            if(predicted_value > predicted_max) {
+                predicted_max = predicted_value;
+                predicted_index = neuron;
+            }
+            if(target_value > target_max) {
+                target_max = target_value;
+                target_index = neuron;
+            }
+        }
+
+        if(predicted_index == target_index) {
+            predicted_count += 1;
+        }
+    }
+
+    return predicted_count;
+}
+
+static
+float
+layers_back_propagation(neural_network *network, matrix *signal, matrix *target, float learning_rate) {
+    float error = layers_error(network, signal, target);
+
+    for(size_t layer = network->resolution.layers; layer--;) {
+        dense_layer *current = network->layers[layer];
+        matrix *previous_error = layer ? network->layers[layer - 1]->error : NULL;
+
+        check(Layer.back_propagate(current, previous_error), "Layer %zd back propagation failed", layer);
+        check(layer_optimization(current)(current, learning_rate), "Layer %zd optimization failed", layer);
+    }
+
+    return error;
+
+error:
+    return 0;
+}
+
+static
+layer_optimization_function
+layer_optimization(dense_layer *layer) {
+    return Optimization.of(layer->kernel.optimization);
+}
+
+// Layers are trained at once when each of them knows how to optimize itself
+// and output layer computes cost for whole layer
+static
+enum bool
+is_layers_trainable(neural_network *network) {
+    if(network->layers == NULL) {
+        return false;
+    }
+
+    for(size_t layer = 0; layer < network->resolution.layers; layer++) {
+        if(layer_optimization(network->layers[layer]) == NULL) {
+            return false;
+        }
+    }
+
+    return network->layers[network->resolution.layers - 1]->kernel.error.layer != NULL;
+}
+
+// Buffers are sized for the biggest batch before the first step
+static
+void
+reserve_layers(neural_network *network, data_batch *training_data) {
+    size_t samples = training_data->validation ? training_data->validation->features.values->rows : 0;
+
+    if(network->layers == NULL || training_data->count == 0) {
+        return;
+    }
+
+    if(biggest_batch(training_data) > samples) {
+        samples = biggest_batch(training_data);
+    }
+
+    shape_layers(network, network->layers, training_data->mini[0]->features.values->columns, samples);
+}
+
+static
+size_t
+biggest_batch(data_batch *training_data) {
+    size_t samples = 0;
+
+    for(size_t batch = 0; batch < training_data->count; batch++) {
+        matrix *features = training_data->mini[batch]->features.values;
+
+        if(features->rows > samples) {
+            samples = features->rows;
+        }
+    }
+
+    return samples;
+}
+
+// Layers are reserved only for training, so their fire keeps derivative
+static
+dense_layer **
+shape_layers(neural_network *network, dense_layer **layers, size_t inputs, size_t samples) {
+    for(size_t layer = 0; layer < network->resolution.layers; layer++) {
+        check(Layer.shape(layers[layer], inputs, samples), "Layer %zd can't be reserved for %zd samples", layer, samples);
+        layers[layer]->training = true;
+        inputs = network->resolution.dimensions[layer];
+    }
+
+    return layers;
+
+error:
+    return NULL;
+}
+
+
+/* Data Parallel Training */
+// Workers are kept for whole training, each has replicas of layers
+// sized for its share of the biggest batch
+static
+data_parallel *
+parallel_create(neural_network *network, data_batch *training_data, size_t threads) {
+    data_parallel *parallel = NULL;
+    size_t samples = biggest_batch(training_data);
+
+    threads = threads ? threads : Pool.cores();
+    if(threads > samples) {
+        threads = samples;
+    }
+
+    if(threads < 2 || is_layers_trainable(network) == false) {
+        return NULL;
+    }
+
+    parallel = calloc(1, sizeof(data_parallel));
+    check_memory(parallel);
+    parallel->network = network;
+
+    parallel->pool = Pool.create(threads);
+    check_memory(parallel->pool);
+
+    parallel->workers = calloc(parallel->pool->size, sizeof(training_worker));
+    check_memory(parallel->workers);
+
+    matrix *features = training_data->mini[0]->features.values;
+    matrix *target = training_data->mini[0]->target.values;
+    size_t share = (samples + parallel->pool->size - 1) / parallel->pool->size;
+
+    for(size_t index = 0; index < parallel->pool->size; index++) {
+        training_worker *worker = &parallel->workers[index];
+
+        worker->signal = Matrix.view(features->vector->values, 1, features->columns);
+        worker->target = Matrix.view(target->vector->values, 1, target->columns);
+        worker->layers = calloc(network->resolution.layers, sizeof(dense_layer*));
+        check_memory(worker->signal);
+        check_memory(worker->target);
+        check_memory(worker->layers);
+
+        for(size_t layer = 0; layer < network->resolution.layers; layer++) {
+            worker->layers[layer] = Layer.replicate(network->layers[layer]);
+            check_memory(worker->layers[layer]);
+        }
+
+        check(shape_layers(network, worker->layers, features->columns, share), "Replicas of worker %zd can't be reserved", index);
+    }
+
+    return parallel;
+
+error:
+    parallel_delete(parallel);
+    return NULL;
+}
+
+static
+void
+parallel_delete(data_parallel *parallel) {
+    if(parallel == NULL) {
+        return;
+    }
+
+    if(parallel->pool) {
+        Pool.run(parallel->pool, parallel_release, parallel);
+    }
+
+    for(size_t index = 0; parallel->workers && index < parallel->pool->size; index++) {
+        training_worker *worker = &parallel->workers[index];
+
+        for(size_t layer = 0; worker->layers && layer < parallel->network->resolution.layers; layer++) {
+            if(worker->layers[layer]) {
+                Layer.delete(worker->layers[layer]);
+            }
+        }
+        free(worker->layers);
+
+        if(worker->signal) {
+            Matrix.delete(worker->signal);
+        }
+        if(worker->target) {
+            Matrix.delete(worker->target);
+        }
+    }
+
+    if(parallel->pool) {
+        Pool.delete(parallel->pool);
+    }
+    free(parallel->workers);
+    free(parallel);
+}
+
+// Gradient of batch is the mean of worker gradients weighted by their samples,
+// so step is the same as sequential one up to rounding
+static
+float
+parallel_back_propagation(data_parallel *parallel, matrix *signal, matrix *target, float learning_rate, float *accuracy) {
+    neural_network *network = parallel->network;
+    float error = 0;
+    size_t predicted_count = 0;
+
+    parallel->signal = signal;
+    parallel->target = target;
+
+    Pool.run(parallel->pool, parallel_step, parallel);
+
+    for(size_t index = 0; index < parallel->pool->size; index++) {
+        training_worker *worker = &parallel->workers[index];
+
+        check(worker->failed == false, "Worker %zd training step failed", index);
+
+        error += worker->error * worker->samples / signal->rows;
+        predicted_count += worker->predicted;
+    }
+
+    Pool.run(parallel->pool, parallel_reduce, parallel);
+
+    for(size_t layer = 0; layer < network->resolution.layers; layer++) {
+        dense_layer *current = network->layers[layer];
+
+        check(layer_optimization(current)(current, learning_rate), "Layer %zd optimization failed", layer);
+    }
+
+    *accuracy = predicted_count / (signal->rows * 2. - predicted_count);
+
+    return error;
+
+error:
+    return 0;
+}
+
+// Worker rows are taken in order, the last workers are idle for small batch
+static
+void
+parallel_step(void *context, size_t index, size_t workers) {
+    data_parallel *parallel = context;
+    training_worker *worker = &parallel->workers[index];
+    size_t layers = parallel->network->resolution.layers;
+    size_t samples = parallel->signal->rows;
+    size_t share = (samples + workers - 1) / workers;
+    size_t row = index * share;
+
+    worker->failed = false;
+    worker->error = 0;
+    worker->predicted = 0;
+    worker->samples = row < samples ? samples - row : 0;
+    if(worker->samples > share) {
+        worker->samples = share;
+    }
+
+    if(worker->samples == 0) {
+        return;
+    }
+
+    bind_rows(worker->signal, parallel->signal, row, worker->samples);
+    bind_rows(worker->target, parallel->target, row, worker->samples);
+
+    matrix *layer_signal = worker->signal;
+    for(size_t layer = 0; layer < layers; layer++) {
+        layer_signal = Layer.fire(worker->layers[layer], layer_signal, layer > 0);
+        check(layer_signal, "Replica of layer %zd fire failed", layer);
+    }
+
+    dense_layer *output = worker->layers[layers - 1];
+    worker->error = Layer.loss(output, worker->target);
+    worker->predicted = layers_predicted(output->activation, worker->target);
+
+    for(size_t layer = layers; layer--;) {
+        matrix *previous_error = layer ? worker->layers[layer - 1]->error : NULL;
+
+        check(Layer.back_propagate(worker->layers[layer], previous_error), "Replica of layer %zd back propagation failed", layer);
+    }
+
+    return;
+
+error:
+    worker->failed = true;
+}
+
+// Each worker sums its slice of every gradient, weight and bias prime
+static
+void
+parallel_reduce(void *context, size_t index, size_t workers) {
+    data_parallel *parallel = context;
+    size_t samples = parallel->signal->rows;
+
+    for(size_t layer = 0; layer < parallel->network->resolution.layers; layer++) {
+        vector *gradient = parallel->network->layers[layer]->gradient;
+        size_t share = (gradient->size + workers - 1) / workers;
+        size_t from = index * share;
+        size_t to = from + share < gradient->size ? from + share : gradient->size;
+
+        if(from >= to) {
+            continue;
+        }
+
+        memset(gradient->values + from, 0, (to - from) * sizeof(float));
+
+        for(size_t replica = 0; replica < workers; replica++) {
+            training_worker *worker = &parallel->workers[replica];
+            float *values = worker->layers[layer]->gradient->values;
+            float scale = (float)worker->samples / samples;
+
+            if(worker->samples == 0) {
+                continue;
+            }
+
+            for(size_t position = from; position < to; position++) {
+                gradient->values[position] += scale * values[position];
+            }
+        }
+    }
+}
+
+// Packing buffers and scratch arenas of worker threads would be lost with threads
+static
+void
+parallel_release(void *context, size_t index, size_t workers) {
+    (void)context;
+    (void)index;
+    (void)workers;
+
+    gemm_release();
+    Arena.delete(Arena.scratch());
+}
+
+static
+void
+bind_rows(matrix *view, matrix *source, size_t row, size_t rows) {
+    view->rows = rows;
+    view->columns = source->columns;
+    view->stride = source->columns;
+    view->vector->values = &MATRIX(source, row, 0);
+    view->vector->size = rows * source->columns;
+}
+
 /* Network Result Signal */
 static
 matrix *
@@ -361,6 +995,14 @@ axon(neural_network *network) {
     size_t layer_index = network->resolution.layers - 1;
     size_t layer_size = network->resolution.dimensions[layer_index];
 
+    if(network->layers) {
+        matrix *activation = network->layers[layer_index]->activation;
+        matrix *result = Matrix.create(activation->columns, activation->rows);
+        check_memory(result);
+
+        return Matrix.transposed(activation, result);
+    }
+
     vector **axon = malloc(layer_size * sizeof(vector*));
 
     //#pragma omp parallel for
@@ -371,12 +1013,14 @@ axon(neural_network *network) {
         axon[position] = cell->context->body.activation;
     }
 
-    matrix *result = Matrix.transpose(Matrix.from(axon, layer_size, axon[0]->size));
+    matrix *result = Matrix.columns(axon, layer_size);
 
     free(axon);
 
     return result;
 
+error:
+    return NULL;
 }
 
 
@@ -387,9 +1031,7 @@ cell_back_propagation(neural_cell *cell, float learning_rate) {
     neuron_ccheck(cell, "Broken cell from argument");
     check(learning_rate, "Learning rate doesn't set");
 
-    static float *params = NULL;
-    // TODO: Params for Adam
-    params = cell->nucleus.optimization((void*)cell, learning_rate, params);
+    cell->context->optimizer = cell->nucleus.optimization((void*)cell, learning_rate, cell->context->optimizer);
     // Synapse reverse fire
     size_t synapse_index = 0;
     while(cell->synapse[synapse_index]) {
@@ -460,3 +1102,170 @@ get_neuron_position(neural_network *network, size_t layer, size_t position) {
     return absolute_position + position;
 }
 
+
+
+/* Binary File */
+static
+enum bool
+save(neural_network *network, char *filename) {
+    FILE *file = NULL;
+    network_file_header header = {
+        .magic = NETWORK_FILE_MAGIC,
+        .version = NETWORK_FILE_VERSION,
+        .layers = network->resolution.layers
+    };
+    uint64_t blocks = NETWORK_FILE_ALIGN(sizeof(network_file_header) + header.layers * sizeof(network_file_layer));
+    uint64_t offset = blocks;
+
+    check(network->layers, "Only network of dense layers is saved");
+
+    file = fopen(filename, "wb");
+    check(file, "Can't open %s for writing", filename);
+    check(fwrite(&header, sizeof(network_file_header), 1, file) == 1, "Header of %s isn't written", filename);
+
+    for(size_t layer = 0; layer < header.layers; layer++) {
+        dense_layer *dense = network->layers[layer];
+        network_file_layer record;
+        // Padding of record is written too
+        memset(&record, 0, sizeof(network_file_layer));
+
+        check(dense->weight, "Layer %zd isn't shaped, network wasn't fired", layer);
+        check(Kernel.id(&dense->kernel, &record.kernel), "Kernel of layer %zd can't be saved", layer);
+        record.offset = offset;
+        record.dimension = dense->dimension;
+        record.inputs = dense->inputs;
+
+        check(fwrite(&record, sizeof(network_file_layer), 1, file) == 1, "Layer %zd of %s isn't written", layer, filename);
+        offset = NETWORK_FILE_ALIGN(offset + dense->parameters->size * sizeof(float));
+    }
+
+    // Gaps before blocks are left as holes of file
+    offset = blocks;
+    for(size_t layer = 0; layer < header.layers; layer++) {
+        vector *parameters = network->layers[layer]->parameters;
+
+        check(fseek(file, offset, SEEK_SET) == 0
+              && fwrite(parameters->values, sizeof(float), parameters->size, file) == parameters->size,
+              "Parameters of layer %zd in %s aren't written", layer, filename);
+        offset = NETWORK_FILE_ALIGN(offset + parameters->size * sizeof(float));
+    }
+
+    check(fclose(file) == 0, "Can't close %s", filename);
+
+    return true;
+
+error:
+    if(file) {
+        fclose(file);
+    }
+    return false;
+}
+
+// Layers are routed densely as they were saved. Pages are read-only,
+// mapped network is only fired
+static
+neural_network
+load(char *filename, enum bool mapped) {
+    neural_network network = { 0 };
+    neural_layer *layers = NULL;
+    void *address = MAP_FAILED;
+    size_t size = 0;
+    arena_mark heap = Arena.push(NULL);
+    struct stat status;
+    int file = open(filename, O_RDONLY);
+    check(file >= 0, "Can't open %s", filename);
+
+    check(fstat(file, &status) == 0, "Can't stat %s", filename);
+    size = status.st_size;
+    check(size >= sizeof(network_file_header), "%s is too small for network", filename);
+
+    // Weights are only read, mapped layers can't be trained
+    address = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    check(address != MAP_FAILED, "Can't map %s", filename);
+    if(mapped == false) {
+        close(file);
+        file = -1;
+    }
+
+    network_file_header *header = address;
+    network_file_layer *records = (network_file_layer *)(header + 1);
+
+    check(memcmp(header->magic, NETWORK_FILE_MAGIC, sizeof(header->magic)) == 0, "%s isn't network file", filename);
+    check(header->version == NETWORK_FILE_VERSION, "%s has version %u, expected %u", filename, header->version, NETWORK_FILE_VERSION);
+    check(header->layers && header->layers <= (size - sizeof(network_file_header)) / sizeof(network_file_layer),
+          "%s is broken or truncated", filename);
+
+    layers = calloc(header->layers + 1, sizeof(neural_layer));
+    check_memory(layers);
+
+    for(size_t layer = 0; layer < header->layers; layer++) {
+        network_file_layer *record = &records[layer];
+
+        check(record->dimension && record->dimension <= size && record->inputs && record->inputs <= size
+              && (layer == 0 || record->inputs == records[layer - 1].dimension)
+              && record->offset % NETWORK_FILE_ALIGNMENT == 0
+              && mapped_block_fits(record->offset, record->dimension, record->inputs + 1, size),
+              "Layer %zd of %s is broken or truncated", layer, filename);
+        check(Kernel.of(record->kernel, &layers[layer].kernel), "Kernel of layer %zd in %s is unknown", layer, filename);
+
+        layers[layer].router = Router.any;
+        layers[layer].dimension = record->dimension;
+    }
+
+    network = create(layers);
+    check(network.layers, "Network of %s isn't dense", filename);
+
+    for(size_t layer = 0; layer < header->layers; layer++) {
+        dense_layer *dense = network.layers[layer];
+        float *parameters = (float *)((char *)address + records[layer].offset);
+
+        check(Layer.shape(dense, records[layer].inputs, 1) && Layer.assign(dense, parameters, mapped),
+              "Layer %zd of %s isn't loaded", layer, filename);
+    }
+
+    if(mapped) {
+        network.mapping.address = address;
+        network.mapping.size = size;
+        network.mapping.file = file;
+    } else {
+        munmap(address, size);
+    }
+
+    free(layers);
+    Arena.pop(heap);
+
+    return network;
+
+error:
+    if(file >= 0) {
+        close(file);
+    }
+    if(network.neurons) {
+        delete(&network);
+    }
+    if(address != MAP_FAILED) {
+        munmap(address, size);
+    }
+    free(layers);
+    Arena.pop(heap);
+    return (neural_network){ 0 };
+}
+
+
+/* Inference */
+static
+inference_plan *
+freeze(neural_network *network, size_t capacity) {
+    check(network->layers, "Only network of dense layers is frozen");
+
+    if(network->mapping.address) {
+        plan_mapping mapping = { network->mapping.address, network->mapping.size, network->mapping.file };
+
+        return Plan.create(network->layers, network->resolution.layers, capacity, &mapping);
+    }
+
+    return Plan.create(network->layers, network->resolution.layers, capacity, NULL);
+
+error:
+    return NULL;
+}
@@ -12,12 +12,17 @@
 #include <stdio.h>
 //#include <omp.h>
 #include "cell.h"
+#include "layer.h"
+#include "kernel.h"
+#include "plan.h"
 #include "body/optimization.h"
 #include "../data/set.h"
+#include "../data/loader.h"
+#include "../util/pool.h"
 
 #define NEURONS(network, layer) NEURON(network, layer, (size_t)0)
 #define network_check(network)                                                                                                               \
-    for (size_t index = 0; index < network->resolution.size; index++)                                                                        \
+    for (size_t index = 0; VALIDATION && index < network->resolution.size; index++)                                                          \
     {                                                                                                                                        \
         neural_cell *cell = network->neurons[index];                                                                                        \
         neuron_ccheck(cell, "Neuron cell %zd is broken", index);                                                                         \
@@ -25,6 +30,27 @@
         neurons_check(cell->axon, "Neuron cell %zdx%zd axon terminal is broken", cell->context->layer_index, cell->context->position);       \
     }
 
+/* Binary network file: header, record of each layer, then weight and bias
+   block of each layer laid out as its parameters. Blocks start at page
+   boundary, so mapped file is used by layers without copying */
+#define NETWORK_FILE_MAGIC      "NAIVENN"
+#define NETWORK_FILE_VERSION    1
+#define NETWORK_FILE_ALIGNMENT  4096
+
+typedef struct {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    layers;
+} network_file_header;
+
+typedef struct {
+    // Offset from file start
+    uint64_t    offset;
+    uint64_t    dimension;
+    uint64_t    inputs;
+    kernel_id   kernel;
+} network_file_layer;
+
 /* Training history */
 typedef struct {
     float               error;
@@ -47,8 +73,18 @@ typedef struct {
     }             resolution;
     
     neural_cell   **neurons;
+    // Layers fired at once when every layer is densely routed, otherwise NULL
+    dense_layer   **layers;
     
     network_loss  *history;
+
+    // Loaded file which parameters of layers are viewing, NULL when they are
+    // on heap. File stays open, so frozen plan maps own pages of it
+    struct {
+        void *    address;
+        size_t    size;
+        int       file;
+    }             mapping;
 } neural_network;
 
 /* Definition of layer */
@@ -68,8 +104,21 @@ struct network_library {
     void                 (*delete)(neural_network *network);
     
     matrix *             (*fire)(neural_network *network, matrix *signal);
-    void                 (*train)(neural_network *network, data_batch *training_data, float learning_rate, int epoch);
+    // Mini-batches are split between threads when layers are trainable at once,
+    // zero threads is one for each core
+    void                 (*train)(neural_network *network, data_batch *training_data, float learning_rate, int epoch, size_t threads);
     float                (*error)(neural_network *network, matrix *signal, matrix *target);
+
+    // Dense network fired at least once is written with its kernels
+    enum bool            (*save)(neural_network *network, char *filename);
+    // Mapped network views weight and bias in read-only pages of file for
+    // inference, otherwise they are copied to heap. Network without layers
+    // when file is broken
+    neural_network       (*load)(char *filename, enum bool mapped);
+    // Dense network fired at least once is compiled into plan of inference,
+    // plan keeps own parameters, so network can be deleted. Plan of mapped
+    // network views the same file instead of copying
+    inference_plan *     (*freeze)(neural_network *network, size_t capacity);
     
     struct {
         size_t           (*neuron)(neural_network *network, size_t layer, size_t position);
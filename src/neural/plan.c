@@ -0,0 +1,840 @@
+//
+//  plan.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "plan.h"
+#include "../math/gemm.h"
+
+static inference_plan *     plan_create(dense_layer **layers, size_t count, size_t capacity, plan_mapping *mapping);
+static void                 plan_delete(inference_plan *plan);
+static inference_plan *     plan_reserve(inference_plan *plan, size_t workspaces);
+static matrix *             plan_predict(inference_plan *plan, matrix *input, matrix *output);
+static inference_plan *     plan_quantize(inference_plan *plan, data_set *calibration, enum bool per_channel);
+static float                plan_accuracy_delta(inference_plan *plan, data_set *validation);
+static inference_plan *     plan_shrink(inference_plan *plan);
+static enum bool            plan_save(inference_plan *plan, char *filename);
+static inference_plan *     plan_load(char *filename, size_t capacity);
+
+static inference_plan *     plan_allocate(size_t count, size_t capacity);
+static plan_workspace *     workspace_create(inference_plan *plan);
+static enum bool            workspace_quantize(inference_plan *plan, plan_workspace *workspace);
+static void                 workspace_delete(plan_workspace *workspace);
+static plan_workspace *     workspace_add(inference_plan *plan);
+static plan_workspace *     workspace_take(inference_plan *plan);
+static void                 workspace_give(inference_plan *plan, plan_workspace *workspace);
+static matrix *             plan_run(inference_plan *plan, matrix *input, matrix *output, enum bool quantized, float *ranges);
+static matrix *             plan_fire(inference_plan *plan, plan_workspace *workspace, size_t samples,
+                                      enum bool quantized, float *ranges);
+static enum bool            plan_product(plan_layer *layer, plan_workspace *workspace, matrix *signal,
+                                         enum bool transposed, matrix *transfer);
+static float                plan_accuracy(inference_plan *plan, data_set *set, enum bool quantized);
+static matrix *             plan_bind(matrix *view, float *values, size_t rows, size_t columns, size_t stride);
+
+
+/* Library Structure */
+const struct plan_library Plan = {
+    .create = plan_create,
+    .delete = plan_delete,
+
+    .reserve = plan_reserve,
+    .predict = plan_predict,
+
+    .quantize = plan_quantize,
+    .accuracy_delta = plan_accuracy_delta,
+    .shrink = plan_shrink,
+
+    .save = plan_save,
+    .load = plan_load
+};
+
+
+/* Life Cycle */
+static
+inference_plan *
+plan_create(dense_layer **layers, size_t count, size_t capacity, plan_mapping *mapping) {
+    arena_mark heap = Arena.push(NULL);
+    inference_plan *plan = NULL;
+    size_t size = 0;
+    size_t width = 0;
+    size_t depth = 0;
+
+    check_memory(layers);
+    check(count, "Plan without layers");
+    for(size_t layer = 0; layer < count; layer++) {
+        dense_layer_check(layers[layer], "Layer %zd of plan", layer);
+        check(layers[layer]->weight, "Layer %zd isn't shaped, network wasn't fired", layer);
+        check(layers[layer]->kernel.activation.layer, "Layer %zd has no whole layer activation", layer);
+
+        size += layers[layer]->parameters->size;
+        width = layers[layer]->dimension > width ? layers[layer]->dimension : width;
+        depth = layers[layer]->inputs > depth ? layers[layer]->inputs : depth;
+    }
+
+    plan = plan_allocate(count, capacity);
+    check_memory(plan);
+
+    plan->inputs = layers[0]->inputs;
+    plan->outputs = layers[count - 1]->dimension;
+    plan->width = width;
+    plan->depth = depth;
+
+    // Own pages of the same file, network can be deleted before plan
+    float *values = NULL;
+    if(mapping) {
+        void *address = mmap(NULL, mapping->size, PROT_READ, MAP_PRIVATE, mapping->file, 0);
+        check(address != MAP_FAILED, "Network file isn't mapped for plan");
+        plan->mapping.address = address;
+        plan->mapping.size = mapping->size;
+    } else {
+        plan->parameters = Vector.create(size);
+        check_memory(plan->parameters);
+        values = plan->parameters->values;
+    }
+
+    for(size_t layer = 0; layer < count; layer++) {
+        dense_layer *dense = layers[layer];
+        plan_layer *current = &plan->layers[layer];
+        kernel_id id;
+
+        check(Kernel.id(&dense->kernel, &id), "Kernel of layer %zd has no number", layer);
+        current->kernel = id;
+        current->activate = dense->kernel.activation.layer;
+        current->dimension = dense->dimension;
+        current->inputs = dense->inputs;
+
+        if(mapping) {
+            char *block = (char *)dense->parameters->values;
+            char *start = mapping->address;
+            check(block >= start && (size_t)(block - start) <= mapping->size
+                  && dense->parameters->size <= (mapping->size - (block - start)) / sizeof(float),
+                  "Layer %zd isn't viewing mapped file", layer);
+            values = (float *)((char *)plan->mapping.address + (block - start));
+        } else {
+            memcpy(values, dense->parameters->values, dense->parameters->size * sizeof(float));
+        }
+        current->weight = Matrix.view(values, dense->dimension, dense->inputs);
+        current->bias = Vector.view(values + dense->dimension * dense->inputs, dense->dimension);
+        check_memory(current->weight);
+        check_memory(current->bias);
+
+        values += dense->parameters->size;
+    }
+
+    check(plan_reserve(plan, 1), "Plan has no workspace");
+
+    Arena.pop(heap);
+
+    return plan;
+
+error:
+    plan_delete(plan);
+    Arena.pop(heap);
+    return NULL;
+}
+
+// Plan of count empty layers, sizes are set by caller
+static
+inference_plan *
+plan_allocate(size_t count, size_t capacity) {
+    inference_plan *plan = calloc(1, sizeof(inference_plan));
+    check_memory(plan);
+
+    plan->count = count;
+    plan->capacity = capacity ? capacity : PLAN_CAPACITY;
+    pthread_mutex_init(&plan->lock, NULL);
+
+    plan->layers = calloc(count, sizeof(plan_layer));
+    check_memory(plan->layers);
+
+    return plan;
+
+error:
+    plan_delete(plan);
+    return NULL;
+}
+
+static
+void
+plan_delete(inference_plan *plan) {
+    if(plan == NULL) {
+        return;
+    }
+
+    for(size_t layer = 0; plan->layers && layer < plan->count; layer++) {
+        if(plan->layers[layer].weight) {
+            Matrix.delete(plan->layers[layer].weight);
+        }
+        if(plan->layers[layer].bias) {
+            Vector.delete(plan->layers[layer].bias);
+        }
+        free(plan->layers[layer].quantized.weight);
+        free(plan->layers[layer].quantized.scale);
+        free(plan->layers[layer].quantized.sums);
+        free(plan->layers[layer].quantized.bias);
+    }
+
+    if(plan->parameters) {
+        Vector.delete(plan->parameters);
+    }
+    if(plan->mapping.address) {
+        munmap(plan->mapping.address, plan->mapping.size);
+    }
+
+    while(plan->workspaces) {
+        plan_workspace *next = plan->workspaces->next;
+        workspace_delete(plan->workspaces);
+        plan->workspaces = next;
+    }
+    pthread_mutex_destroy(&plan->lock);
+
+    free(plan->layers);
+    free(plan);
+}
+
+// Scratch holds transfer and two activations of the widest layer,
+// activation of previous layer is signal of the next one
+static
+plan_workspace *
+workspace_create(inference_plan *plan) {
+    size_t width = plan->width;
+    size_t capacity = plan->capacity;
+    plan_workspace *workspace = calloc(1, sizeof(plan_workspace));
+    check_memory(workspace);
+
+    workspace->scratch = Vector.create(3 * width * capacity);
+    check_memory(workspace->scratch);
+
+    float *values = workspace->scratch->values;
+    workspace->transfer = Matrix.view(values, width, capacity);
+    workspace->activation[0] = Matrix.view(values + width * capacity, width, capacity);
+    workspace->activation[1] = Matrix.view(values + 2 * width * capacity, width, capacity);
+    workspace->signal = Matrix.view(values, 1, 1);
+    workspace->result = Matrix.view(values, 1, 1);
+    check_memory(workspace->transfer);
+    check_memory(workspace->activation[0]);
+    check_memory(workspace->activation[1]);
+    check_memory(workspace->signal);
+    check_memory(workspace->result);
+
+    if(plan->quantized) {
+        check(workspace_quantize(plan, workspace), "Workspace has no int8 buffers");
+    }
+
+    return workspace;
+
+error:
+    workspace_delete(workspace);
+    return NULL;
+}
+
+// Int8 buffers fit every layer, so quantized predict doesn't allocate
+static
+enum bool
+workspace_quantize(inference_plan *plan, plan_workspace *workspace) {
+    if(workspace->products) {
+        return true;
+    }
+
+    workspace->codes = malloc(plan->capacity * plan->depth * sizeof(uint8_t));
+    workspace->products = malloc(plan->width * plan->capacity * sizeof(int32_t));
+    check_memory(workspace->codes);
+    check_memory(workspace->products);
+
+    return true;
+
+error:
+    free(workspace->codes);
+    free(workspace->products);
+    workspace->codes = NULL;
+    workspace->products = NULL;
+    return false;
+}
+
+// New workspace of plan isn't in pool yet, lock isn't held while it's allocated
+static
+plan_workspace *
+workspace_add(inference_plan *plan) {
+    arena_mark heap = Arena.push(NULL);
+    plan_workspace *workspace = workspace_create(plan);
+    Arena.pop(heap);
+
+    if(workspace) {
+        pthread_mutex_lock(&plan->lock);
+        plan->created++;
+        pthread_mutex_unlock(&plan->lock);
+    }
+
+    return workspace;
+}
+
+static
+plan_workspace *
+workspace_take(inference_plan *plan) {
+    pthread_mutex_lock(&plan->lock);
+    plan_workspace *workspace = plan->workspaces;
+    if(workspace) {
+        plan->workspaces = workspace->next;
+    }
+    pthread_mutex_unlock(&plan->lock);
+
+    return workspace ? workspace : workspace_add(plan);
+}
+
+static
+void
+workspace_give(inference_plan *plan, plan_workspace *workspace) {
+    pthread_mutex_lock(&plan->lock);
+    workspace->next = plan->workspaces;
+    plan->workspaces = workspace;
+    pthread_mutex_unlock(&plan->lock);
+}
+
+static
+void
+workspace_delete(plan_workspace *workspace) {
+    if(workspace == NULL) {
+        return;
+    }
+
+    matrix *views[] = {
+        workspace->transfer, workspace->activation[0], workspace->activation[1],
+        workspace->signal, workspace->result
+    };
+
+    for(size_t index = 0; index < sizeof(views) / sizeof(views[0]); index++) {
+        if(views[index]) {
+            Matrix.delete(views[index]);
+        }
+    }
+
+    if(workspace->scratch) {
+        Vector.delete(workspace->scratch);
+    }
+    free(workspace->codes);
+    free(workspace->products);
+    free(workspace);
+}
+
+
+/* Inference */
+static
+inference_plan *
+plan_reserve(inference_plan *plan, size_t workspaces) {
+    check_memory(plan);
+
+    pthread_mutex_lock(&plan->lock);
+    size_t created = plan->created;
+    pthread_mutex_unlock(&plan->lock);
+
+    for(; created < workspaces; created++) {
+        plan_workspace *workspace = workspace_add(plan);
+        check(workspace, "Workspace %zd of plan isn't created", created);
+        workspace_give(plan, workspace);
+    }
+
+    return plan;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+plan_predict(inference_plan *plan, matrix *input, matrix *output) {
+    check_memory(plan);
+
+    return plan_run(plan, input, output, plan->quantized, NULL);
+
+error:
+    return NULL;
+}
+
+// Ranges get minimum and maximum of each layer input when they aren't NULL
+static
+matrix *
+plan_run(inference_plan *plan, matrix *input, matrix *output, enum bool quantized, float *ranges) {
+    plan_workspace *workspace = NULL;
+    check(quantized || plan->layers[0].weight, "Float parameters of plan are dropped");
+    matrix_check_print(input, "For plan predict");
+    matrix_check_print(output, "For plan predict");
+    check(input->columns == plan->inputs, "Plan has %zd inputs, signal has %zd", plan->inputs, input->columns);
+    check(output->rows == input->rows && output->columns == plan->outputs,
+          "Output %zdx%zd doesn't fit %zd samples of %zd outputs", output->rows, output->columns, input->rows, plan->outputs);
+
+    workspace = workspace_take(plan);
+    check(workspace, "Plan has no workspace for predict");
+
+    for(size_t row = 0; row < input->rows; row += plan->capacity) {
+        size_t samples = input->rows - row < plan->capacity ? input->rows - row : plan->capacity;
+
+        plan_bind(workspace->signal, &MATRIX(input, row, 0), samples, input->columns, input->stride);
+        plan_bind(workspace->result, &MATRIX(output, row, 0), samples, output->columns, output->stride);
+
+        matrix *activation = plan_fire(plan, workspace, samples, quantized, ranges);
+        check(activation, "Plan fire failed at sample %zd", row);
+        check(Matrix.transposed(activation, workspace->result), "Plan output isn't written");
+    }
+
+    workspace_give(plan, workspace);
+
+    return output;
+
+error:
+    if(workspace) {
+        workspace_give(plan, workspace);
+    }
+    return NULL;
+}
+
+// Activation of the last layer is outputs x samples
+static
+matrix *
+plan_fire(inference_plan *plan, plan_workspace *workspace, size_t samples, enum bool quantized, float *ranges) {
+    matrix *signal = workspace->signal;
+
+    check(quantized == false || workspace->products, "Workspace has no int8 buffers");
+
+    for(size_t layer = 0; layer < plan->count; layer++) {
+        plan_layer *current = &plan->layers[layer];
+        size_t dimension = current->dimension;
+        matrix *transfer = plan_bind(workspace->transfer, workspace->transfer->vector->values, dimension, samples, samples);
+        matrix *activation = plan_bind(workspace->activation[layer % 2], workspace->activation[layer % 2]->vector->values,
+                                       dimension, samples, samples);
+
+        if(ranges) {
+            for(size_t row = 0; row < signal->rows; row++) {
+                for(size_t column = 0; column < signal->columns; column++) {
+                    float value = MATRIX(signal, row, column);
+
+                    ranges[2 * layer] = value < ranges[2 * layer] ? value : ranges[2 * layer];
+                    ranges[2 * layer + 1] = value > ranges[2 * layer + 1] ? value : ranges[2 * layer + 1];
+                }
+            }
+        }
+
+        // Z = W * X + B, bias is written first and the product is added to it
+        for(size_t neuron = 0; neuron < dimension; neuron++) {
+            float bias = quantized ? current->quantized.bias[neuron] : VECTOR(current->bias, neuron);
+
+            for(size_t sample = 0; sample < samples; sample++) {
+                MATRIX(transfer, neuron, sample) = bias;
+            }
+        }
+
+        // Input is samples x inputs, activations are neurons x samples
+        if(quantized) {
+            check(plan_product(current, workspace, signal, layer > 0, transfer), "Int8 transfer of layer %zd failed", layer);
+        } else if(layer == 0) {
+            check(Matrix.gemm.abt(1, current->weight, signal, 1, transfer), "Transfer of layer %zd failed", layer);
+        } else {
+            check(Matrix.gemm.ab(1, current->weight, signal, 1, transfer), "Transfer of layer %zd failed", layer);
+        }
+
+        check(current->activate(transfer, activation), "Activation of layer %zd failed", layer);
+        signal = activation;
+    }
+
+    return signal;
+
+error:
+    return NULL;
+}
+
+static
+matrix *
+plan_bind(matrix *view, float *values, size_t rows, size_t columns, size_t stride) {
+    view->rows = rows;
+    view->columns = columns;
+    view->stride = stride;
+    view->vector->values = values;
+    view->vector->size = (rows - 1) * stride + columns;
+
+    return view;
+}
+
+
+/* Quantization */
+static
+inference_plan *
+plan_quantize(inference_plan *plan, data_set *calibration, enum bool per_channel) {
+    arena_mark heap = Arena.push(NULL);
+    float *ranges = NULL;
+    matrix *output = NULL;
+
+    check_memory(plan);
+    check_memory(calibration);
+    matrix_check_print(calibration->features.values, "For plan calibration");
+
+    // Ranges start from zero, so zero is coded exactly
+    ranges = calloc(2 * plan->count, sizeof(float));
+    output = Matrix.create(calibration->features.values->rows, plan->outputs);
+    check_memory(ranges);
+    check_memory(output);
+    check(plan_run(plan, calibration->features.values, output, false, ranges), "Calibration predict failed");
+
+    // Plan predicts float until every layer is coded
+    plan->quantized = false;
+    for(size_t layer = 0; layer < plan->count; layer++) {
+        plan_layer *current = &plan->layers[layer];
+        matrix *weight = current->weight;
+        float range = ranges[2 * layer + 1] - ranges[2 * layer];
+        float maximum = 0;
+
+        free(current->quantized.weight);
+        free(current->quantized.scale);
+        free(current->quantized.sums);
+        free(current->quantized.bias);
+        current->quantized.weight = malloc(weight->rows * weight->columns * sizeof(int8_t));
+        current->quantized.scale = malloc(weight->rows * sizeof(float));
+        current->quantized.sums = malloc(weight->rows * sizeof(int32_t));
+        current->quantized.bias = malloc(weight->rows * sizeof(float));
+        check_memory(current->quantized.weight);
+        check_memory(current->quantized.scale);
+        check_memory(current->quantized.sums);
+        check_memory(current->quantized.bias);
+        memcpy(current->quantized.bias, current->bias->values, weight->rows * sizeof(float));
+
+        current->quantized.input_scale = range > 0 ? range / GEMM_S8_MAX : 1;
+        long zero = lrintf(-ranges[2 * layer] / current->quantized.input_scale);
+        current->quantized.input_zero = (int32_t)(zero > GEMM_S8_MAX ? GEMM_S8_MAX : zero);
+
+        // Weight is symmetric, scale keeps absolute maximum of neuron first
+        for(size_t neuron = 0; neuron < weight->rows; neuron++) {
+            float absolute = 0;
+
+            for(size_t input = 0; input < weight->columns; input++) {
+                absolute = fmaxf(absolute, fabsf(MATRIX(weight, neuron, input)));
+            }
+            current->quantized.scale[neuron] = absolute;
+            maximum = fmaxf(maximum, absolute);
+        }
+
+        for(size_t neuron = 0; neuron < weight->rows; neuron++) {
+            float absolute = per_channel ? current->quantized.scale[neuron] : maximum;
+            float scale = absolute > 0 ? absolute / GEMM_S8_MAX : 1;
+            int8_t *row = current->quantized.weight + neuron * weight->columns;
+            int32_t sum = 0;
+
+            for(size_t input = 0; input < weight->columns; input++) {
+                long code = lrintf(MATRIX(weight, neuron, input) / scale);
+
+                row[input] = (int8_t)(code < -GEMM_S8_MAX ? -GEMM_S8_MAX : code > GEMM_S8_MAX ? GEMM_S8_MAX : code);
+                sum += row[input];
+            }
+            current->quantized.scale[neuron] = scale;
+            current->quantized.sums[neuron] = sum;
+        }
+    }
+
+    // Workspaces are in pool, predict doesn't run
+    for(plan_workspace *workspace = plan->workspaces; workspace; workspace = workspace->next) {
+        check(workspace_quantize(plan, workspace), "Workspace has no int8 buffers");
+    }
+    plan->quantized = true;
+
+    free(ranges);
+    Matrix.delete(output);
+    Arena.pop(heap);
+
+    return plan;
+
+error:
+    free(ranges);
+    if(output) {
+        Matrix.delete(output);
+    }
+    Arena.pop(heap);
+    return NULL;
+}
+
+// Signal is coded into samples x inputs, so rows of weight and codes
+// meet in int8 product. Sum of zero point is taken out by row sums
+static
+enum bool
+plan_product(plan_layer *layer, plan_workspace *workspace, matrix *signal, enum bool transposed, matrix *transfer) {
+    size_t dimension = transfer->rows;
+    size_t samples = transfer->columns;
+    size_t inputs = layer->inputs;
+    float scale = layer->quantized.input_scale;
+    float inverse = 1 / scale;
+    int32_t zero = layer->quantized.input_zero;
+
+    check(layer->quantized.weight, "Layer isn't quantized");
+
+    for(size_t sample = 0; sample < samples; sample++) {
+        uint8_t *codes = workspace->codes + sample * inputs;
+
+        for(size_t input = 0; input < inputs; input++) {
+            float value = transposed ? MATRIX(signal, input, sample) : MATRIX(signal, sample, input);
+            long code = lrintf(value * inverse) + zero;
+
+            codes[input] = (uint8_t)(code < 0 ? 0 : code > GEMM_S8_MAX ? GEMM_S8_MAX : code);
+        }
+    }
+
+    gemm_s8(dimension, samples, inputs, layer->quantized.weight, inputs,
+            workspace->codes, inputs, workspace->products, samples);
+
+    for(size_t neuron = 0; neuron < dimension; neuron++) {
+        float rescale = layer->quantized.scale[neuron] * scale;
+        int32_t offset = zero * layer->quantized.sums[neuron];
+        int32_t *products = workspace->products + neuron * samples;
+
+        for(size_t sample = 0; sample < samples; sample++) {
+            MATRIX(transfer, neuron, sample) += rescale * (float)(products[sample] - offset);
+        }
+    }
+
+    return true;
+
+error:
+    return false;
+}
+
+static
+float
+plan_accuracy_delta(inference_plan *plan, data_set *validation) {
+    arena_mark heap = Arena.push(NULL);
+
+    check_memory(plan);
+    check_memory(validation);
+    check(plan->quantized, "Plan isn't quantized");
+
+    float reference = plan_accuracy(plan, validation, false);
+    float accuracy = plan_accuracy(plan, validation, true);
+    check(reference >= 0 && accuracy >= 0, "Accuracy of plan isn't measured");
+
+    log_info("Float accuracy %.4f, int8 accuracy %.4f", reference, accuracy);
+    Arena.pop(heap);
+
+    return accuracy - reference;
+
+error:
+    Arena.pop(heap);
+    return NAN;
+}
+
+// Share of samples which largest output is at largest target, -1 on error
+static
+float
+plan_accuracy(inference_plan *plan, data_set *set, enum bool quantized) {
+    matrix *features = set->features.values;
+    matrix *target = set->target.values;
+    matrix *output = NULL;
+    size_t hits = 0;
+
+    matrix_check_print(features, "For plan accuracy");
+    matrix_check_print(target, "For plan accuracy");
+    check(features->rows && target->rows == features->rows && target->columns == plan->outputs,
+          "Target %zdx%zd doesn't fit %zd samples of %zd outputs", target->rows, target->columns, features->rows, plan->outputs);
+
+    output = Matrix.create(features->rows, plan->outputs);
+    check_memory(output);
+    check(plan_run(plan, features, output, quantized, NULL), "Plan predict failed");
+
+    for(size_t row = 0; row < features->rows; row++) {
+        size_t predicted = 0;
+        size_t expected = 0;
+
+        for(size_t column = 1; column < plan->outputs; column++) {
+            predicted = MATRIX(output, row, column) > MATRIX(output, row, predicted) ? column : predicted;
+            expected = MATRIX(target, row, column) > MATRIX(target, row, expected) ? column : expected;
+        }
+        hits += predicted == expected;
+    }
+
+    Matrix.delete(output);
+
+    return (float)hits / features->rows;
+
+error:
+    if(output) {
+        Matrix.delete(output);
+    }
+    return -1;
+}
+
+static
+inference_plan *
+plan_shrink(inference_plan *plan) {
+    check_memory(plan);
+    check(plan->quantized, "Only quantized plan drops float parameters");
+
+    for(size_t layer = 0; layer < plan->count; layer++) {
+        if(plan->layers[layer].weight) {
+            Matrix.delete(plan->layers[layer].weight);
+            plan->layers[layer].weight = NULL;
+        }
+        if(plan->layers[layer].bias) {
+            Vector.delete(plan->layers[layer].bias);
+            plan->layers[layer].bias = NULL;
+        }
+    }
+
+    if(plan->parameters) {
+        Vector.delete(plan->parameters);
+        plan->parameters = NULL;
+    }
+    if(plan->mapping.address) {
+        munmap(plan->mapping.address, plan->mapping.size);
+        plan->mapping.address = NULL;
+        plan->mapping.size = 0;
+    }
+
+    return plan;
+
+error:
+    return NULL;
+}
+
+
+/* Files */
+#define PLAN_FILE_PADDING(size) ((4 - (size) % 4) % 4)
+
+static
+enum bool
+plan_save(inference_plan *plan, char *filename) {
+    FILE *file = NULL;
+    uint32_t padding = 0;
+
+    check_memory(plan);
+    check(plan->quantized, "Only quantized plan is saved");
+
+    plan_file_header header = {
+        .magic = PLAN_FILE_MAGIC,
+        .version = PLAN_FILE_VERSION,
+        .layers = plan->count
+    };
+
+    file = fopen(filename, "wb");
+    check(file, "Can't open %s for writing", filename);
+    check(fwrite(&header, sizeof(plan_file_header), 1, file) == 1, "Header of %s isn't written", filename);
+
+    for(size_t layer = 0; layer < plan->count; layer++) {
+        plan_layer *current = &plan->layers[layer];
+        size_t dimension = current->dimension;
+        size_t size = dimension * current->inputs;
+        plan_file_layer record;
+        // Padding of record is written too
+        memset(&record, 0, sizeof(plan_file_layer));
+
+        record.dimension = dimension;
+        record.inputs = current->inputs;
+        record.kernel = current->kernel;
+        record.input_scale = current->quantized.input_scale;
+        record.input_zero = current->quantized.input_zero;
+
+        check(fwrite(&record, sizeof(plan_file_layer), 1, file) == 1
+              && fwrite(current->quantized.weight, sizeof(int8_t), size, file) == size
+              && fwrite(&padding, 1, PLAN_FILE_PADDING(size), file) == PLAN_FILE_PADDING(size)
+              && fwrite(current->quantized.scale, sizeof(float), dimension, file) == dimension
+              && fwrite(current->quantized.sums, sizeof(int32_t), dimension, file) == dimension
+              && fwrite(current->quantized.bias, sizeof(float), dimension, file) == dimension,
+              "Layer %zd of %s isn't written", layer, filename);
+    }
+
+    int closed = fclose(file);
+    file = NULL;
+    check(closed == 0, "Can't close %s", filename);
+
+    return true;
+
+error:
+    if(file) {
+        fclose(file);
+    }
+    return false;
+}
+
+// Sizes of layers are checked against file size before they are allocated
+static
+inference_plan *
+plan_load(char *filename, size_t capacity) {
+    arena_mark heap = Arena.push(NULL);
+    inference_plan *plan = NULL;
+    plan_file_header header;
+    struct stat status;
+    uint32_t padding = 0;
+    FILE *file = fopen(filename, "rb");
+    check(file, "Can't open %s", filename);
+
+    check(fstat(fileno(file), &status) == 0, "Can't stat %s", filename);
+    size_t size = status.st_size;
+
+    check(fread(&header, sizeof(plan_file_header), 1, file) == 1
+          && memcmp(header.magic, PLAN_FILE_MAGIC, sizeof(header.magic)) == 0, "%s isn't plan file", filename);
+    check(header.version == PLAN_FILE_VERSION, "%s has version %u, expected %u", filename, header.version, PLAN_FILE_VERSION);
+    check(header.layers && header.layers <= size / sizeof(plan_file_layer), "%s is broken or truncated", filename);
+
+    plan = plan_allocate(header.layers, capacity);
+    check_memory(plan);
+
+    for(size_t layer = 0; layer < plan->count; layer++) {
+        plan_layer *current = &plan->layers[layer];
+        plan_file_layer record;
+        neuron_kernel kernel;
+
+        check(fread(&record, sizeof(plan_file_layer), 1, file) == 1
+              && record.dimension && record.dimension <= size && record.inputs && record.inputs <= size
+              && record.dimension <= size / record.inputs
+              && (layer == 0 || record.inputs == plan->layers[layer - 1].dimension)
+              && isfinite(record.input_scale) && record.input_scale > 0
+              && record.input_zero >= 0 && record.input_zero <= GEMM_S8_MAX,
+              "Layer %zd of %s is broken or truncated", layer, filename);
+        check(Kernel.of(record.kernel, &kernel) && kernel.activation.layer,
+              "Kernel of layer %zd in %s is unknown", layer, filename);
+
+        size_t dimension = record.dimension;
+        size_t weight_size = dimension * record.inputs;
+        current->dimension = dimension;
+        current->inputs = record.inputs;
+        current->kernel = record.kernel;
+        current->activate = kernel.activation.layer;
+        current->quantized.input_scale = record.input_scale;
+        current->quantized.input_zero = record.input_zero;
+
+        current->quantized.weight = malloc(weight_size * sizeof(int8_t));
+        current->quantized.scale = malloc(dimension * sizeof(float));
+        current->quantized.sums = malloc(dimension * sizeof(int32_t));
+        current->quantized.bias = malloc(dimension * sizeof(float));
+        check_memory(current->quantized.weight);
+        check_memory(current->quantized.scale);
+        check_memory(current->quantized.sums);
+        check_memory(current->quantized.bias);
+
+        check(fread(current->quantized.weight, sizeof(int8_t), weight_size, file) == weight_size
+              && fread(&padding, 1, PLAN_FILE_PADDING(weight_size), file) == PLAN_FILE_PADDING(weight_size)
+              && fread(current->quantized.scale, sizeof(float), dimension, file) == dimension
+              && fread(current->quantized.sums, sizeof(int32_t), dimension, file) == dimension
+              && fread(current->quantized.bias, sizeof(float), dimension, file) == dimension,
+              "Layer %zd of %s is truncated", layer, filename);
+
+        plan->width = dimension > plan->width ? dimension : plan->width;
+        plan->depth = record.inputs > plan->depth ? record.inputs : plan->depth;
+    }
+
+    plan->inputs = plan->layers[0].inputs;
+    plan->outputs = plan->layers[plan->count - 1].dimension;
+    plan->quantized = true;
+    check(plan_reserve(plan, 1), "Plan has no workspace");
+
+    fclose(file);
+    Arena.pop(heap);
+
+    return plan;
+
+error:
+    if(file) {
+        fclose(file);
+    }
+    plan_delete(plan);
+    Arena.pop(heap);
+    return NULL;
+}
@@ -0,0 +1,160 @@
+//
+//  plan.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef plan_h
+#define plan_h
+
+#include <stdio.h>
+#include <pthread.h>
+#include "layer.h"
+#include "kernel.h"
+#include "../data/set.h"
+
+#define PLAN_CAPACITY 256
+
+/* Quantized plan file: header, then record and blocks of each layer.
+   Blocks are int8 weight padded to 4 bytes, float scale, int32 sums
+   and float bias, one value of each for neuron */
+#define PLAN_FILE_MAGIC     "NAIVEQP"
+#define PLAN_FILE_VERSION   1
+
+typedef struct {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    layers;
+} plan_file_header;
+
+typedef struct {
+    uint64_t    dimension;
+    uint64_t    inputs;
+    kernel_id   kernel;
+
+    float       input_scale;
+    int32_t     input_zero;
+} plan_file_layer;
+
+/* Read-only file mapped by loaded network which layers are viewing */
+typedef struct {
+    void *              address;
+    size_t              size;
+    int                 file;
+} plan_mapping;
+
+/* Layer of plan, weight and bias are views of parameters of plan,
+   NULL when float parameters are dropped */
+typedef struct {
+    matrix *            weight;
+    vector *            bias;
+    size_t              dimension;
+    size_t              inputs;
+
+    // Numbers of kernel and its whole layer activation
+    kernel_id           kernel;
+    matrix *            (*activate)(matrix *transfer, matrix *activation);
+
+    // Int8 weight with scale of each neuron and sum of each its row, bias
+    // is copied. Layer input is coded as (value / scale + zero) in 0...GEMM_S8_MAX
+    struct {
+        int8_t *        weight;
+        float *         scale;
+        int32_t *       sums;
+        float *         bias;
+
+        float           input_scale;
+        int32_t         input_zero;
+    } quantized;
+} plan_layer;
+
+/* Buffers of one predict. Transfer and activations are neurons x samples
+   views of scratch, shaped for each layer. Signal and result view rows
+   of input and output for each part of batch */
+typedef struct plan_workspace {
+    vector *            scratch;
+    matrix *            transfer;
+    matrix *            activation[2];
+
+    matrix *            signal;
+    matrix *            result;
+
+    // Int8 predict codes samples x inputs of layer and takes
+    // neurons x samples products, allocated when plan is quantized
+    uint8_t *           codes;
+    int32_t *           products;
+
+    // Next free workspace of pool
+    struct plan_workspace *next;
+} plan_workspace;
+
+/* Inference of trained dense network without cells and training state,
+   parameters of all layers are copied into one block or viewed in own
+   mapping of network file. Plan is only read by predict, so threads
+   predict with one plan at once */
+typedef struct {
+    plan_layer *        layers;
+    size_t              count;
+    vector *            parameters;
+    // Pages of network file, NULL when parameters are copied
+    struct {
+        void *          address;
+        size_t          size;
+    }                   mapping;
+
+    size_t              inputs;
+    size_t              outputs;
+    // Samples fired at once, bigger batch is predicted by parts
+    size_t              capacity;
+    size_t              width;
+    // Inputs of the widest layer input
+    size_t              depth;
+    // Predict runs int8 product of layers
+    enum bool           quantized;
+
+    // Each predict takes free workspace and gives it back, pool grows
+    // to count of predicts running at once
+    pthread_mutex_t     lock;
+    plan_workspace *    workspaces;
+    size_t              created;
+} inference_plan;
+
+
+/* Library methods */
+struct plan_library {
+    // Layers have to be shaped and fire by whole layer activation,
+    // zero capacity is default of PLAN_CAPACITY. Layers which view mapped
+    // file are viewed in the same pages of it, NULL mapping copies them
+    inference_plan *     (*create)(dense_layer **layers, size_t count, size_t capacity, plan_mapping *mapping);
+    void                 (*delete)(inference_plan *plan);
+
+    // Workspaces are created ahead for count of threads, so predict
+    // doesn't allocate
+    inference_plan *     (*reserve)(inference_plan *plan, size_t workspaces);
+
+    // Input is samples x inputs, output gets samples x outputs.
+    // Reentrant, each call works in own workspace
+    matrix *             (*predict)(inference_plan *plan, matrix *input, matrix *output);
+
+    // Post-training quantization, ranges of layer inputs are taken by float
+    // predict of calibration features, weight scale is for each neuron or
+    // for whole layer. Float parameters are kept. Not reentrant with predict
+    inference_plan *     (*quantize)(inference_plan *plan, data_set *calibration, enum bool per_channel);
+    // Accuracy of int8 predict less accuracy of float one on set with
+    // binary target, both are logged
+    float                (*accuracy_delta)(inference_plan *plan, data_set *validation);
+    // Quantized plan drops float parameters after calibration, then it's
+    // only predicted by int8 and can't be quantized again
+    inference_plan *     (*shrink)(inference_plan *plan);
+
+    // Quantized plan is written without float parameters, loaded plan
+    // is shrunk. NULL when file is broken
+    enum bool            (*save)(inference_plan *plan, char *filename);
+    inference_plan *     (*load)(char *filename, size_t capacity);
+};
+
+extern const struct plan_library Plan;
+
+#endif /* plan_h */
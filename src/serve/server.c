@@ -0,0 +1,511 @@
+//
+//  server.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+#include "../math/gemm.h"
+
+static inference_server *   server_create(inference_plan *plan, char *path, size_t max_batch, size_t max_wait);
+static void                 server_delete(inference_server *server);
+static int                  client_connect(char *path);
+static enum bool            client_predict(int connection, float *features, size_t inputs, float *output, size_t outputs);
+
+static void                 server_release(inference_server *server);
+static void *               server_accept_loop(void *argument);
+static void *               server_connection_loop(void *argument);
+static void *               server_batch_loop(void *argument);
+static enum bool            server_submit(inference_server *server, server_request *request);
+static enum bool            server_fire(inference_server *server, server_request *batch, size_t count);
+static void                 server_answer(server_request *batch, size_t count, enum bool failed);
+
+static int                  server_socket(char *path, struct sockaddr_un *address);
+static enum bool            server_read(int socket, void *buffer, size_t size);
+static enum bool            server_write(int socket, const void *buffer, size_t size);
+static uint64_t             server_now(void);
+
+
+/* Library Structure */
+const struct server_library Server = {
+    .create = server_create,
+    .delete = server_delete,
+
+    .client = {
+        .connect = client_connect,
+        .predict = client_predict
+    }
+};
+
+
+/* Life Cycle */
+static
+inference_server *
+server_create(inference_plan *plan, char *path, size_t max_batch, size_t max_wait) {
+    arena_mark heap = Arena.push(NULL);
+    inference_server *server = NULL;
+    struct sockaddr_un address;
+    pthread_condattr_t clock;
+
+    check_memory(plan);
+    check_memory(path);
+
+    server = calloc(1, sizeof(inference_server));
+    check_memory(server);
+
+    server->plan = plan;
+    server->socket = -1;
+    server->max_batch = max_batch ? max_batch : SERVER_BATCH;
+    server->max_wait = max_wait ? max_wait : SERVER_WAIT;
+
+    server->path = malloc(strlen(path) + 1);
+    server->input = Matrix.create(server->max_batch, plan->inputs);
+    server->output = Matrix.create(server->max_batch, plan->outputs);
+    check_memory(server->path);
+    check_memory(server->input);
+    check_memory(server->output);
+    memcpy(server->path, path, strlen(path) + 1);
+
+    server->socket = server_socket(path, &address);
+    check(server->socket >= 0, "Can't create socket for %s", path);
+    // Socket of stopped server is left by it
+    unlink(path);
+    check(bind(server->socket, (struct sockaddr *)&address, sizeof(address)) == 0, "Can't bind %s", path);
+    check(listen(server->socket, SOMAXCONN) == 0, "Can't listen on %s", path);
+
+    // Deadline of batch is taken from monotonic clock
+    pthread_condattr_init(&clock);
+    pthread_condattr_setclock(&clock, CLOCK_MONOTONIC);
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->ready, &clock);
+    pthread_cond_init(&server->done, NULL);
+    pthread_condattr_destroy(&clock);
+
+    if(pthread_create(&server->batcher, NULL, server_batch_loop, server) != 0) {
+        server_release(server);
+        log_error("Batch thread isn't started");
+        Arena.pop(heap);
+        return NULL;
+    }
+
+    if(pthread_create(&server->acceptor, NULL, server_accept_loop, server) != 0) {
+        pthread_mutex_lock(&server->lock);
+        server->stop = true;
+        pthread_cond_broadcast(&server->ready);
+        pthread_mutex_unlock(&server->lock);
+        pthread_join(server->batcher, NULL);
+
+        server_release(server);
+        log_error("Accept thread isn't started");
+        Arena.pop(heap);
+        return NULL;
+    }
+
+    Arena.pop(heap);
+
+    return server;
+
+error:
+    if(server) {
+        if(server->socket >= 0) {
+            close(server->socket);
+        }
+        if(server->input) {
+            Matrix.delete(server->input);
+        }
+        if(server->output) {
+            Matrix.delete(server->output);
+        }
+        free(server->path);
+        free(server);
+    }
+    Arena.pop(heap);
+    return NULL;
+}
+
+// Waiting requests fail, connections are shut down and their threads finish
+static
+void
+server_delete(inference_server *server) {
+    check_memory(server);
+
+    pthread_mutex_lock(&server->lock);
+    server->stop = true;
+    pthread_cond_broadcast(&server->ready);
+    pthread_mutex_unlock(&server->lock);
+
+    // Shut down listening socket wakes accept
+    shutdown(server->socket, SHUT_RDWR);
+    pthread_join(server->acceptor, NULL);
+    pthread_join(server->batcher, NULL);
+
+    pthread_mutex_lock(&server->lock);
+    for(server_connection *connection = server->connections; connection; connection = connection->next) {
+        shutdown(connection->socket, SHUT_RDWR);
+    }
+    while(server->connections) {
+        pthread_cond_wait(&server->done, &server->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    server_release(server);
+
+error:
+    return;
+}
+
+static
+void
+server_release(inference_server *server) {
+    close(server->socket);
+    unlink(server->path);
+
+    pthread_cond_destroy(&server->done);
+    pthread_cond_destroy(&server->ready);
+    pthread_mutex_destroy(&server->lock);
+
+    Matrix.delete(server->input);
+    Matrix.delete(server->output);
+    free(server->path);
+    free(server);
+}
+
+
+/* Threads */
+static
+void *
+server_accept_loop(void *argument) {
+    inference_server *server = argument;
+
+    while(true) {
+        int socket = accept(server->socket, NULL, NULL);
+        if(socket < 0 && errno == EINTR) {
+            continue;
+        }
+        if(socket < 0) {
+            break;
+        }
+
+        server_connection *connection = calloc(1, sizeof(server_connection));
+        if(connection == NULL) {
+            close(socket);
+            continue;
+        }
+        connection->server = server;
+        connection->socket = socket;
+
+        pthread_mutex_lock(&server->lock);
+        if(server->stop) {
+            pthread_mutex_unlock(&server->lock);
+            close(socket);
+            free(connection);
+            break;
+        }
+
+        if(pthread_create(&connection->thread, NULL, server_connection_loop, connection) == 0) {
+            connection->next = server->connections;
+            server->connections = connection;
+        } else {
+            log_warning("Connection thread isn't started");
+            close(socket);
+            free(connection);
+        }
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    return NULL;
+}
+
+// Request with wrong count of features is answered with zero count
+// and connection is closed, since its stream can't be read further
+static
+void *
+server_connection_loop(void *argument) {
+    server_connection *connection = argument;
+    inference_server *server = connection->server;
+    size_t inputs = server->plan->inputs;
+    size_t outputs = server->plan->outputs;
+    float *features = malloc(inputs * sizeof(float));
+    float *output = malloc(outputs * sizeof(float));
+    uint32_t count = 0;
+
+    pthread_detach(pthread_self());
+
+    while(features && output && server_read(connection->socket, &count, sizeof(count))) {
+        server_request request = { .features = features, .output = output };
+        enum bool valid = count == inputs;
+
+        if(valid && server_read(connection->socket, features, inputs * sizeof(float)) == false) {
+            break;
+        }
+
+        uint32_t answer = valid && server_submit(server, &request) ? outputs : 0;
+        if(server_write(connection->socket, &answer, sizeof(answer)) == false
+           || (answer && server_write(connection->socket, output, outputs * sizeof(float)) == false)
+           || valid == false) {
+            break;
+        }
+    }
+
+    free(features);
+    free(output);
+
+    pthread_mutex_lock(&server->lock);
+    server_connection **slot = &server->connections;
+    while(*slot != connection) {
+        slot = &(*slot)->next;
+    }
+    *slot = connection->next;
+    pthread_cond_broadcast(&server->done);
+    pthread_mutex_unlock(&server->lock);
+
+    close(connection->socket);
+    free(connection);
+
+    return NULL;
+}
+
+// Batch is fired when it's full or its oldest request waited max wait
+static
+void *
+server_batch_loop(void *argument) {
+    inference_server *server = argument;
+
+    pthread_mutex_lock(&server->lock);
+    while(true) {
+        while(server->stop == false && server->pending == 0) {
+            pthread_cond_wait(&server->ready, &server->lock);
+        }
+
+        uint64_t deadline = server->stop ? 0 : server->head->arrival + server->max_wait;
+        struct timespec until = { .tv_sec = deadline / 1000000, .tv_nsec = (deadline % 1000000) * 1000 };
+
+        while(server->stop == false && server->pending < server->max_batch
+              && pthread_cond_timedwait(&server->ready, &server->lock, &until) != ETIMEDOUT) {
+        }
+
+        if(server->stop) {
+            break;
+        }
+
+        server_request *batch = server->head;
+        size_t count = server->pending < server->max_batch ? server->pending : server->max_batch;
+        server_request *last = batch;
+        for(size_t index = 1; index < count; index++) {
+            last = last->next;
+        }
+
+        server->head = last->next;
+        if(server->head == NULL) {
+            server->tail = NULL;
+        }
+        server->pending -= count;
+        pthread_mutex_unlock(&server->lock);
+
+        enum bool fired = server_fire(server, batch, count);
+
+        pthread_mutex_lock(&server->lock);
+        server_answer(batch, count, fired == false);
+        server->batches++;
+        server->requests += count;
+        pthread_cond_broadcast(&server->done);
+    }
+
+    server_answer(server->head, server->pending, true);
+    server->head = server->tail = NULL;
+    server->pending = 0;
+    pthread_cond_broadcast(&server->done);
+    pthread_mutex_unlock(&server->lock);
+
+    // Buffers of the thread would be lost with it
+    gemm_release();
+    Arena.delete(Arena.scratch());
+
+    return NULL;
+}
+
+// Caller waits until batch with its request is answered
+static
+enum bool
+server_submit(inference_server *server, server_request *request) {
+    pthread_mutex_lock(&server->lock);
+    if(server->stop) {
+        pthread_mutex_unlock(&server->lock);
+        return false;
+    }
+
+    request->arrival = server_now();
+    request->next = NULL;
+    if(server->tail) {
+        server->tail->next = request;
+    } else {
+        server->head = request;
+    }
+    server->tail = request;
+    server->pending++;
+    pthread_cond_signal(&server->ready);
+
+    while(request->done == false) {
+        pthread_cond_wait(&server->done, &server->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    return request->failed == false;
+}
+
+// Requests of batch are rows of one input, their outputs are rows of result
+static
+enum bool
+server_fire(inference_server *server, server_request *batch, size_t count) {
+    size_t inputs = server->plan->inputs;
+    size_t outputs = server->plan->outputs;
+    matrix *input = Matrix.slice.block(server->input, 0, 0, count, inputs);
+    matrix *output = Matrix.slice.block(server->output, 0, 0, count, outputs);
+    enum bool fired = false;
+    check_memory(input);
+    check_memory(output);
+
+    server_request *request = batch;
+    for(size_t row = 0; row < count; row++, request = request->next) {
+        memcpy(&MATRIX(input, row, 0), request->features, inputs * sizeof(float));
+    }
+
+    fired = Plan.predict(server->plan, input, output) != NULL;
+
+    request = batch;
+    for(size_t row = 0; fired && row < count; row++, request = request->next) {
+        memcpy(request->output, &MATRIX(output, row, 0), outputs * sizeof(float));
+    }
+
+error:
+    if(input) {
+        Matrix.delete(input);
+    }
+    if(output) {
+        Matrix.delete(output);
+    }
+    return fired;
+}
+
+// Answered request belongs to its connection again, so next is taken first
+static
+void
+server_answer(server_request *batch, size_t count, enum bool failed) {
+    for(size_t index = 0; index < count; index++) {
+        server_request *next = batch->next;
+
+        batch->failed = failed;
+        batch->done = true;
+        batch = next;
+    }
+}
+
+
+/* Client */
+static
+int
+client_connect(char *path) {
+    struct sockaddr_un address;
+    int connection = server_socket(path, &address);
+    check(connection >= 0, "Can't create socket for %s", path);
+    check(connect(connection, (struct sockaddr *)&address, sizeof(address)) == 0, "Can't connect to %s", path);
+
+    return connection;
+
+error:
+    if(connection >= 0) {
+        close(connection);
+    }
+    return -1;
+}
+
+static
+enum bool
+client_predict(int connection, float *features, size_t inputs, float *output, size_t outputs) {
+    uint32_t count = inputs;
+
+    check(server_write(connection, &count, sizeof(count))
+          && server_write(connection, features, inputs * sizeof(float))
+          && server_read(connection, &count, sizeof(count)),
+          "Request isn't sent");
+    check(count == outputs, "Response has %u outputs, expected %zd", count, outputs);
+    check(server_read(connection, output, outputs * sizeof(float)), "Response isn't received");
+
+    return true;
+
+error:
+    return false;
+}
+
+
+/* Socket */
+static
+int
+server_socket(char *path, struct sockaddr_un *address) {
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    check(strlen(path) < sizeof(address->sun_path), "Socket path %s is too long", path);
+    memcpy(address->sun_path, path, strlen(path) + 1);
+
+    return socket(AF_UNIX, SOCK_STREAM, 0);
+
+error:
+    return -1;
+}
+
+static
+enum bool
+server_read(int socket, void *buffer, size_t size) {
+    char *position = buffer;
+
+    while(size) {
+        ssize_t count = recv(socket, position, size, 0);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count <= 0) {
+            return false;
+        }
+
+        position += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+// Closed peer is an error of write, not a signal
+static
+enum bool
+server_write(int socket, const void *buffer, size_t size) {
+    const char *position = buffer;
+
+    while(size) {
+        ssize_t count = send(socket, position, size, MSG_NOSIGNAL);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count <= 0) {
+            return false;
+        }
+
+        position += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+static
+uint64_t
+server_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
@@ -0,0 +1,96 @@
+//
+//  server.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef server_h
+#define server_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../neural/plan.h"
+
+#define SERVER_BATCH    64
+// Microseconds the oldest request waits for batch to fill
+#define SERVER_WAIT     500
+
+/* Wire format of UNIX socket: request is uint32 count of features and
+   float32 features, response is uint32 count of outputs and float32
+   outputs. Response of failed request has zero count */
+
+/* Request of connection waiting in queue, rows of batch are copied
+   from features and back to output */
+typedef struct server_request {
+    float *             features;
+    float *             output;
+    // Microseconds of monotonic clock when request came
+    uint64_t            arrival;
+
+    enum bool           done;
+    enum bool           failed;
+    struct server_request *next;
+} server_request;
+
+typedef struct server_connection {
+    struct inference_server *server;
+    int                 socket;
+    pthread_t           thread;
+    struct server_connection *next;
+} server_connection;
+
+/* Thread of each connection reads its requests into queue, batcher takes
+   up to max batch of them at once and fires plan with one batch */
+typedef struct inference_server {
+    inference_plan *    plan;
+    char *              path;
+    int                 socket;
+
+    size_t              max_batch;
+    size_t              max_wait;
+
+    pthread_t           acceptor;
+    pthread_t           batcher;
+    pthread_mutex_t     lock;
+    // Request came, or server stops
+    pthread_cond_t      ready;
+    // Batch is answered
+    pthread_cond_t      done;
+
+    server_request *    head;
+    server_request *    tail;
+    size_t              pending;
+    server_connection * connections;
+    enum bool           stop;
+
+    // Max batch x inputs and max batch x outputs
+    matrix *            input;
+    matrix *            output;
+
+    // Count of batches and requests answered by them
+    size_t              batches;
+    size_t              requests;
+} inference_server;
+
+
+/* Library methods */
+struct server_library {
+    // Listens on path and serves plan by threads until delete, zero
+    // max batch and max wait are defaults. Plan stays owned by the caller
+    inference_server *   (*create)(inference_plan *plan, char *path, size_t max_batch, size_t max_wait);
+    void                 (*delete)(inference_server *server);
+
+    struct {
+        // Socket of connection, -1 when server isn't there
+        int              (*connect)(char *path);
+        // Blocks until output gets response, false when request failed
+        enum bool        (*predict)(int connection, float *features, size_t inputs, float *output, size_t outputs);
+    } client;
+};
+
+extern const struct server_library Server;
+
+#endif /* server_h */
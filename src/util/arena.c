@@ -0,0 +1,220 @@
+//
+//  arena.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include "arena.h"
+#include "macros.h"
+
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+#define ARENA_BLOCK_DATA(block) ((char *)(block) + ARENA_ALIGN(sizeof(arena_block)))
+
+static memory_arena *       arena_create(size_t block_size);
+static void                 arena_delete(memory_arena *arena);
+static void *               arena_alloc(memory_arena *arena, size_t size);
+static arena_mark           arena_push(memory_arena *arena);
+static void                 arena_pop(arena_mark mark);
+static void                 arena_reset(memory_arena *arena);
+static memory_arena *       arena_current(void);
+static memory_arena *       arena_scratch(void);
+
+static arena_block *        arena_block_take(memory_arena *arena, size_t size);
+static void                 arena_blocks_free(arena_block *block);
+static void                 arena_rewind(memory_arena *arena, arena_block *block, size_t used);
+
+
+static _Thread_local memory_arena *active = NULL;
+static _Thread_local memory_arena *scratch = NULL;
+
+
+/* Library Structure */
+const struct arena_library Arena = {
+    .create = arena_create,
+    .delete = arena_delete,
+
+    .alloc = arena_alloc,
+
+    .push = arena_push,
+    .pop = arena_pop,
+    .reset = arena_reset,
+
+    .current = arena_current,
+    .scratch = arena_scratch
+};
+
+
+/* Life Cycle */
+static
+memory_arena *
+arena_create(size_t block_size) {
+    memory_arena *arena = calloc(1, sizeof(memory_arena));
+    check_memory(arena);
+
+    arena->block_size = block_size ? block_size : ARENA_BLOCK_SIZE;
+
+    return arena;
+
+error:
+    return NULL;
+}
+
+static
+void
+arena_delete(memory_arena *arena) {
+    check_memory(arena);
+
+    if(active == arena) {
+        active = NULL;
+    }
+    if(scratch == arena) {
+        scratch = NULL;
+    }
+
+    arena_blocks_free(arena->blocks);
+    arena_blocks_free(arena->spare);
+    free(arena);
+
+error:
+    return;
+}
+
+static
+void
+arena_blocks_free(arena_block *block) {
+    while(block) {
+        arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+
+/* Allocation */
+static
+void *
+arena_alloc(memory_arena *arena, size_t size) {
+    check_memory(arena);
+
+    size = ARENA_ALIGN(size ? size : 1);
+
+    arena_block *block = arena->blocks;
+
+    if(block == NULL || block->size - block->used < size) {
+        block = arena_block_take(arena, size);
+        check_memory(block);
+    }
+
+    void *memory = ARENA_BLOCK_DATA(block) + block->used;
+    block->used += size;
+
+    return memory;
+
+error:
+    return NULL;
+}
+
+// Spare block is reused when it's big enough, otherwise new one is allocated
+static
+arena_block *
+arena_block_take(memory_arena *arena, size_t size) {
+    arena_block **slot = &arena->spare;
+
+    while(*slot && (*slot)->size < size) {
+        slot = &(*slot)->next;
+    }
+
+    arena_block *block = *slot;
+
+    if(block) {
+        *slot = block->next;
+    } else {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+
+        block = aligned_alloc(ARENA_ALIGNMENT, ARENA_ALIGN(sizeof(arena_block)) + block_size);
+        check_memory(block);
+        block->size = block_size;
+    }
+
+    block->used = 0;
+    block->next = arena->blocks;
+    arena->blocks = block;
+
+    return block;
+
+error:
+    return NULL;
+}
+
+
+/* Scopes */
+static
+arena_mark
+arena_push(memory_arena *arena) {
+    arena_mark mark = {
+        .arena = arena,
+        .block = arena ? arena->blocks : NULL,
+        .used = arena && arena->blocks ? arena->blocks->used : 0,
+        .previous = active
+    };
+
+    active = arena;
+
+    return mark;
+}
+
+static
+void
+arena_pop(arena_mark mark) {
+    if(mark.arena) {
+        arena_rewind(mark.arena, mark.block, mark.used);
+    }
+
+    active = mark.previous;
+}
+
+static
+void
+arena_reset(memory_arena *arena) {
+    check_memory(arena);
+
+    arena_rewind(arena, NULL, 0);
+
+error:
+    return;
+}
+
+// Blocks taken after mark become spare, marked block is cut to its old size
+static
+void
+arena_rewind(memory_arena *arena, arena_block *block, size_t used) {
+    while(arena->blocks && arena->blocks != block) {
+        arena_block *released = arena->blocks;
+
+        arena->blocks = released->next;
+        released->next = arena->spare;
+        arena->spare = released;
+    }
+
+    if(arena->blocks) {
+        arena->blocks->used = used;
+    }
+}
+
+static
+memory_arena *
+arena_current(void) {
+    return active;
+}
+
+static
+memory_arena *
+arena_scratch(void) {
+    if(scratch == NULL) {
+        scratch = arena_create(0);
+    }
+
+    return scratch;
+}
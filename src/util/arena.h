@@ -0,0 +1,62 @@
+//
+//  arena.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef arena_h
+#define arena_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT  64
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+typedef struct arena_block {
+    struct arena_block  *next;
+    size_t              size;
+    size_t              used;
+} arena_block;
+
+/* Bump allocator, memory is given back in bulk by pop or reset
+   and blocks are kept for the next allocations */
+typedef struct memory_arena {
+    arena_block         *blocks;
+    arena_block         *spare;
+    size_t              block_size;
+} memory_arena;
+
+/* Position of arena and allocator which was active before push */
+typedef struct {
+    memory_arena        *arena;
+    arena_block         *block;
+    size_t              used;
+    memory_arena        *previous;
+} arena_mark;
+
+
+/* Library methods */
+struct arena_library {
+    memory_arena *       (*create)(size_t block_size);
+    void                 (*delete)(memory_arena *arena);
+
+    void *               (*alloc)(memory_arena *arena, size_t size);
+
+    // Vector and matrix of the thread are allocated from arena until pop,
+    // NULL arena is a scope where they are allocated on heap again
+    arena_mark           (*push)(memory_arena *arena);
+    void                 (*pop)(arena_mark mark);
+    void                 (*reset)(memory_arena *arena);
+
+    memory_arena *       (*current)(void);
+    // Own arena of each thread for temporaries of library
+    memory_arena *       (*scratch)(void);
+};
+
+extern const struct arena_library Arena;
+
+#endif /* arena_h */
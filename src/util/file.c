@@ -0,0 +1,21 @@
+//
+//  file.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include "file.h"
+
+/* Mapped files */
+enum bool mapped_block_fits(uint64_t offset, uint64_t rows, uint64_t columns, size_t size)
+{
+    if(offset > size) {
+        return false;
+    }
+
+    uint64_t count = (size - offset) / sizeof(float);
+
+    return columns == 0 || rows <= count / columns;
+}
@@ -0,0 +1,20 @@
+//
+//  file.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef file_h
+#define file_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include "macros.h"
+
+// Block of rows x columns floats at offset lies in size bytes of mapped
+// file, values of file header can't wrap the bounds
+enum bool mapped_block_fits(uint64_t offset, uint64_t rows, uint64_t columns, size_t size);
+
+#endif /* file_h */
@@ -17,6 +17,21 @@
 
 #define DEBUG 1
 
+/* Validation of arguments by *_check macros is compiled out with NDEBUG,
+   PARANOID keeps it and also scans results for NaN and infinity. NULL
+   checks stay in every build, they are checks of failed allocations */
+#ifdef PARANOID
+#define PARANOID_CHECKS 1
+#else
+#define PARANOID_CHECKS 0
+#endif
+
+#if defined(NDEBUG) && !PARANOID_CHECKS
+#define VALIDATION 0
+#else
+#define VALIDATION 1
+#endif
+
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
 
 #define log_print(type, message, ...) do { if(DEBUG) printf("[" type "] " message "\n", ##__VA_ARGS__); } while(0)
@@ -33,13 +48,24 @@
 #define check(expression, message, ...) do { if(DEBUG && !(expression)) push_error(message, ##__VA_ARGS__) } while(0)
 #define check_memory_print(variable, message, ...) check((variable), "Out of memory. " message, ##__VA_ARGS__)
 #define check_memory(variable) check_memory_print(variable, "")
+#define check_valid(expression, message, ...) do { if(VALIDATION && !(expression)) push_error(message, ##__VA_ARGS__) } while(0)
 #define check_debug(expression, message, ...) if(!(expression)) { debug(message, ##__VA_ARGS__); }
 #define sentinel(message, ...) push_error(message, ##__VA_ARGS__)
 
 
-// Weird predefined struct type cheker
-#define TYPE_INDEX 116 // "t" = 116 t_Vector, t_Matrix
-#define IS(type, typeName) (*(char*)type != 0 && (*(*(char**)type)) == TYPE_INDEX && strcmp(*(char **)type, typeName) == 0)
+// Type tag is the first field of library structures. Tags are signaling NaN
+// patterns, so pointer to plain float is never taken for tagged instance
+enum type_tag {
+    NUMBER_TYPE = 0x7FA0E001,
+    VECTOR_TYPE,
+    VECTOR_HASH_TYPE,
+    MATRIX_TYPE,
+    TENSOR_TYPE,
+    PROBABILITY_TYPE,
+    CSV_TYPE
+};
+
+#define IS(instance, tag) (*(enum type_tag *)(instance) == (tag))
 
 
 #define EVAL0(...) __VA_ARGS__
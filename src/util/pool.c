@@ -0,0 +1,178 @@
+//
+//  pool.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#include <unistd.h>
+#include "pool.h"
+
+typedef struct {
+    thread_pool *       pool;
+    size_t              index;
+} pool_worker;
+
+static thread_pool *        pool_create(size_t size);
+static void                 pool_delete(thread_pool *pool);
+static void                 pool_run(thread_pool *pool, pool_job job, void *context);
+static size_t               pool_cores(void);
+
+static void *               pool_worker_loop(void *argument);
+
+
+/* Library Structure */
+const struct pool_library Pool = {
+    .create = pool_create,
+    .delete = pool_delete,
+
+    .run = pool_run,
+
+    .cores = pool_cores
+};
+
+
+/* Life Cycle */
+static
+thread_pool *
+pool_create(size_t size) {
+    thread_pool *pool = calloc(1, sizeof(thread_pool));
+    check_memory(pool);
+
+    pool->size = size ? size : pool_cores();
+    pool->threads = calloc(pool->size, sizeof(pthread_t));
+    check_memory(pool->threads);
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for(size_t index = 1; index < pool->size; index++) {
+        pool_worker *worker = malloc(sizeof(pool_worker));
+        check_memory(worker);
+        worker->pool = pool;
+        worker->index = index;
+
+        if(pthread_create(&pool->threads[index], NULL, pool_worker_loop, worker) != 0) {
+            free(worker);
+            // Workers which are already started are still usable
+            log_warning("Thread pool has %zd workers instead of %zd", index, pool->size);
+            pool->size = index;
+            break;
+        }
+    }
+
+    return pool;
+
+error:
+    if(pool) {
+        free(pool->threads);
+    }
+    free(pool);
+    return NULL;
+}
+
+static
+void
+pool_delete(thread_pool *pool) {
+    check_memory(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(size_t index = 1; index < pool->size; index++) {
+        pthread_join(pool->threads[index], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+
+    free(pool->threads);
+    free(pool);
+
+error:
+    return;
+}
+
+
+/* Jobs */
+static
+void
+pool_run(thread_pool *pool, pool_job job, void *context) {
+    check_memory(pool);
+    check_memory(job);
+
+    if(pool->size > 1) {
+        pthread_mutex_lock(&pool->lock);
+        pool->job = job;
+        pool->context = context;
+        pool->pending = pool->size - 1;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    job(context, 0, pool->size);
+
+    if(pool->size > 1) {
+        pthread_mutex_lock(&pool->lock);
+        while(pool->pending) {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+error:
+    return;
+}
+
+static
+void *
+pool_worker_loop(void *argument) {
+    pool_worker *worker = argument;
+    thread_pool *pool = worker->pool;
+    size_t index = worker->index;
+    size_t generation = 0;
+
+    free(worker);
+
+    pthread_mutex_lock(&pool->lock);
+    while(true) {
+        while(pool->stop == false && pool->generation == generation) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+
+        if(pool->stop) {
+            break;
+        }
+
+        generation = pool->generation;
+        pool_job job = pool->job;
+        void *context = pool->context;
+        pthread_mutex_unlock(&pool->lock);
+
+        job(context, index, pool->size);
+
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+
+/* Properties */
+static
+size_t
+pool_cores(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cores > 0 ? (size_t)cores : 1;
+}
@@ -0,0 +1,53 @@
+//
+//  pool.h
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+
+#ifndef pool_h
+#define pool_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "macros.h"
+
+/* Job of each worker, worker index is from 0 to workers - 1 */
+typedef void (*pool_job)(void *context, size_t worker, size_t workers);
+
+/* Persistent workers waiting for the next job, thread which runs
+   the job is worker 0, so pool of one worker has no threads */
+typedef struct {
+    size_t              size;
+    pthread_t *         threads;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      start;
+    pthread_cond_t      done;
+
+    pool_job            job;
+    void *              context;
+    // Incremented by each run, workers wake up when it changes
+    size_t              generation;
+    size_t              pending;
+    enum bool           stop;
+} thread_pool;
+
+
+/* Library methods */
+struct pool_library {
+    // Zero size is one worker for each online core
+    thread_pool *        (*create)(size_t size);
+    void                 (*delete)(thread_pool *pool);
+
+    // Returns when every worker has finished the job
+    void                 (*run)(thread_pool *pool, pool_job job, void *context);
+
+    size_t               (*cores)(void);
+};
+
+extern const struct pool_library Pool;
+
+#endif /* pool_h */
@@ -1,5 +1,6 @@
 #include "unit.h"
 #include <data/set.h>
+#include <data/loader.h>
 
 data_set set;
 matrix *binary_target;
@@ -17,7 +18,7 @@ error:
 
 char *iris_load() {
     char *target_labels[] = {"species", NULL};
-    set = Data.csv("/Users/fefa4ka/Development/math/math/dataset/iris.csv", NULL, target_labels);
+    set = Data.csv("./test/data/iris.csv", NULL, target_labels);
     char *iris_test = data_set_test(set);
     test_assert(iris_test == NULL, "Iris data set corrupted");    
 
@@ -42,6 +43,179 @@ char *data_from_matrix() {
     return NULL;
 }
 
+char *data_file() {
+    char *filename = "/tmp/naive_iris_test.data";
+    data_set iris_binary = Data.matrix(set.features.values, binary_target);
+    test_assert(Data.file.write(&iris_binary, filename), "Data set isn't written");
+
+    data_set mapped = Data.file.map(filename);
+    test_assert(mapped.mapping.address, "Data set isn't mapped");
+    test_assert(((size_t)mapped.features.values->vector->values & (DATA_FILE_ALIGNMENT - 1)) == 0, "Features aren't page aligned");
+    test_assert(Matrix.rel.is_equal(mapped.features.values, iris_binary.features.values), "Mapped features differ");
+    test_assert(Matrix.rel.is_equal(mapped.target.values, iris_binary.target.values), "Mapped target differs");
+    test_assert(strcmp(mapped.target.labels[binary_target->columns - 1], iris_binary.target.labels[binary_target->columns - 1]) == 0
+                && mapped.target.labels[binary_target->columns] == NULL, "Mapped labels differ");
+
+    // Batches view mapped pages
+    data_batch batches = Data.split(&mapped, 10, 80, 20, 0);
+    test_assert(batches.mini[1]->features.values->vector->values == &MATRIX(mapped.features.values, 10, 0), "Batch isn't view of mapped features");
+
+    // Shuffle gathers the same rows in other order
+    Data.batch.shuffle(&batches);
+    float sum = 0;
+    for(size_t batch = 0; batch < batches.count; batch++) {
+        data_set *mini = Data.batch.mini(&batches, batch);
+        test_assert(mini && mini->features.values->rows == 10, "Shuffled batch %zd is broken", batch);
+        sum += Matrix.prop.sum(mini->features.values);
+    }
+    float expected = Matrix.prop.sum(batches.train->features.values);
+    test_assert(fabs(sum - expected) < 1e-3 * expected, "Shuffled batches sum %f, train %f", sum, expected);
+    test_assert(batches.mini[1]->features.values->vector->values == &MATRIX(mapped.features.values, 10, 0), "Shuffle moved data");
+
+    Data.batch.delete(&batches);
+    Data.delete(&mapped);
+    Data.delete(&iris_binary);
+
+    // Headers are refused with no labels, unterminated labels, more labels
+    // than fields and size of features wrapping to the real one
+    FILE *file = fopen(filename, "r+b");
+    data_file_header header;
+    test_assert(file && fread(&header, sizeof(header), 1, file) == 1, "Data set header isn't read");
+    test_assert(header.targets > 1, "Data set has %u targets", (unsigned)header.targets);
+    data_file_header broken[] = { header, header, header, header };
+    broken[0].labels_size = 0;
+    broken[1].labels_size -= 1;
+    broken[2].targets -= 1;
+    broken[3].rows += (uint64_t)1 << 62;
+    for(size_t index = 0; index < sizeof(broken) / sizeof(header); index++) {
+        test_assert(fseek(file, 0, SEEK_SET) == 0 && fwrite(&broken[index], sizeof(header), 1, file) == 1
+                    && fflush(file) == 0, "Data set header isn't written");
+        test_assert(Data.file.map(filename).mapping.address == NULL, "Broken header %zd is mapped", index);
+    }
+    fclose(file);
+    remove(filename);
+
+    test_assert(Data.file.map(filename).mapping.address == NULL, "Missing file is mapped");
+
+    return NULL;
+}
+
+char *data_stream() {
+    const char *end = NULL;
+    char *numbers[] = { "5.1", "-0.001", "1.5E+2", "+7", "12345678901234567890.5", "3e-30" };
+    float expected[] = { 5.1f, -0.001f, 150.f, 7.f, 12345678901234567890.5f, 3e-30f };
+
+    for(size_t index = 0; index < sizeof(expected) / sizeof(float); index++) {
+        float number = csv_parse_float(numbers[index], numbers[index] + strlen(numbers[index]), &end);
+        test_assert(number == expected[index] && *end == '\0', "%s is parsed as %g", numbers[index], number);
+    }
+    csv_parse_float("setosa", "setosa" + 6, &end);
+    test_assert(strcmp(end, "setosa") == 0, "Text is parsed as number");
+    // Digits after limit belong to the next field
+    char *field = "1.5,2";
+    test_assert(csv_parse_float(field + 4, field + 4, &end) == 0 && end == field + 4, "Number is read past limit");
+    test_assert(csv_parse_float(field, field + 2, &end) == 1 && end == field + 2, "Number is read past limit");
+
+    csv_stream *stream = Data.stream.open("./test/data/iris.csv");
+    test_assert(stream && stream->columns == 5, "Stream header isn't read");
+
+    matrix *rows = Matrix.create(16, stream->columns);
+    size_t total = 0;
+    size_t read = 0;
+
+    while((read = Data.stream.next(stream, rows))) {
+        if(total == 0) {
+            test_assert(MATRIX(rows, 0, 0) == 5.1f && MATRIX(rows, 0, 3) == 0.2f && MATRIX(rows, 0, 4) == 0,
+                        "First row is %f %f %f", MATRIX(rows, 0, 0), MATRIX(rows, 0, 3), MATRIX(rows, 0, 4));
+        }
+        total += read;
+    }
+    test_assert(total == 150 && stream->rows == 150, "Stream has %zd rows", total);
+    test_assert(stream->categories[4].count == 3, "Species has %zd categories", stream->categories[4].count);
+
+    // Second pass keeps numbers of categories
+    test_assert(Data.stream.rewind(stream), "Stream isn't rewound");
+    test_assert(Data.stream.next(stream, rows) == 16 && MATRIX(rows, 0, 0) == 5.1f, "Second pass differs");
+
+    Data.stream.close(stream);
+    Matrix.delete(rows);
+
+    return NULL;
+}
+
+// Last line without newline is read after refills of buffer left stale digits
+char *data_stream_tail() {
+    char *filename = "/tmp/naive_stream_test.csv";
+    size_t lines = 3 * CSV_STREAM_BUFFER / 12;
+    matrix *rows = Matrix.create(4096, 2);
+
+    for(size_t extra = 0; extra < 4; extra++) {
+        FILE *file = fopen(filename, "w");
+        test_assert(file, "Stream file isn't created");
+        fprintf(file, "a,b\n");
+        for(size_t line = 0; line < lines + extra; line++) {
+            fprintf(file, "%zd.25,7\n", line % 10);
+        }
+        fprintf(file, "1.5,2");
+        fclose(file);
+
+        csv_stream *stream = Data.stream.open(filename);
+        test_assert(stream, "Stream isn't opened");
+
+        size_t total = 0;
+        size_t read = 0;
+        float first = 0;
+        float last = 0;
+        while((read = Data.stream.next(stream, rows))) {
+            total += read;
+            first = MATRIX(rows, read - 1, 0);
+            last = MATRIX(rows, read - 1, 1);
+        }
+        test_assert(total == lines + extra + 1, "Stream has %zd rows of %zd", total, lines + extra + 1);
+        test_assert(first == 1.5f && last == 2 && stream->categories[1].count == 0,
+                    "Last row is %f %f without newline", first, last);
+
+        Data.stream.close(stream);
+    }
+
+    remove(filename);
+    Matrix.delete(rows);
+
+    return NULL;
+}
+
+char *data_loader_test() {
+    data_set iris_binary = Data.matrix(set.features.values, binary_target);
+    data_batch batches = Data.split(&iris_binary, 10, 80, 20, 0);
+    data_loader *loader = Loader.create(&batches, 3);
+    test_assert(loader, "Loader isn't created");
+
+    // Epoch left in the middle is dropped by the next one
+    Loader.epoch(loader);
+    test_assert(Loader.next(loader) && Loader.next(loader), "First batches of epoch are missing");
+
+    for(int epoch = 0; epoch < 2; epoch++) {
+        Loader.epoch(loader);
+
+        float sum = 0;
+        size_t count = 0;
+        for(data_set *mini = Loader.next(loader); mini; mini = Loader.next(loader), count++) {
+            test_assert(mini->features.values->rows == 10, "Batch %zd has %zd rows", count, mini->features.values->rows);
+            sum += Matrix.prop.sum(mini->features.values);
+        }
+
+        float expected = Matrix.prop.sum(batches.train->features.values);
+        test_assert(count == batches.count, "Epoch has %zd batches of %zd", count, batches.count);
+        test_assert(fabs(sum - expected) < 1e-3 * expected, "Loaded batches sum %f, train %f", sum, expected);
+    }
+
+    Loader.delete(loader);
+    Data.batch.delete(&batches);
+    Data.delete(&iris_binary);
+
+    return NULL;
+}
+
 char *data_delete() {
     Data.delete(&set);
     Matrix.delete(binary_target);
@@ -59,6 +233,10 @@ char *all_tests() {
     test_run(iris_load);
     test_run(vector_to_binary);
     test_run(data_from_matrix);
+    test_run(data_file);
+    test_run(data_stream);
+    test_run(data_stream_tail);
+    test_run(data_loader_test);
     test_run(data_delete);
     
     return NULL;
@@ -1,9 +1,11 @@
 #include "unit.h"
+#include <unistd.h>
 #include <neural/network.h>
 #include <neural/router.h>
 
 neural_network   network;
 data_batch       iris_data;
+neural_layer     iris_layers[3];
 
 char *data_load()
 {
@@ -49,6 +51,7 @@ char *network_create_for_iris()
         { .dimension = 0 }
     };
 
+    memcpy(iris_layers, layers, sizeof(layers));
     network = Network.create(layers);
 
    return NULL;
@@ -70,7 +73,7 @@ error:
 }
 
 char *iris_train() {
-    Network.train(&network, &iris_data, 0.05, 200);
+    Network.train(&network, &iris_data, 0.05, 200, 1);
     
     matrix *axon = Network.fire(&network, iris_data.train->features.values);
 
@@ -81,12 +84,559 @@ char *iris_train() {
     return NULL;
 }
 
+// Layers fire as cells with the same weights. Last layer without whole
+// layer transfer leaves the network firing neuron by neuron
+char *layer_fire_cells_test() {
+    matrix *signal = iris_data.validation->features.values;
+    neural_layer layers[4] = { iris_layers[0], iris_layers[0], iris_layers[1], { .dimension = 0 } };
+
+    neural_network dense = Network.create(layers);
+    layers[2].kernel.transfer.layer = NULL;
+    neural_network cells = Network.create(layers);
+    test_assert(dense.layers && cells.layers == NULL, "Only network with layer transfers is dense");
+
+    // Cells fire on their own weights, they weren't taken by layers
+    matrix *output = Network.fire(&cells, signal);
+    test_assert(output, "Cells don't fire");
+    Matrix.delete(output);
+
+    // Weights of the first layer are drawn by the first fire, then cells get them
+    matrix *expected = Network.fire(&dense, signal);
+    for(size_t index = 0; index < cells.resolution.size; index++) {
+        neural_cell *cell = cells.neurons[index];
+        dense_layer *layer = dense.layers[cell->context->layer_index];
+        size_t position = cell->context->position;
+        matrix *weight = Matrix.create(layer->inputs, 1);
+
+        for(size_t input = 0; input < layer->inputs; input++) {
+            MATRIX(weight, input, 0) = MATRIX(layer->weight, position, input);
+        }
+        test_assert(Neuron.weight.set(cell, weight, VECTOR(layer->bias, position)), "Weight of cell %zd isn't set", index);
+    }
+    output = Network.fire(&cells, signal);
+    test_assert(expected && output && expected->rows == output->rows && expected->columns == output->columns,
+                "Networks fire different shapes");
+    vector_foreach(expected->vector) {
+        test_assert(fabs(VECTOR(expected->vector, index) - VECTOR(output->vector, index)) < 1e-5,
+                    "Cells fire %f, layers %f", VECTOR(output->vector, index), VECTOR(expected->vector, index));
+    }
+
+    Matrix.delete(output);
+    Matrix.delete(expected);
+    Network.delete(&cells);
+    Network.delete(&dense);
+
+    return NULL;
+}
+
+// Fused kernels give the same activation and derivative as separate ones
+// One back propagation step of layer gives the same dW, dB and error
+// of previous layer as cells with the same weights
+char *layer_back_propagate_cells_test() {
+    matrix *signal = iris_data.validation->features.values;
+    matrix *target = iris_data.validation->target.values;
+    // Loss of soft max layer is taken from logits, cells have no such path
+    neural_layer layers[3] = { iris_layers[0], iris_layers[0], { .dimension = 0 } };
+
+    neural_network dense = Network.create(layers);
+    layers[1].kernel.transfer.layer = NULL;
+    neural_network cells = Network.create(layers);
+    test_assert(dense.layers && cells.layers == NULL, "Only network with layer transfers is dense");
+
+    // Weights of the first layer are drawn by the first fire, then cells get them.
+    // First output neuron is turned off, so derivative of activation matters
+    Network.error(&cells, signal, target);
+    Network.error(&dense, signal, target);
+    for(size_t input = 0; input < dense.layers[1]->inputs; input++) {
+        MATRIX(dense.layers[1]->weight, 0, input) = -fabs(MATRIX(dense.layers[1]->weight, 0, input));
+    }
+    VECTOR(dense.layers[1]->bias, 0) = -fabs(VECTOR(dense.layers[1]->bias, 0)) - 1;
+    Network.error(&dense, signal, target);
+    for(size_t index = 0; index < cells.resolution.size; index++) {
+        neural_cell *cell = cells.neurons[index];
+        dense_layer *layer = dense.layers[cell->context->layer_index];
+        size_t position = cell->context->position;
+        matrix *weight = Matrix.create(layer->inputs, 1);
+        for(size_t input = 0; input < layer->inputs; input++) {
+            MATRIX(weight, input, 0) = MATRIX(layer->weight, position, input);
+        }
+        test_assert(Neuron.weight.set(cell, weight, VECTOR(layer->bias, position)), "Weight of cell %zd isn't set", index);
+    }
+    Network.error(&cells, signal, target);
+
+    dense_layer *layer = dense.layers[1];
+    matrix *previous_error = Matrix.create(layer->inputs, layer->samples);
+    test_assert(Layer.back_propagate(layer, previous_error), "Layer isn't back propagated");
+
+    // Cell step with zero learning rate keeps weight, its primes are left in context
+    vector *expected_error = Vector.create(previous_error->vector->size);
+    for(size_t position = 0; position < layer->dimension; position++) {
+        neural_cell *cell = &NEURON(&cells, 1, position);
+        struct neuron_state *prime = &cell->context->prime;
+        cell->context->optimizer = cell->nucleus.optimization((void *)cell, 0, cell->context->optimizer);
+        test_assert(prime->weight && prime->error && prime->error->size == layer->samples, "Primes of cell %zd are broken", position);
+
+        for(size_t input = 0; input < layer->inputs; input++) {
+            float weight_prime = MATRIX(layer->weight_prime, position, input);
+            test_assert(fabs(weight_prime - MATRIX(prime->weight, input, 0)) < 1e-5 * (1 + fabs(weight_prime)),
+                        "Layer dW %zdx%zd is %f, cell %f", position, input, weight_prime, MATRIX(prime->weight, input, 0));
+
+            for(size_t sample = 0; sample < layer->samples; sample++) {
+                VECTOR(expected_error, input * layer->samples + sample) += MATRIX(layer->weight, position, input) * VECTOR(prime->error, sample);
+            }
+        }
+        float bias_prime = Vector.sum.all(prime->error) / prime->error->size;
+        test_assert(fabs(VECTOR(layer->bias_prime, position) - bias_prime) < 1e-5 * (1 + fabs(bias_prime)),
+                    "Layer dB %zd is %f, cell %f", position, VECTOR(layer->bias_prime, position), bias_prime);
+    }
+    vector_foreach(expected_error) {
+        test_assert(fabs(VECTOR(previous_error->vector, index) - VECTOR(expected_error, index)) < 1e-5 * (1 + fabs(VECTOR(expected_error, index))),
+                    "Previous error %zd of layer is %f, cells %f", index, VECTOR(previous_error->vector, index), VECTOR(expected_error, index));
+    }
+
+    Vector.delete(expected_error);
+    Matrix.delete(previous_error);
+    Network.delete(&cells); Network.delete(&dense);
+    return NULL;
+}
+
+char *activation_fused_test() {
+    struct activation_library_function kernels[] = {
+        Activation.sigmoid, Activation.tanh, Activation.relu, Activation.soft_max, Activation.log_soft_max,
+        Activation.heaviside_step
+    };
+    matrix *transfer = Matrix.seed(Matrix.create(4, 7), 0);
+    matrix *activation = Matrix.create(4, 7);
+    matrix *derivative = Matrix.create(4, 7);
+    matrix *fused_activation = Matrix.create(4, 7);
+    matrix *fused_derivative = Matrix.create(4, 7);
+
+    for(size_t kernel = 0; kernel < sizeof(kernels) / sizeof(kernels[0]); kernel++) {
+        test_assert(kernels[kernel].layer(transfer, activation)
+                    && kernels[kernel].layer_derivative(transfer, activation, derivative)
+                    && kernels[kernel].fused(transfer, fused_activation, fused_derivative), "Kernel %zd failed", kernel);
+
+        vector_foreach(activation->vector) {
+            test_assert(fabs(VECTOR(activation->vector, index) - VECTOR(fused_activation->vector, index)) < 1e-6
+                        && fabs(VECTOR(derivative->vector, index) - VECTOR(fused_derivative->vector, index)) < 1e-6,
+                        "Kernel %zd differs at %zd", kernel, index);
+        }
+    }
+
+    Matrix.delete(transfer);
+    Matrix.delete(activation);
+    Matrix.delete(derivative);
+    Matrix.delete(fused_activation);
+    Matrix.delete(fused_derivative);
+
+    return NULL;
+}
+
+// Logits far out of exp range still give probabilities
+char *soft_max_stable_test() {
+    matrix *transfer = Matrix.create(3, 2);
+    matrix *probability = Matrix.create(3, 2);
+    matrix *logarithm = Matrix.create(3, 2);
+    float logits[] = { 1000, -1000, 999, -1001, 0, -3000 };
+    memcpy(transfer->vector->values, logits, sizeof(logits));
+
+    test_assert(Activation.soft_max.layer(transfer, probability), "Soft max failed");
+    test_assert(Activation.log_soft_max.layer(transfer, logarithm), "Log soft max failed");
+
+    for(size_t sample = 0; sample < 2; sample++) {
+        float sum = 0;
+        for(size_t neuron = 0; neuron < 3; neuron++) {
+            float p = MATRIX(probability, neuron, sample);
+
+            test_assert(isfinite(p) && isfinite(MATRIX(logarithm, neuron, sample)), "Sample %zd overflows", sample);
+            test_assert(p < 1e-30 || fabs(logf(p) - MATRIX(logarithm, neuron, sample)) < 1e-4, "Log of %f differs", p);
+            sum += p;
+        }
+        test_assert(fabs(sum - 1) < 1e-6, "Probabilities of sample %zd sum to %f", sample, sum);
+    }
+    test_assert(fabs(MATRIX(probability, 0, 0) - 1 / (1 + expf(-1))) < 1e-6, "Shifted soft max is wrong");
+
+    Matrix.delete(transfer);
+    Matrix.delete(probability);
+    Matrix.delete(logarithm);
+
+    return NULL;
+}
+
+// Fused loss gives p - y, the same as cross entropy through soft max derivative
+char *cross_entropy_logits_test() {
+    matrix *transfer = Matrix.seed(Matrix.create(3, 5), 0);
+    matrix *activation = Matrix.create(3, 5);
+    matrix *prime = Matrix.create(3, 5);
+    matrix *error = Matrix.create(3, 5);
+    matrix *delta = Matrix.create(3, 5);
+    matrix *target = Matrix.create(5, 3);
+
+    memset(target->vector->values, 0, target->vector->size * sizeof(float));
+    for(size_t sample = 0; sample < 5; sample++) {
+        MATRIX(target, sample, sample % 3) = 1;
+    }
+
+    Activation.soft_max.fused(transfer, activation, prime);
+    float loss = Cost.cross_entropy.layer(activation, target, error);
+    float fused_loss = Cost.cross_entropy.logits(transfer, target, delta);
+
+    test_assert(fabs(loss - fused_loss) < 1e-3, "Fused loss %f, loss %f", fused_loss, loss);
+    vector_foreach(error->vector) {
+        float expected = VECTOR(error->vector, index) * VECTOR(prime->vector, index);
+        test_assert(fabs(VECTOR(delta->vector, index) - expected) < 1e-3, "Gradient %zd is %f, expected %f",
+                    index, VECTOR(delta->vector, index), expected);
+    }
+
+    // Logit far from others doesn't make log of zero
+    MATRIX(transfer, 0, 0) = 500;
+    MATRIX(transfer, 1, 1) = -500;
+    fused_loss = Cost.cross_entropy.logits(transfer, target, delta);
+    test_assert(isfinite(fused_loss) && isfinite(MATRIX(delta, 1, 1)), "Fused loss overflows");
+
+    Matrix.delete(transfer);
+    Matrix.delete(activation);
+    Matrix.delete(prime);
+    Matrix.delete(error);
+    Matrix.delete(delta);
+    Matrix.delete(target);
+
+    return NULL;
+}
+
+// Stateful optimizers keep their state in layers and converge as well
+char *iris_optimizers_train() {
+    optimization_function optimizers[] = {
+        Optimization.momentum, Optimization.nesterov, Optimization.rms_prop, Optimization.adam, Optimization.adam_w
+    };
+
+    for(size_t optimizer = 0; optimizer < sizeof(optimizers) / sizeof(optimizers[0]); optimizer++) {
+        neural_layer layers[3];
+        memcpy(layers, iris_layers, sizeof(layers));
+        layers[0].kernel.optimization = optimizers[optimizer];
+        layers[1].kernel.optimization = optimizers[optimizer];
+
+        srand(7);
+        neural_network trained = Network.create(layers);
+        Network.train(&trained, &iris_data, 0.01, 30, 1);
+
+        test_assert(trained.layers[0]->moment && trained.layers[0]->step == 30 * iris_data.count,
+                    "Optimizer %zd has no state", optimizer);
+        test_assert(trained.history[29].train.error < trained.history[0].train.error,
+                    "Optimizer %zd loss %f, first epoch %f", optimizer, trained.history[29].train.error, trained.history[0].train.error);
+
+        Network.delete(&trained);
+    }
+
+    return NULL;
+}
+
+// Bias is trained with weight, fused step decays only weight
+char *layer_update_test() {
+    srand(7);
+    neural_network trained = Network.create(iris_layers);
+    dense_layer *layer = trained.layers[0];
+    float bias = VECTOR(layer->bias, 0);
+
+    Network.train(&trained, &iris_data, 0.05, 5, 1);
+    test_assert(VECTOR(layer->bias, 0) != bias, "Bias isn't trained");
+
+    size_t weights = layer->weight->vector->size;
+    test_assert(layer->parameters->size == weights + layer->dimension
+                && layer->bias->values == layer->parameters->values + weights, "Parameters aren't one block");
+
+    vector *before = Vector.copy(layer->parameters);
+    for(size_t index = 0; index < layer->gradient->size; index++) {
+        VECTOR(layer->gradient, index) = 1;
+    }
+    test_assert(Optimization.update(layer, 0.1, 0.5), "Update failed");
+
+    for(size_t index = 0; index < before->size; index++) {
+        float decay = index < weights ? 1 - 0.1 * 0.5 : 1;
+        float expected = VECTOR(before, index) * decay - 0.1;
+        test_assert(fabs(VECTOR(layer->parameters, index) - expected) < 1e-6,
+                    "Parameter %zd is %f, expected %f", index, VECTOR(layer->parameters, index), expected);
+    }
+
+    Vector.delete(before);
+    Network.delete(&trained);
+
+    return NULL;
+}
+
+// Copied and mapped networks fire as the saved one
+char *network_save_test() {
+    char *filename = "/tmp/naive_iris_test.network";
+    matrix *signal = iris_data.validation->features.values;
+    matrix *expected = Network.fire(&network, signal);
+
+    test_assert(Network.save(&network, filename), "Network isn't saved");
+
+    for(int mapped = 0; mapped < 2; mapped++) {
+        neural_network loaded = Network.load(filename, mapped);
+        test_assert(loaded.layers, "Network isn't loaded");
+        test_assert((loaded.mapping.address != NULL) == mapped, "Mapping of network is wrong");
+
+        for(size_t layer = 0; layer < loaded.resolution.layers; layer++) {
+            float *parameters = loaded.layers[layer]->parameters->values;
+            test_assert(Vector.rel.is_equal(loaded.layers[layer]->parameters, network.layers[layer]->parameters),
+                        "Layer %zd parameters differ", layer);
+            test_assert(mapped == false || ((size_t)parameters & (NETWORK_FILE_ALIGNMENT - 1)) == 0,
+                        "Layer %zd block isn't page aligned", layer);
+        }
+
+        // Mapped network is refused by training, its pages are read-only
+        if(mapped) {
+            Network.train(&loaded, &iris_data, 0.05, 1, 1);
+            test_assert(loaded.history == NULL, "Mapped network is trained");
+        }
+
+        matrix *axon = Network.fire(&loaded, signal);
+        test_assert(Matrix.rel.is_equal(axon, expected), "Loaded network fires differently");
+
+        // Plan of mapped network views own pages of file, network goes first
+        inference_plan *plan = Network.freeze(&loaded, 4);
+        test_assert(plan && (plan->mapping.address != NULL) == mapped && (plan->parameters == NULL) == mapped,
+                    "Plan of %s network has wrong parameters", mapped ? "mapped" : "copied");
+        Network.delete(&loaded);
+
+        test_assert(Plan.predict(plan, signal, axon), "Plan of loaded network doesn't predict");
+        vector_foreach(expected->vector) {
+            test_assert(fabs(VECTOR(expected->vector, index) - VECTOR(axon->vector, index)) < 1e-5,
+                        "Plan of loaded network predicts %f, network fires %f", VECTOR(axon->vector, index), VECTOR(expected->vector, index));
+        }
+
+        Plan.delete(plan);
+        Matrix.delete(axon);
+    }
+
+    // Data set file isn't a network
+    test_assert(Network.load("./test/data/iris.csv", false).layers == NULL, "Broken file is loaded");
+
+    // End of block larger than a page at offset near the top wraps into the file
+    FILE *file = fopen(filename, "r+b");
+    network_file_layer record;
+    test_assert(file && fseek(file, sizeof(network_file_header), SEEK_SET) == 0
+                && fread(&record, sizeof(record), 1, file) == 1, "Layer record isn't read");
+    record.offset = UINT64_MAX - (NETWORK_FILE_ALIGNMENT - 1);
+    record.inputs = NETWORK_FILE_ALIGNMENT / sizeof(float);
+    test_assert(fseek(file, sizeof(network_file_header), SEEK_SET) == 0
+                && fwrite(&record, sizeof(record), 1, file) == 1, "Layer record isn't written");
+    fclose(file);
+    test_assert(Network.load(filename, true).layers == NULL, "Wrapped layer block is loaded");
+
+    Matrix.delete(expected);
+    unlink(filename);
+
+    return NULL;
+}
+
+// Block of wider matrix is fired like packed copy of it
+char *network_fire_view_test() {
+    matrix *signal = iris_data.validation->features.values;
+    matrix *wide = Matrix.create(signal->rows, signal->columns + 6);
+
+    matrix_foreach(signal) {
+        MATRIX(wide, row, column + 3) = MATRIX(signal, row, column);
+    }
+    matrix *block = Matrix.slice.block(wide, 0, 3, signal->rows, signal->columns);
+    test_assert(block && block->stride == wide->columns, "Block isn't view of wide matrix");
+
+    matrix *expected = Network.fire(&network, signal);
+    matrix *output = Network.fire(&network, block);
+    test_assert(expected && output && Matrix.rel.is_equal(output, expected), "Fire of block view differs");
+
+    Matrix.delete(output);
+    Matrix.delete(expected);
+    Matrix.delete(block);
+    Matrix.delete(wide);
+
+    return NULL;
+}
+
+// Plan predicts by parts of capacity as network fires the whole batch
+char *network_freeze_test() {
+    matrix *signal = iris_data.validation->features.values;
+    matrix *expected = Network.fire(&network, signal);
+    matrix *output = Matrix.create(signal->rows, expected->columns);
+    inference_plan *plan = Network.freeze(&network, 4);
+
+    test_assert(plan && plan->capacity < signal->rows, "Network isn't frozen");
+    test_assert(Plan.predict(plan, signal, output), "Plan doesn't predict");
+
+    vector_foreach(expected->vector) {
+        test_assert(fabs(VECTOR(expected->vector, index) - VECTOR(output->vector, index)) < 1e-5,
+                    "Prediction %zd is %f, network fires %f", index, VECTOR(output->vector, index), VECTOR(expected->vector, index));
+    }
+
+    Plan.delete(plan);
+    Matrix.delete(output);
+    Matrix.delete(expected);
+
+    return NULL;
+}
+
+typedef struct {
+    inference_plan *    plan;
+    matrix *            signal;
+    matrix *            expected;
+    enum bool           equal;
+} predict_context;
+
+static void *predict_thread(void *argument) {
+    predict_context *context = argument;
+    matrix *output = Matrix.create(context->expected->rows, context->expected->columns);
+
+    context->equal = output != NULL;
+    for(int repeat = 0; repeat < 50 && context->equal; repeat++) {
+        context->equal = Plan.predict(context->plan, context->signal, output)
+                         && Matrix.rel.is_equal(output, context->expected);
+    }
+
+    if(output) {
+        Matrix.delete(output);
+    }
+    return NULL;
+}
+
+// Threads share one plan, each predict takes own workspace
+char *plan_concurrent_test() {
+    matrix *signal = iris_data.train->features.values;
+    inference_plan *plan = Network.freeze(&network, 8);
+    test_assert(plan, "Network isn't frozen");
+
+    matrix *expected = Matrix.create(signal->rows, plan->outputs);
+    predict_context contexts[4];
+    pthread_t threads[4];
+
+    test_assert(Plan.reserve(plan, 4) && plan->created == 4, "Workspaces aren't reserved");
+    test_assert(Plan.predict(plan, signal, expected), "Plan doesn't predict");
+
+    for(int thread = 0; thread < 4; thread++) {
+        contexts[thread] = (predict_context){ plan, signal, expected, false };
+        test_assert(pthread_create(&threads[thread], NULL, predict_thread, &contexts[thread]) == 0,
+                    "Thread %d isn't started", thread);
+    }
+    for(int thread = 0; thread < 4; thread++) {
+        pthread_join(threads[thread], NULL);
+    }
+
+    for(int thread = 0; thread < 4; thread++) {
+        test_assert(contexts[thread].equal, "Thread %d predicts differently", thread);
+    }
+    test_assert(plan->created == 4, "Plan has %zd workspaces for 4 threads", plan->created);
+
+    Plan.delete(plan);
+    Matrix.delete(expected);
+
+    return NULL;
+}
+
+// Int8 plan is calibrated by train features and loses little on validation
+char *plan_quantize_test() {
+    matrix *signal = iris_data.validation->features.values;
+    inference_plan *plan = Network.freeze(&network, 4);
+    test_assert(plan, "Network isn't frozen");
+
+    matrix *expected = Matrix.create(signal->rows, plan->outputs);
+    matrix *output = Matrix.create(signal->rows, plan->outputs);
+    test_assert(Plan.predict(plan, signal, expected), "Plan doesn't predict");
+
+    enum bool modes[] = { true, false };
+    for(int mode = 0; mode < 2; mode++) {
+        test_assert(Plan.quantize(plan, iris_data.train, modes[mode]) && plan->quantized, "Plan isn't quantized");
+        test_assert(Plan.predict(plan, signal, output), "Int8 plan doesn't predict");
+
+        // Sample near a border of classes may move more than the mean
+        float error = 0;
+        vector_foreach(expected->vector) {
+            error += fabsf(VECTOR(expected->vector, index) - VECTOR(output->vector, index));
+        }
+        error /= expected->vector->size;
+        test_assert(error < 0.05, "Int8 prediction differs by %f, per channel %d", error, modes[mode]);
+
+        float delta = Plan.accuracy_delta(plan, iris_data.validation);
+        test_assert(delta > -0.1, "Int8 accuracy is lower by %f, per channel %d", -delta, modes[mode]);
+    }
+    test_assert(plan->workspaces && plan->workspaces->codes && plan->workspaces->products,
+                "Workspace of quantized plan has no int8 buffers");
+
+    // Shrunk plan predicts the same by int8 alone
+    test_assert(Plan.shrink(plan) && plan->parameters == NULL && plan->layers[0].weight == NULL,
+                "Float parameters aren't dropped");
+    test_assert(Plan.predict(plan, signal, expected) && Matrix.rel.is_equal(expected, output), "Shrunk plan predicts differently");
+    test_assert(isnan(Plan.accuracy_delta(plan, iris_data.validation)), "Shrunk plan predicts float");
+
+    char *filename = "/tmp/naive_iris_test.plan";
+    test_assert(Plan.save(plan, filename), "Plan isn't saved");
+    Plan.delete(plan);
+
+    plan = Plan.load(filename, 8);
+    test_assert(plan && plan->quantized && plan->capacity == 8, "Plan isn't loaded");
+    test_assert(Plan.predict(plan, signal, expected) && Matrix.rel.is_equal(expected, output), "Loaded plan predicts differently");
+    test_assert(Plan.load("./test/data/iris.csv", 0) == NULL, "Broken file is loaded as plan");
+    unlink(filename);
+
+    Plan.delete(plan);
+    Matrix.delete(output);
+    Matrix.delete(expected);
+
+    return NULL;
+}
+
+// Same seed gives the same initial weights, threads change only rounding
+char *iris_parallel_train() {
+    neural_network sequential, parallel;
+    // Fixed seed, rounding of other seed may cross a kink of relu and drift
+    unsigned int seed = 7;
+
+    srand(seed);
+    sequential = Network.create(iris_layers);
+    Network.train(&sequential, &iris_data, 0.05, 20, 1);
+
+    srand(seed);
+    parallel = Network.create(iris_layers);
+    Network.train(&parallel, &iris_data, 0.05, 20, 4);
+
+    for(size_t layer = 0; layer < sequential.resolution.layers; layer++) {
+        matrix *expected = sequential.layers[layer]->weight;
+        matrix *weight = parallel.layers[layer]->weight;
+
+        vector_foreach(expected->vector) {
+            test_assert(fabs(VECTOR(expected->vector, index) - VECTOR(weight->vector, index)) < 1e-4,
+                        "Layer %zd weight %zd is %f, sequential %f", layer, index,
+                        VECTOR(weight->vector, index), VECTOR(expected->vector, index));
+        }
+    }
+
+    test_assert(fabs(parallel.history[19].train.error - sequential.history[19].train.error) < 1e-4,
+                "Parallel loss %f, sequential %f", parallel.history[19].train.error, sequential.history[19].train.error);
+
+    Network.delete(&sequential);
+    Network.delete(&parallel);
+
+    return NULL;
+}
+
 char *all_tests() {
     test_init();
     test_run(network_create_for_iris);
     test_run(data_load);
     test_run(neuron_layer);
+    test_run(activation_fused_test);
+    test_run(soft_max_stable_test);
+    test_run(cross_entropy_logits_test);
+    test_run(layer_fire_cells_test);
+    test_run(layer_back_propagate_cells_test);
     test_run(iris_train);
+    test_run(network_save_test);
+    test_run(network_fire_view_test);
+    test_run(network_freeze_test);
+    test_run(plan_concurrent_test);
+    test_run(plan_quantize_test);
+    test_run(iris_parallel_train);
+    test_run(iris_optimizers_train);
+    test_run(layer_update_test);
 
     return NULL;
 }
@@ -7,7 +7,7 @@ matrix *M;
 char *matrix_create() {
     M = Matrix.create(3, 6);
 
-    test_assert(strcmp(M->type, MATRIX_TYPE) == 0, "Type is wrong");
+    test_assert(M->type == MATRIX_TYPE, "Type is wrong");
     test_assert(M->rows == 3 && M->columns == 6 && M->vector->size == 3 * 6, "Size is different");
     
     return NULL;
@@ -56,11 +56,402 @@ error:
     return "Transpose failed";
 }
 
+// Shapes cut tiles and SIMD blocks unevenly, square one is transposed in place
+char *matrix_blocked_transpose_test() {
+    size_t shapes[][2] = { {1, 1}, {3, 5}, {8, 8}, {37, 70}, {70, 37}, {33, 33}, {100, 100} };
+
+    for(size_t shape = 0; shape < sizeof(shapes) / sizeof(shapes[0]); shape++) {
+        size_t rows = shapes[shape][0], columns = shapes[shape][1];
+        matrix *A = Matrix.seed(Matrix.create(rows, columns), 0);
+        matrix *into = Matrix.create(columns, rows);
+        matrix *T = Matrix.transpose(Matrix.copy(A));
+
+        test_assert(Matrix.transposed(A, into) && T, "Transpose of %zdx%zd failed", rows, columns);
+        test_assert(T->rows == columns && T->columns == rows, "Transpose of %zdx%zd has wrong shape", rows, columns);
+
+        matrix_foreach(A) {
+            test_assert(MATRIX(T, column, row) == MATRIX(A, row, column)
+                        && MATRIX(into, column, row) == MATRIX(A, row, column),
+                        "Transpose of %zdx%zd differs at %zdx%zd", rows, columns, row, column);
+        }
+
+        vector **vectors = malloc(columns * sizeof(vector *));
+        for(size_t column = 0; column < columns; column++) {
+            vectors[column] = Vector.view(&MATRIX(T, column, 0), rows);
+        }
+        matrix *joined = Matrix.columns(vectors, columns);
+        test_assert(Matrix.rel.is_equal(joined, A), "Columns of %zdx%zd aren't joined", rows, columns);
+
+        for(size_t column = 0; column < columns; column++) {
+            Vector.delete(vectors[column]);
+        }
+        free(vectors);
+        Matrix.delete(joined);
+        Matrix.delete(A);
+        Matrix.delete(into);
+        Matrix.delete(T);
+    }
+
+    return NULL;
+}
+
+// Slices read and write values of matrix, block is taken by operations and gemm
+char *matrix_slice_test() {
+    matrix *A = Matrix.seed(Matrix.create(6, 5), 0);
+    matrix *copy = Matrix.copy(A);
+
+    vector *row = Matrix.slice.row(A, 2);
+    vector *column = Matrix.slice.column(A, 3);
+    vector *diagonal = Matrix.slice.diagonal(A);
+    test_assert(row->size == 5 && column->size == 6 && diagonal->size == 5, "Slices have wrong size");
+
+    float column_sum = 0, diagonal_dot = 0;
+    for(size_t index = 0; index < 6; index++) {
+        column_sum += MATRIX(A, index, 3);
+        diagonal_dot += index < 5 ? MATRIX(A, index, index) * MATRIX(A, index, index) : 0;
+    }
+    test_assert(fabs(Vector.sum.all(column) - column_sum) < 1e-5, "Column sum differs");
+    test_assert(fabs(Vector.dot(diagonal, diagonal) - diagonal_dot) < 1e-5, "Diagonal dot differs");
+
+    // Writes go through stride into matrix
+    Vector.vs.add(column, 1);
+    Vector.vv.add(diagonal, diagonal);
+    for(size_t index = 0; index < 6; index++) {
+        float expected = (MATRIX(copy, index, 3) + 1) * (index == 3 ? 2 : 1);
+        test_assert(fabs(MATRIX(A, index, 3) - expected) < 1e-6, "Column write at %zd differs", index);
+    }
+    test_assert(MATRIX(A, 2, 1) == MATRIX(copy, 2, 1) && VECTOR(row, 1) == MATRIX(A, 2, 1), "Row view differs");
+
+    vector *packed = Vector.copy(column);
+    test_assert(packed->stride == 1 && Vector.rel.is_equal(packed, column), "Copy of column differs");
+
+    // Block 3x2 at 1x2, product with it is the same as with its copy
+    matrix *block = Matrix.slice.block(A, 1, 2, 3, 2);
+    matrix *block_copy = Matrix.copy(block);
+    test_assert(Matrix.rel.is_equal(block, block_copy) && block_copy->stride == 2, "Block copy differs");
+
+    matrix *B = Matrix.seed(Matrix.create(2, 4), 0);
+    matrix *C = Matrix.create(3, 4), *D = Matrix.create(3, 4);
+    Matrix.gemm.ab(1, block, B, 0, C);
+    Matrix.gemm.ab(1, block_copy, B, 0, D);
+    vector_foreach(C->vector) {
+        test_assert(fabs(VECTOR(C->vector, index) - VECTOR(D->vector, index)) < 1e-5, "Block product differs at %zd", index);
+    }
+
+    float outside = MATRIX(A, 1, 1);
+    Matrix.ms.mul(block, 0);
+    test_assert(Matrix.prop.sum(block) == 0 && MATRIX(A, 2, 3) == 0 && MATRIX(A, 1, 1) == outside, "Block write leaked out");
+
+    Vector.delete(row);
+    Vector.delete(column);
+    Vector.delete(diagonal);
+    Vector.delete(packed);
+    Matrix.delete(block);
+    Matrix.delete(block_copy);
+    Matrix.delete(A);
+    Matrix.delete(copy);
+    Matrix.delete(B);
+    Matrix.delete(C);
+    Matrix.delete(D);
+
+    return NULL;
+}
+
+// Rows of remainder and columns of tail are covered, block is read by stride
+char *matrix_gemv_test() {
+    size_t shapes[][2] = { {1, 1}, {3, 7}, {4, 8}, {9, 33}, {64, 100} };
+
+    for(size_t shape = 0; shape < sizeof(shapes) / sizeof(shapes[0]); shape++) {
+        size_t rows = shapes[shape][0], columns = shapes[shape][1];
+        matrix *A = Matrix.seed(Matrix.create(rows + 1, columns + 2), 0);
+        matrix *block = Matrix.slice.block(A, 1, 1, rows, columns);
+        vector *x = Vector.seed(Vector.create(columns), 0);
+        vector *y = Vector.seed(Vector.create(rows), 0);
+        vector *before = Vector.copy(y);
+
+        test_assert(Matrix.mv.gemv(2, block, x, 0.5, y), "GEMV of %zdx%zd failed", rows, columns);
+
+        for(size_t row = 0; row < rows; row++) {
+            float expected = 0;
+            for(size_t column = 0; column < columns; column++) {
+                expected += MATRIX(block, row, column) * VECTOR(x, column);
+            }
+            expected = 2 * expected + 0.5 * VECTOR(before, row);
+            test_assert(fabs(VECTOR(y, row) - expected) < 1e-4, "GEMV of %zdx%zd differs at %zd", rows, columns, row);
+        }
+
+        Matrix.delete(A);
+        Matrix.delete(block);
+        Vector.delete(x);
+        Vector.delete(y);
+        Vector.delete(before);
+    }
+
+    return NULL;
+}
+
+// Int8 product is exact, so every kernel equals plain sums. Extreme
+// values show that pair sums don't saturate
+char *matrix_gemm_s8_test() {
+    size_t shapes[][3] = { {1, 1, 1}, {3, 5, 31}, {4, 8, 32}, {9, 7, 100}, {17, 33, 257} };
+
+    for(size_t shape = 0; shape < sizeof(shapes) / sizeof(shapes[0]); shape++) {
+        size_t rows = shapes[shape][0], columns = shapes[shape][1], depth = shapes[shape][2];
+        int8_t *A = malloc(rows * (depth + 3));
+        uint8_t *B = malloc(columns * depth);
+        int32_t *C = malloc(rows * columns * sizeof(int32_t));
+
+        for(size_t index = 0; index < rows * (depth + 3); index++) {
+            A[index] = shape % 2 ? -127 : (int8_t)random_range(-127, 128);
+        }
+        for(size_t index = 0; index < columns * depth; index++) {
+            B[index] = shape % 2 ? GEMM_S8_MAX : (uint8_t)random_range(0, GEMM_S8_MAX + 1);
+        }
+
+        gemm_s8(rows, columns, depth, A, depth + 3, B, depth, C, columns);
+
+        for(size_t row = 0; row < rows; row++) {
+            for(size_t column = 0; column < columns; column++) {
+                int32_t expected = 0;
+                for(size_t p = 0; p < depth; p++) {
+                    expected += (int32_t)A[row * (depth + 3) + p] * B[column * depth + p];
+                }
+                test_assert(C[row * columns + column] == expected, "Int8 GEMM %zdx%zdx%zd differs at %zdx%zd",
+                            rows, columns, depth, row, column);
+            }
+        }
+
+        free(A);
+        free(B);
+        free(C);
+    }
+    log_info("Int8 GEMM kernel: %s", gemm_s8_kernel_name());
+
+    return NULL;
+}
+
+// Paranoid build rejects NaN in results, other builds don't scan values
+char *matrix_paranoid_test() {
+    matrix *A = Matrix.seed(Matrix.create(2, 3), 1);
+    matrix *B = Matrix.seed(Matrix.create(2, 3), 1);
+    MATRIX(B, 1, 2) = NAN;
+
+    matrix *sum = Matrix.mm.add(A, B);
+    test_assert(PARANOID_CHECKS ? sum == NULL : sum == A, "NaN scan doesn't follow build mode");
+
+    Matrix.delete(A);
+    Matrix.delete(B);
+
+    return NULL;
+}
+
+// Reference product element by element
+float naive_product(matrix *A, enum bool transpose_a, matrix *B, enum bool transpose_b, size_t row, size_t column) {
+    size_t depth = transpose_a ? A->rows : A->columns;
+    float sum = 0;
+
+    for(size_t index = 0; index < depth; index++) {
+        float a = transpose_a ? MATRIX(A, index, row) : MATRIX(A, row, index);
+        float b = transpose_b ? MATRIX(B, column, index) : MATRIX(B, index, column);
+        sum += a * b;
+    }
+
+    return sum;
+}
+
+char *matrix_gemm_test() {
+    test_try(20) {
+        size_t rows = random_range(1, 300);
+        size_t columns = random_range(1, 300);
+        size_t depth = random_range(1, 600);
+
+        matrix *A = Matrix.seed(Matrix.create(rows, depth), 0);
+        matrix *AT = Matrix.seed(Matrix.create(depth, rows), 0);
+        matrix *B = Matrix.seed(Matrix.create(depth, columns), 0);
+        matrix *BT = Matrix.seed(Matrix.create(columns, depth), 0);
+        matrix *C = Matrix.seed(Matrix.create(rows, columns), 0);
+        matrix *C_origin = Matrix.copy(C);
+
+        Matrix.gemm.ab(2, A, B, 0.5, C);
+        matrix_foreach(C) {
+            float expected = 2 * naive_product(A, false, B, false, row, column) + 0.5 * MATRIX(C_origin, row, column);
+            test_assert(fabs(MATRIX(C, row, column) - expected) < 1e-3 * (1 + fabs(expected)),
+                        "AB %zdx%zdx%zd [%zd, %zd] %f != %f", rows, depth, columns, row, column, MATRIX(C, row, column), expected);
+        }
+
+        Matrix.gemm.abt(1, A, BT, 0, C);
+        matrix_foreach(C) {
+            float expected = naive_product(A, false, BT, true, row, column);
+            test_assert(fabs(MATRIX(C, row, column) - expected) < 1e-3 * (1 + fabs(expected)),
+                        "ABt %zdx%zdx%zd [%zd, %zd] %f != %f", rows, depth, columns, row, column, MATRIX(C, row, column), expected);
+        }
+
+        Matrix.gemm.atb(1, AT, B, 0, C);
+        matrix_foreach(C) {
+            float expected = naive_product(AT, true, B, false, row, column);
+            test_assert(fabs(MATRIX(C, row, column) - expected) < 1e-3 * (1 + fabs(expected)),
+                        "AtB %zdx%zdx%zd [%zd, %zd] %f != %f", rows, depth, columns, row, column, MATRIX(C, row, column), expected);
+        }
+
+        Matrix.delete(A);
+        Matrix.delete(AT);
+        Matrix.delete(B);
+        Matrix.delete(BT);
+        Matrix.delete(C);
+        Matrix.delete(C_origin);
+    }
+
+    log_info("GEMM kernel: %s", gemm_kernel_name());
+
+    return NULL;
+}
+
+char *vector_simd_test() {
+    log_info("SIMD kernel: %s", simd_kernel_name());
+
+    test_try(20) {
+        size_t size = random_range(1, 1000);
+        vector *v = Vector.seed(Vector.create(size), 0);
+        vector *w = Vector.num.add(Vector.seed(Vector.create(size), 0), 2);
+        vector *sum = Vector.add(Vector.copy(v), w);
+        vector *quotient = Vector.div(Vector.copy(v), w);
+        vector *scaled = Vector.num.mul(Vector.copy(v), 0.3);
+        double dot = 0;
+
+        vector_foreach(v) {
+            test_assert(VECTOR(sum, index) == VECTOR(v, index) + VECTOR(w, index), "v + w differs at %zd", index);
+            test_assert(VECTOR(quotient, index) == VECTOR(v, index) / VECTOR(w, index), "v / w differs at %zd", index);
+            test_assert(VECTOR(scaled, index) == VECTOR(v, index) * 0.3f, "v * 0.3 differs at %zd", index);
+            dot += (double)VECTOR(v, index) * VECTOR(w, index);
+        }
+        test_assert(fabs(Vector.dot(v, w) - dot) <= 1e-5 * (1 + fabs(dot)), "Dot product %f != %f", Vector.dot(v, w), dot);
+
+        Vector.delete(v);
+        Vector.delete(w);
+        Vector.delete(sum);
+        Vector.delete(quotient);
+        Vector.delete(scaled);
+    }
+
+    // Sequential float sum of million tenths drifts by about 1%
+    vector *tenths = Vector.num.add(Vector.create(1 << 20), 0.1);
+    double expected = (1 << 20) * (double)0.1f;
+    test_assert(fabs(Vector.sum.all(tenths) - expected) / expected < 1e-6, "Sum %f != %f", Vector.sum.all(tenths), expected);
+    test_assert(fabs(Vector.prop.l_norm(tenths, 1) - expected) / expected < 1e-6, "L1 norm %f != %f", Vector.prop.l_norm(tenths, 1), expected);
+    Vector.delete(tenths);
+
+    // Exp is approximated, extremes are clamped instead of overflow
+    float values[] = { -1000, -87, -10.5, -1, 0, 0.25, 1, 10.5, 88, 1000, 3, -3, 7, -7, 20, -20, 50 };
+    float exponents[sizeof(values) / sizeof(float)];
+    simd_exp(exponents, values, sizeof(values) / sizeof(float));
+    for(size_t index = 0; index < sizeof(values) / sizeof(float); index++) {
+        double expected = exp(values[index]);
+
+        test_assert(isfinite(exponents[index]) && exponents[index] >= 0, "exp(%f) is %f", values[index], exponents[index]);
+        test_assert(fabs(values[index]) > 88 || fabs(exponents[index] - expected) <= 1e-6 * expected,
+                    "exp(%f) is %g, expected %g", values[index], exponents[index], expected);
+    }
+
+    return NULL;
+}
+
+char *matrix_typed_operations_test() {
+    float scalar = 2;
+    matrix *A = Matrix.seed(Matrix.create(3, 4), 0);
+    matrix *B = Matrix.copy(A);
+    matrix *C = Matrix.seed(Matrix.create(3, 4), 0);
+
+    // Cast and typed entry points give the same result
+    Matrix.add(A, C);
+    Matrix.mm.add(B, C);
+    test_assert(Matrix.rel.is_equal(A, B), "mm.add differs from cast add");
+
+    Matrix.mul(A, &scalar);
+    Matrix.ms.mul(B, scalar);
+    test_assert(Matrix.rel.is_equal(A, B), "Plain float operand isn't cast as scalar");
+
+    number *two = Vector.from.number(scalar);
+    Matrix.sub(A, two);
+    Matrix.ms.sub(B, scalar);
+    test_assert(Matrix.rel.is_equal(A, B), "Number operand isn't cast as scalar");
+
+    matrix *transposed = Matrix.create(4, 3);
+    test_assert(Matrix.mm.add(A, transposed) == NULL, "Shape mismatch isn't caught");
+
+    vector *x = Vector.seed(Vector.create(4), 0);
+    matrix *Ax = Matrix.mv.mul(Matrix.copy(A), x);
+    test_assert(Ax->rows == 3 && Ax->columns == 1, "mv.mul shape is %zdx%zd", Ax->rows, Ax->columns);
+    for(size_t row = 0; row < A->rows; row++) {
+        float expected = 0;
+        for(size_t column = 0; column < A->columns; column++) {
+            expected += MATRIX(A, row, column) * VECTOR(x, column);
+        }
+        test_assert(fabs(MATRIX(Ax, row, 0) - expected) < 1e-5, "A * x differs at %zd", row);
+    }
+
+    Matrix.delete(A);
+    Matrix.delete(B);
+    Matrix.delete(C);
+    Matrix.delete(Ax);
+    Matrix.delete(transposed);
+    Vector.delete(x);
+    free(two);
+
+    return NULL;
+}
+
+char *matrix_arena_test() {
+    memory_arena *arena = Arena.create(4096);
+    test_assert(arena, "Arena isn't created");
+
+    arena_mark mark = Arena.push(arena);
+    matrix *A = Matrix.seed(Matrix.create(10, 10), 0);
+    matrix *B = Matrix.copy(A);
+    vector *v = Vector.create(2000);
+
+    test_assert(A->arena == arena && A->vector->arena == arena, "Matrix isn't allocated from arena");
+    test_assert(Matrix.rel.is_equal(A, B), "Copy from arena differs");
+    test_assert(((size_t)v->values & (ARENA_ALIGNMENT - 1)) == 0, "Arena values aren't aligned");
+
+    // Heap scope inside of arena scope
+    arena_mark heap = Arena.push(NULL);
+    matrix *C = Matrix.create(2, 2);
+    Arena.pop(heap);
+    test_assert(C->arena == NULL && Arena.current() == arena, "Heap scope doesn't escape arena");
+    Matrix.delete(C);
+
+    // Delete of arena instances does nothing, memory is returned by pop
+    Vector.reshape(v, 4000);
+    Matrix.delete(A);
+    Vector.delete(v);
+
+    Arena.pop(mark);
+    test_assert(Arena.current() == NULL, "Pop doesn't restore heap");
+
+    mark = Arena.push(arena);
+    matrix *D = Matrix.create(10, 10);
+    test_assert(D == A, "Arena memory isn't reused after pop");
+    Arena.pop(mark);
+
+    Arena.delete(arena);
+
+    return NULL;
+}
+
 char *all_tests() {
     test_init();
 
     test_run(matrix_create);
     test_run(vector_transpose_test);
+    test_run(matrix_blocked_transpose_test);
+    test_run(matrix_slice_test);
+    test_run(matrix_gemv_test);
+    test_run(matrix_gemm_s8_test);
+    test_run(matrix_paranoid_test);
+    test_run(matrix_gemm_test);
+    test_run(vector_simd_test);
+    test_run(matrix_typed_operations_test);
+    test_run(matrix_arena_test);
     test_run(matrix_delete);
 
     return NULL;
@@ -0,0 +1,133 @@
+#include "unit.h"
+#include <unistd.h>
+#include <neural/network.h>
+#include <neural/router.h>
+#include <serve/server.h>
+
+#define SERVER_TEST_SOCKET  "/tmp/naive_server_test.sock"
+#define SERVER_TEST_THREADS 6
+#define SERVER_TEST_ROWS    20
+
+inference_plan  *plan;
+matrix          *signal;
+matrix          *expected;
+
+typedef struct {
+    size_t              thread;
+    size_t              answered;
+} client_context;
+
+char *plan_create() {
+    neuron_kernel hidden = { Transfer.linear, Aggregation.sum, Activation.relu, Cost.mean_squared, Optimization.sgd };
+    neuron_kernel output = { Transfer.linear, Aggregation.sum, Activation.soft_max, Cost.cross_entropy, Optimization.sgd };
+    neural_layer layers[] = {
+        { .kernel = hidden, .router = Router.any, .dimension = 8 },
+        { .kernel = output, .router = Router.any, .dimension = 3 },
+        { .dimension = 0 }
+    };
+    neural_network network = Network.create(layers);
+
+    signal = Matrix.seed(Matrix.create(SERVER_TEST_THREADS * SERVER_TEST_ROWS, 4), 0);
+    // First fire shapes the input layer
+    matrix *axon = Network.fire(&network, signal);
+    test_assert(axon, "Network doesn't fire");
+    Matrix.delete(axon);
+
+    plan = Network.freeze(&network, 8);
+    Network.delete(&network);
+    test_assert(plan, "Network isn't frozen");
+
+    expected = Matrix.create(signal->rows, plan->outputs);
+    test_assert(Plan.predict(plan, signal, expected), "Plan doesn't predict");
+
+    return NULL;
+}
+
+static void *client_loop(void *argument) {
+    client_context *context = argument;
+    int connection = Server.client.connect(SERVER_TEST_SOCKET);
+    float output[3];
+
+    for(size_t request = 0; connection >= 0 && request < SERVER_TEST_ROWS; request++) {
+        size_t row = context->thread * SERVER_TEST_ROWS + request;
+
+        if(Server.client.predict(connection, &MATRIX(signal, row, 0), signal->columns, output, 3) == false) {
+            break;
+        }
+
+        enum bool equal = true;
+        for(size_t column = 0; column < 3; column++) {
+            equal = equal && fabs(output[column] - MATRIX(expected, row, column)) < 1e-5;
+        }
+        if(equal == false) {
+            break;
+        }
+        context->answered++;
+    }
+
+    if(connection >= 0) {
+        close(connection);
+    }
+    return NULL;
+}
+
+// Concurrent requests are answered by batches of several rows
+char *server_batch_test() {
+    inference_server *server = Server.create(plan, SERVER_TEST_SOCKET, 8, 2000);
+    client_context contexts[SERVER_TEST_THREADS];
+    pthread_t threads[SERVER_TEST_THREADS];
+    test_assert(server, "Server isn't started");
+
+    for(size_t thread = 0; thread < SERVER_TEST_THREADS; thread++) {
+        contexts[thread] = (client_context){ thread, 0 };
+        test_assert(pthread_create(&threads[thread], NULL, client_loop, &contexts[thread]) == 0,
+                    "Client %zd isn't started", thread);
+    }
+    for(size_t thread = 0; thread < SERVER_TEST_THREADS; thread++) {
+        pthread_join(threads[thread], NULL);
+    }
+
+    for(size_t thread = 0; thread < SERVER_TEST_THREADS; thread++) {
+        test_assert(contexts[thread].answered == SERVER_TEST_ROWS, "Client %zd has %zd right answers",
+                    thread, contexts[thread].answered);
+    }
+    test_assert(server->requests == SERVER_TEST_THREADS * SERVER_TEST_ROWS && server->batches < server->requests,
+                "%zd requests in %zd batches", server->requests, server->batches);
+    log_info("%zd requests in %zd batches", server->requests, server->batches);
+
+    // Wrong count of features fails and closes connection
+    int connection = Server.client.connect(SERVER_TEST_SOCKET);
+    float output[3];
+    test_assert(connection >= 0, "Client isn't connected");
+    test_assert(Server.client.predict(connection, signal->vector->values, 2, output, 3) == false, "Wrong request is answered");
+    close(connection);
+
+    // Connection which is still open doesn't keep server from stopping
+    connection = Server.client.connect(SERVER_TEST_SOCKET);
+    test_assert(connection >= 0, "Client isn't connected");
+    Server.delete(server);
+    test_assert(Server.client.predict(connection, signal->vector->values, 4, output, 3) == false, "Stopped server answers");
+    close(connection);
+    test_assert(access(SERVER_TEST_SOCKET, F_OK) != 0, "Socket is left");
+
+    return NULL;
+}
+
+char *plan_delete() {
+    Plan.delete(plan);
+    Matrix.delete(signal);
+    Matrix.delete(expected);
+
+    return NULL;
+}
+
+char *all_tests() {
+    test_init();
+    test_run(plan_create);
+    test_run(server_batch_test);
+    test_run(plan_delete);
+
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
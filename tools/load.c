@@ -0,0 +1,118 @@
+//
+//  load.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+//  Load generator of naive-serve, each thread keeps one request in flight:
+//  naive-load socket inputs outputs [threads] [requests of thread]
+//
+
+#include <pthread.h>
+#include <unistd.h>
+#include <serve/server.h>
+
+typedef struct {
+    char *              path;
+    size_t              inputs;
+    size_t              outputs;
+    size_t              requests;
+
+    // Microseconds of each request, failed ones aren't counted
+    double *            latency;
+    size_t              answered;
+    unsigned int        seed;
+} load_thread;
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e6 + time.tv_nsec / 1e3;
+}
+
+static int by_latency(const void *a, const void *b) {
+    double left = *(const double *)a;
+    double right = *(const double *)b;
+
+    return (left > right) - (left < right);
+}
+
+static void *load_loop(void *argument) {
+    load_thread *thread = argument;
+    float *features = malloc(thread->inputs * sizeof(float));
+    float *output = malloc(thread->outputs * sizeof(float));
+    int connection = Server.client.connect(thread->path);
+
+    for(size_t request = 0; features && output && connection >= 0 && request < thread->requests; request++) {
+        for(size_t index = 0; index < thread->inputs; index++) {
+            features[index] = (float)rand_r(&thread->seed) / RAND_MAX;
+        }
+
+        double start = now();
+        if(Server.client.predict(connection, features, thread->inputs, output, thread->outputs) == false) {
+            break;
+        }
+        thread->latency[thread->answered++] = now() - start;
+    }
+
+    if(connection >= 0) {
+        close(connection);
+    }
+    free(features);
+    free(output);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    check(argc >= 4, "Usage: %s socket inputs outputs [threads] [requests of thread]", argv[0]);
+
+    size_t count = argc > 4 ? strtoul(argv[4], NULL, 10) : 16;
+    size_t requests = argc > 5 ? strtoul(argv[5], NULL, 10) : 1000;
+    load_thread *threads = calloc(count, sizeof(load_thread));
+    pthread_t *handles = calloc(count, sizeof(pthread_t));
+    double *latency = calloc(count * requests, sizeof(double));
+    check_memory(threads);
+    check_memory(handles);
+    check_memory(latency);
+
+    double start = now();
+    for(size_t index = 0; index < count; index++) {
+        threads[index] = (load_thread){
+            .path = argv[1],
+            .inputs = strtoul(argv[2], NULL, 10),
+            .outputs = strtoul(argv[3], NULL, 10),
+            .requests = requests,
+            .latency = latency + index * requests,
+            .seed = (unsigned int)index + 1
+        };
+        check(pthread_create(&handles[index], NULL, load_loop, &threads[index]) == 0, "Thread %zd isn't started", index);
+    }
+
+    size_t answered = 0;
+    for(size_t index = 0; index < count; index++) {
+        pthread_join(handles[index], NULL);
+        // Latencies are gathered to the front for percentiles
+        memmove(latency + answered, threads[index].latency, threads[index].answered * sizeof(double));
+        answered += threads[index].answered;
+    }
+    double elapsed = now() - start;
+
+    check(answered, "No request is answered");
+    qsort(latency, answered, sizeof(double), by_latency);
+
+    log_info("%zd of %zd requests, %.0f requests/s", answered, count * requests, answered / elapsed * 1e6);
+    log_info("Latency p50 %.0f us, p99 %.0f us, max %.0f us",
+             latency[answered / 2], latency[answered * 99 / 100], latency[answered - 1]);
+
+    free(threads);
+    free(handles);
+    free(latency);
+
+    return answered == count * requests ? 0 : 1;
+
+error:
+    return 1;
+}
@@ -0,0 +1,57 @@
+//
+//  serve.c
+//  naive
+//
+//  Created by Alexandr Kondratyev on 18/10/2026.
+//  Copyright © 2026 alexander. All rights reserved.
+//
+//  Serves network saved by Network.save on UNIX socket until SIGINT or SIGTERM:
+//  naive-serve network socket [max batch] [max wait in microseconds]
+//
+
+#include <signal.h>
+#include <neural/network.h>
+#include <serve/server.h>
+
+int main(int argc, char *argv[]) {
+    inference_plan *plan = NULL;
+    inference_server *server = NULL;
+    sigset_t signals;
+    int signal = 0;
+
+    check(argc >= 3, "Usage: %s network socket [max batch] [max wait]", argv[0]);
+    size_t max_batch = argc > 3 ? strtoul(argv[3], NULL, 10) : SERVER_BATCH;
+    size_t max_wait = argc > 4 ? strtoul(argv[4], NULL, 10) : SERVER_WAIT;
+
+    // Threads of server inherit the mask, so only sigwait takes signals
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    neural_network network = Network.load(argv[1], true);
+    check(network.layers, "Network %s isn't loaded", argv[1]);
+
+    // Plan views own pages of the mapped file, network isn't needed by server
+    plan = Network.freeze(&network, max_batch);
+    Network.delete(&network);
+    check(plan, "Network %s isn't frozen", argv[1]);
+
+    server = Server.create(plan, argv[2], max_batch, max_wait);
+    check(server, "Server isn't started on %s", argv[2]);
+
+    log_info("Serving %s on %s, %zd inputs, %zd outputs, batch %zd, wait %zd us",
+             argv[1], argv[2], plan->inputs, plan->outputs, server->max_batch, server->max_wait);
+
+    sigwait(&signals, &signal);
+
+    log_info("%zd requests in %zd batches", server->requests, server->batches);
+    Server.delete(server);
+    Plan.delete(plan);
+
+    return 0;
+
+error:
+    Plan.delete(plan);
+    return 1;
+}